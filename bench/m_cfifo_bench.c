@@ -0,0 +1,721 @@
+/**
+ * @file m_cfifo_bench.c
+ * @brief Micro-benchmarks for the m_cfifo hot paths.
+ *
+ * Measures the cost per byte of:
+ * - single FIFO byte and bulk operations (`This_*`)
+ * - the same operations on the header-only static FIFO (`m_cfifo_static.h`)
+ * - pulling newline-terminated lines byte by byte versus `m_cfifo_This_Find`
+ * - CRC-32 over popped frames in a second pass versus `m_cfifo_This_PopNCrc`
+ *   (with `M_CFIFO_CRC`)
+ * - cascaded byte and bulk operations (`All_*`) for cascade depths 1..16,
+ *   with and without an attached cascade descriptor
+ * - picking the ready queue out of 16 by polling `This_IsEmpty` versus
+ *   `m_cfifo_Set_PopNext`
+ * - the lock-free SPSC FIFO, interleaved and (if available) threaded
+ * - the lock-free MPMC record FIFO, interleaved and (if available) with
+ *   two producer and two consumer threads
+ *
+ * Each case repeatedly fills and drains the FIFO and reports ns/byte and
+ * cycles/byte. The cycle counter is the TSC on x86, the virtual counter on
+ * AArch64 (which ticks at the timer rate, not the CPU clock), or DWT CYCCNT
+ * on Cortex-M when built with `M_CFIFO_BENCH_DWT=1` (ns/byte is then 0).
+ *
+ * Usage: m_cfifo_bench [bytes_per_case]
+ *
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !M_CFIFO_BENCH_DWT
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "m_cfifo.h"
+#include "m_cfifo_spsc.h"
+#include "m_cfifo_mpmc.h"
+#include "m_cfifo_set.h"
+#include "m_cfifo_static.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if M_CFIFO_BENCH_DWT
+#define M_CFIFO_BENCH_THREADS 0
+#else
+#include <time.h>
+#endif
+
+#if M_CFIFO_BENCH_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#define BENCH_DEFAULT_BYTES   (4u * 1024u * 1024u)
+#define BENCH_SEGMENT_SIZE    256u
+#define BENCH_MAX_DEPTH       16u
+#define BENCH_CHUNK           64u
+#define BENCH_MPMC_RECORDS    256u
+#define BENCH_MPMC_RECORD     8u
+
+#if M_CFIFO_BENCH_DWT
+#define BENCH_DWT_CTRL        (*(volatile uint32_t*)0xE0001000u)
+#define BENCH_DWT_CYCCNT      (*(volatile uint32_t*)0xE0001004u)
+#define BENCH_DEMCR           (*(volatile uint32_t*)0xE000EDFCu)
+#endif
+
+
+//*****************************************************************************
+// Local Types
+//*****************************************************************************
+
+typedef struct
+{
+  uint64_t ns;
+  uint64_t cycles;
+}bench_tStamp;
+
+
+M_CFIFO_STATIC_DEFINE(bench_static, BENCH_SEGMENT_SIZE);
+
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static uint8_t bench_storage[BENCH_MAX_DEPTH][BENCH_SEGMENT_SIZE];
+static m_cfifo_tCFifo bench_fifo[BENCH_MAX_DEPTH];
+static m_cfifo_tCascade bench_cascade;
+static bench_static_tFifo bench_static_fifo;
+static uint8_t bench_chunk[BENCH_CHUNK];
+static volatile uint32_t bench_sink;
+static uint32_t bench_bytes = BENCH_DEFAULT_BYTES;
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static void bench_InitTimer(void)
+{
+#if M_CFIFO_BENCH_DWT
+  BENCH_DEMCR |= (1u << 24);
+  BENCH_DWT_CYCCNT = 0;
+  BENCH_DWT_CTRL |= 1u;
+#endif
+}
+
+static bench_tStamp bench_Now(void)
+{
+  bench_tStamp stamp;
+
+#if M_CFIFO_BENCH_DWT
+  stamp.ns = 0;
+  stamp.cycles = BENCH_DWT_CYCCNT;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  stamp.ns = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#if defined(__x86_64__) || defined(__i386__)
+  stamp.cycles = __rdtsc();
+#elif defined(__aarch64__)
+  __asm__ volatile("mrs %0, cntvct_el0" : "=r"(stamp.cycles));
+#else
+  stamp.cycles = 0;
+#endif
+#endif
+
+  return stamp;
+}
+
+static void bench_Report(const char* name, uint32_t depth, uint32_t bytes, bench_tStamp start, bench_tStamp stop)
+{
+  uint64_t cycles = stop.cycles - start.cycles;
+
+#if M_CFIFO_BENCH_DWT
+  // CYCCNT is only 32 bit wide
+  cycles = (uint32_t)cycles;
+#endif
+
+  printf("%-26s depth %2u  %9.3f ns/B  %9.3f cyc/B\n", name, (unsigned)depth,
+         (double)(stop.ns - start.ns) / bytes, (double)cycles / bytes);
+}
+
+static void bench_Setup(uint32_t depth, bool attach)
+{
+  for (uint32_t i = 0; i < depth; i++)
+  {
+    m_cfifo_InitBuffer(&bench_fifo[i]);
+    m_cfifo_ConfigBuffer(&bench_fifo[i], bench_storage[i], BENCH_SEGMENT_SIZE);
+    m_cfifo_This_Clear(&bench_fifo[i]);
+    if (i > 0)
+      m_cfifo_CascadeAsNextBuffer(&bench_fifo[i - 1], &bench_fifo[i]);
+  }
+
+  if (attach)
+    m_cfifo_AttachCascade(&bench_cascade, &bench_fifo[0]);
+}
+
+static void bench_ThisByte(void)
+{
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  uint8_t value;
+  bench_tStamp start;
+
+  bench_Setup(1, false);
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    for (uint32_t i = 0; i < BENCH_SEGMENT_SIZE; i++)
+      m_cfifo_This_Push(&bench_fifo[0], (uint8_t)i);
+    while (m_cfifo_This_Pop(&bench_fifo[0], &value))
+      sum += value;
+    moved += BENCH_SEGMENT_SIZE;
+  }
+  bench_Report("This_Push/This_Pop", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+static void bench_ThisBulk(void)
+{
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  bench_tStamp start;
+
+  bench_Setup(1, false);
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    while (m_cfifo_This_PushN(&bench_fifo[0], bench_chunk, BENCH_CHUNK) != 0)
+      ;
+    while (m_cfifo_This_PopN(&bench_fifo[0], bench_chunk, BENCH_CHUNK) != 0)
+      sum += bench_chunk[0];
+    moved += BENCH_SEGMENT_SIZE;
+  }
+  bench_Report("This_PushN/This_PopN", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+static void bench_StaticByte(void)
+{
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  uint8_t value;
+  bench_tStamp start;
+
+  bench_static_Clear(&bench_static_fifo);
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    for (uint32_t i = 0; i < BENCH_SEGMENT_SIZE; i++)
+      bench_static_Push(&bench_static_fifo, (uint8_t)i);
+    while (bench_static_Pop(&bench_static_fifo, &value))
+      sum += value;
+    moved += BENCH_SEGMENT_SIZE;
+  }
+  bench_Report("Static_Push/Static_Pop", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+static void bench_StaticBulk(void)
+{
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  bench_tStamp start;
+
+  bench_static_Clear(&bench_static_fifo);
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    while (bench_static_PushN(&bench_static_fifo, bench_chunk, BENCH_CHUNK) != 0)
+      ;
+    while (bench_static_PopN(&bench_static_fifo, bench_chunk, BENCH_CHUNK) != 0)
+      sum += bench_chunk[0];
+    moved += BENCH_SEGMENT_SIZE;
+  }
+  bench_Report("Static_PushN/PopN", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+static void bench_FindLine(bool bytewise)
+{
+  static uint8_t line[BENCH_SEGMENT_SIZE];
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  uint8_t value;
+  m_cfifo_tIndex len;
+  bench_tStamp start;
+
+  memset(line, 'a', sizeof(line));
+  line[sizeof(line) - 1u] = '\n';
+  bench_Setup(1, false);
+
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    m_cfifo_This_PushN(&bench_fifo[0], line, sizeof(line));
+    if (bytewise)
+    {
+      len = 0;
+      while (m_cfifo_This_Pop(&bench_fifo[0], &value) && value != '\n')
+        len++;
+      len++;
+    }
+    else
+    {
+      len = m_cfifo_This_Find(&bench_fifo[0], '\n', M_CFIFO_INDEX_MAX) + 1u;
+      m_cfifo_This_Skip(&bench_fifo[0], len);
+    }
+    sum += len;
+    moved += sizeof(line);
+  }
+  bench_Report(bytewise ? "Pop until newline" : "Find+Skip line", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+#if M_CFIFO_CRC
+static void bench_PopCrc(bool fused)
+{
+  static uint8_t frame[BENCH_SEGMENT_SIZE];
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  m_cfifo_tCrc crc;
+  bench_tStamp start;
+
+  bench_Setup(1, false);
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    m_cfifo_Crc_Init(&crc, M_CFIFO_CRC32);
+    while (m_cfifo_This_PushN(&bench_fifo[0], bench_chunk, BENCH_CHUNK) != 0)
+      ;
+    if (fused)
+    {
+      m_cfifo_This_PopNCrc(&bench_fifo[0], frame, sizeof(frame), &crc);
+    }
+    else
+    {
+      m_cfifo_This_PopN(&bench_fifo[0], frame, sizeof(frame));
+      m_cfifo_Crc_Update(&crc, frame, sizeof(frame));
+    }
+    sum += m_cfifo_Crc_Get(&crc);
+    moved += sizeof(frame);
+  }
+  bench_Report(fused ? "PopNCrc (CRC-32)" : "PopN + CRC-32 pass", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+#endif
+
+static void bench_AllByte(uint32_t depth, bool attach)
+{
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  uint8_t value;
+  bench_tStamp start;
+
+  bench_Setup(depth, attach);
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    while (m_cfifo_All_Push(&bench_fifo[0], (uint8_t)moved))
+      moved++;
+    while (m_cfifo_All_Pop(&bench_fifo[0], &value))
+      sum += value;
+  }
+  bench_Report(attach ? "All_Push/All_Pop+cursor" : "All_Push/All_Pop", depth, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+static void bench_AllBulk(uint32_t depth, bool attach)
+{
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  m_cfifo_tIndex n;
+  bench_tStamp start;
+
+  bench_Setup(depth, attach);
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    while ((n = m_cfifo_All_PushN(&bench_fifo[0], bench_chunk, BENCH_CHUNK)) != 0)
+      moved += n;
+    while (m_cfifo_All_PopN(&bench_fifo[0], bench_chunk, BENCH_CHUNK) != 0)
+      sum += bench_chunk[0];
+  }
+  bench_Report(attach ? "All_PushN/PopN+cursor" : "All_PushN/All_PopN", depth, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+static void bench_Transfer(uint32_t depth, bool bytewise)
+{
+  static uint8_t storage[BENCH_SEGMENT_SIZE];
+  static m_cfifo_tCFifo src;
+  uint32_t moved = 0;
+  uint8_t value;
+  bench_tStamp start;
+
+  bench_Setup(depth, true);
+  m_cfifo_InitBuffer(&src);
+  m_cfifo_ConfigBuffer(&src, storage, BENCH_SEGMENT_SIZE);
+  m_cfifo_This_Clear(&src);
+
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    while (m_cfifo_This_PushN(&src, bench_chunk, BENCH_CHUNK) != 0)
+      ;
+    if (bytewise)
+    {
+      while (!m_cfifo_All_IsFull(&bench_fifo[0]) && m_cfifo_This_Pop(&src, &value))
+      {
+        m_cfifo_All_Push(&bench_fifo[0], value);
+        moved++;
+      }
+    }
+    else
+    {
+      moved += m_cfifo_Transfer(&bench_fifo[0], &src, BENCH_SEGMENT_SIZE);
+    }
+    if (m_cfifo_All_IsFull(&bench_fifo[0]))
+      m_cfifo_All_Skip(&bench_fifo[0], (m_cfifo_tIndex)(depth * BENCH_SEGMENT_SIZE));
+  }
+  bench_Report(bytewise ? "This_Pop+All_Push drain" : "Transfer drain", depth, moved, start, bench_Now());
+  bench_sink = moved;
+}
+
+static void bench_SetPopNext(bool polled)
+{
+  static m_cfifo_tSetQueue queues[BENCH_MAX_DEPTH];
+  static m_cfifo_tSet set;
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  m_cfifo_tIndex n = 0;
+  uint8_t queue;
+  bench_tStamp start;
+
+  // Only the lowest-priority queue carries traffic, the worst case for polling
+  m_cfifo_Set_Init(&set, queues, BENCH_MAX_DEPTH, M_CFIFO_SET_STRICT);
+  for (uint8_t i = 0; i < BENCH_MAX_DEPTH; i++)
+  {
+    m_cfifo_InitBuffer(&bench_fifo[i]);
+    m_cfifo_ConfigBuffer(&bench_fifo[i], bench_storage[i], BENCH_SEGMENT_SIZE);
+    m_cfifo_This_Clear(&bench_fifo[i]);
+    m_cfifo_Set_AddQueue(&set, i, &bench_fifo[i], BENCH_CHUNK);
+  }
+
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    m_cfifo_Set_Push(&set, BENCH_MAX_DEPTH - 1u, bench_chunk, BENCH_CHUNK);
+    if (polled)
+    {
+      for (queue = 0; queue < BENCH_MAX_DEPTH; queue++)
+      {
+        if (!m_cfifo_This_IsEmpty(&bench_fifo[queue]))
+        {
+          n = m_cfifo_This_PopN(&bench_fifo[queue], bench_chunk, BENCH_CHUNK);
+          break;
+        }
+      }
+    }
+    else
+    {
+      n = m_cfifo_Set_PopNext(&set, bench_chunk, BENCH_CHUNK, &queue);
+    }
+    sum += n;
+    moved += BENCH_CHUNK;
+  }
+  bench_Report(polled ? "poll 16 IsEmpty + PopN" : "Set_PopNext of 16", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+static void bench_SpscInterleaved(void)
+{
+  static uint8_t storage[BENCH_SEGMENT_SIZE];
+  static m_cfifo_tSpscFifo fifo;
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  uint8_t value;
+  bench_tStamp start;
+
+  m_cfifo_Spsc_InitBuffer(&fifo);
+  m_cfifo_Spsc_ConfigBuffer(&fifo, storage, sizeof(storage));
+
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    for (uint32_t i = 0; i < BENCH_SEGMENT_SIZE; i++)
+      m_cfifo_Spsc_Push(&fifo, (uint8_t)i);
+    while (m_cfifo_Spsc_Pop(&fifo, &value))
+      sum += value;
+    moved += BENCH_SEGMENT_SIZE;
+  }
+  bench_Report("Spsc_Push/Spsc_Pop", 1, moved, start, bench_Now());
+
+  moved = 0;
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    while (m_cfifo_Spsc_PushN(&fifo, bench_chunk, BENCH_CHUNK) != 0)
+      ;
+    while (m_cfifo_Spsc_PopN(&fifo, bench_chunk, BENCH_CHUNK) != 0)
+      sum += bench_chunk[0];
+    moved += BENCH_SEGMENT_SIZE;
+  }
+  bench_Report("Spsc_PushN/Spsc_PopN", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+static void bench_SpscBatch(void)
+{
+  static uint8_t storage[BENCH_SEGMENT_SIZE];
+  static m_cfifo_tSpscFifo fifo;
+  m_cfifo_tSpscWriter writer;
+  m_cfifo_tSpscReader reader;
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  uint8_t value;
+  bench_tStamp start;
+
+  m_cfifo_Spsc_InitBuffer(&fifo);
+  m_cfifo_Spsc_ConfigBuffer(&fifo, storage, sizeof(storage));
+  m_cfifo_Spsc_WriterInit(&writer, &fifo, 32);
+  m_cfifo_Spsc_ReaderInit(&reader, &fifo, 32);
+
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    for (uint32_t i = 0; i < BENCH_SEGMENT_SIZE; i++)
+      m_cfifo_Spsc_WriterPush(&writer, (uint8_t)i);
+    m_cfifo_Spsc_WriterFlush(&writer);
+    while (m_cfifo_Spsc_ReaderPop(&reader, &value))
+      sum += value;
+    moved += BENCH_SEGMENT_SIZE;
+  }
+  bench_Report("Spsc_Writer/Reader by 32", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+#if M_CFIFO_BENCH_THREADS
+static m_cfifo_tSpscFifo bench_spsc;
+static uint8_t bench_spsc_storage[4096];
+
+static void* bench_SpscProducer(void* arg)
+{
+  uint8_t chunk[BENCH_CHUNK];
+  uint32_t moved = 0;
+  uint16_t n;
+
+  (void)arg;
+  memset(chunk, 0x5A, sizeof(chunk));
+  while (moved < bench_bytes)
+  {
+    n = m_cfifo_Spsc_PushN(&bench_spsc, chunk, BENCH_CHUNK);
+    if (n == 0)
+      sched_yield();
+    moved += n;
+  }
+
+  return NULL;
+}
+
+static void bench_SpscThreaded(void)
+{
+  uint8_t chunk[BENCH_CHUNK];
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  uint16_t n;
+  pthread_t producer;
+  bench_tStamp start;
+
+  m_cfifo_Spsc_InitBuffer(&bench_spsc);
+  m_cfifo_Spsc_ConfigBuffer(&bench_spsc, bench_spsc_storage, sizeof(bench_spsc_storage));
+
+  start = bench_Now();
+  if (pthread_create(&producer, NULL, bench_SpscProducer, NULL) != 0)
+    return;
+  while (moved < bench_bytes)
+  {
+    n = m_cfifo_Spsc_PopN(&bench_spsc, chunk, BENCH_CHUNK);
+    if (n == 0)
+      sched_yield();
+    else
+      sum += chunk[0];
+    moved += n;
+  }
+  pthread_join(producer, NULL);
+  bench_Report("Spsc_PushN/PopN 2 threads", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+#endif
+
+
+static void bench_MpmcInterleaved(void)
+{
+  static uint32_t storage[M_CFIFO_MPMC_BUFFER_SIZE(BENCH_MPMC_RECORDS, BENCH_MPMC_RECORD) / sizeof(uint32_t)];
+  static m_cfifo_tMpmcFifo fifo;
+  uint8_t record[BENCH_MPMC_RECORD];
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+  bench_tStamp start;
+
+  m_cfifo_Mpmc_InitBuffer(&fifo);
+  m_cfifo_Mpmc_ConfigBuffer(&fifo, storage, BENCH_MPMC_RECORDS, BENCH_MPMC_RECORD);
+  memset(record, 0x3C, sizeof(record));
+
+  start = bench_Now();
+  while (moved < bench_bytes)
+  {
+    while (m_cfifo_Mpmc_Push(&fifo, record))
+      moved += BENCH_MPMC_RECORD;
+    while (m_cfifo_Mpmc_Pop(&fifo, record))
+      sum += record[0];
+  }
+  bench_Report("Mpmc_Push/Mpmc_Pop", 1, moved, start, bench_Now());
+  bench_sink = sum;
+}
+
+#if M_CFIFO_BENCH_THREADS
+static m_cfifo_tMpmcFifo bench_mpmc;
+static uint32_t bench_mpmc_storage[M_CFIFO_MPMC_BUFFER_SIZE(BENCH_MPMC_RECORDS, BENCH_MPMC_RECORD) / sizeof(uint32_t)];
+
+static uint32_t bench_mpmc_records;
+
+static void* bench_MpmcProducer(void* arg)
+{
+  uint8_t record[BENCH_MPMC_RECORD];
+  uint32_t moved = 0;
+
+  (void)arg;
+  memset(record, 0x5A, sizeof(record));
+  while (moved < bench_mpmc_records)
+  {
+    if (m_cfifo_Mpmc_Push(&bench_mpmc, record))
+      moved++;
+    else
+      sched_yield();
+  }
+
+  return NULL;
+}
+
+static void* bench_MpmcConsumer(void* arg)
+{
+  uint8_t record[BENCH_MPMC_RECORD];
+  uint32_t moved = 0;
+  uint32_t sum = 0;
+
+  while (moved < bench_mpmc_records)
+  {
+    if (m_cfifo_Mpmc_Pop(&bench_mpmc, record))
+    {
+      sum += record[0];
+      moved++;
+    }
+    else
+    {
+      sched_yield();
+    }
+  }
+  *(uint32_t*)arg = sum;
+
+  return NULL;
+}
+
+static void bench_MpmcThreaded(void)
+{
+  pthread_t thread[4];
+  uint32_t sum[4] = { 0 };
+  uint32_t started = 0;
+  bench_tStamp start;
+
+  // Two producers and two consumers, each moving the same number of records
+  bench_mpmc_records = bench_bytes / (2u * BENCH_MPMC_RECORD);
+
+  m_cfifo_Mpmc_InitBuffer(&bench_mpmc);
+  m_cfifo_Mpmc_ConfigBuffer(&bench_mpmc, bench_mpmc_storage, BENCH_MPMC_RECORDS, BENCH_MPMC_RECORD);
+
+  start = bench_Now();
+  for (uint32_t i = 0; i < 4; i++)
+  {
+    if (pthread_create(&thread[i], NULL, (i & 1u) ? bench_MpmcConsumer : bench_MpmcProducer, &sum[i]) != 0)
+      break;
+    started++;
+  }
+  for (uint32_t i = 0; i < started; i++)
+    pthread_join(thread[i], NULL);
+  if (started == 4)
+    bench_Report("Mpmc_Push/Pop 2+2 threads", 1, 2u * bench_mpmc_records * BENCH_MPMC_RECORD, start, bench_Now());
+  bench_sink = sum[1] + sum[3];
+}
+#endif
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+int main(int argc, char** argv)
+{
+  if (argc > 1)
+    bench_bytes = (uint32_t)strtoul(argv[1], NULL, 0);
+  if (bench_bytes < BENCH_SEGMENT_SIZE * BENCH_MAX_DEPTH)
+    bench_bytes = BENCH_SEGMENT_SIZE * BENCH_MAX_DEPTH;
+
+  bench_InitTimer();
+  memset(bench_chunk, 0xA5, sizeof(bench_chunk));
+
+  printf("m_cfifo benchmark: %u bytes per case, %u byte segments\n\n", (unsigned)bench_bytes, (unsigned)BENCH_SEGMENT_SIZE);
+
+  bench_ThisByte();
+  bench_ThisBulk();
+  bench_StaticByte();
+  bench_StaticBulk();
+  bench_FindLine(true);
+  bench_FindLine(false);
+#if M_CFIFO_CRC
+  bench_PopCrc(false);
+  bench_PopCrc(true);
+#endif
+
+  for (uint32_t depth = 1; depth <= BENCH_MAX_DEPTH; depth *= 2)
+  {
+    bench_AllByte(depth, false);
+    bench_AllByte(depth, true);
+    bench_AllBulk(depth, false);
+    bench_AllBulk(depth, true);
+  }
+
+  for (uint32_t depth = 1; depth <= BENCH_MAX_DEPTH; depth *= 4)
+  {
+    bench_Transfer(depth, true);
+    bench_Transfer(depth, false);
+  }
+
+  bench_SetPopNext(true);
+  bench_SetPopNext(false);
+
+  bench_SpscInterleaved();
+  bench_SpscBatch();
+#if M_CFIFO_BENCH_THREADS
+  bench_SpscThreaded();
+#endif
+
+  bench_MpmcInterleaved();
+#if M_CFIFO_BENCH_THREADS
+  bench_MpmcThreaded();
+#endif
+
+  return 0;
+}
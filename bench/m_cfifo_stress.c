@@ -0,0 +1,1029 @@
+/**
+ * @file m_cfifo_stress.c
+ * @brief Multi-threaded stress test and throughput regression harness.
+ *
+ * Runs one producer and one consumer thread (two of each for MPMC) against
+ * every FIFO mode, for cascade depths 1..16 and capacities from 8 bytes to
+ * 64 KiB:
+ * - `this_n`: @ref m_cfifo_This_PushN / @ref m_cfifo_This_PopN
+ * - `all_n`: @ref m_cfifo_All_PushN / @ref m_cfifo_All_PopN on an attached
+ *   cascade
+ * - `all_byte`: @ref m_cfifo_All_Push / @ref m_cfifo_All_Pop
+ * - `all_msg`: @ref m_cfifo_All_PushMsg / @ref m_cfifo_All_PopMsg
+ * - `spsc_n`: @ref m_cfifo_Spsc_PushN / @ref m_cfifo_Spsc_PopN (lock-free)
+ * - `spsc_batch`: the batched SPSC writer and reader handles (lock-free)
+ * - `mpmc`: @ref m_cfifo_Mpmc_Push / @ref m_cfifo_Mpmc_Pop, 2+2 threads
+ *
+ * The core FIFO is not thread-safe by itself, so its modes bracket every
+ * call with a mutex, as an application with `M_CFIFO_LOCK` would. The
+ * stream is a sequence pattern in randomly sized chunks and is checked
+ * byte by byte. A cascade of several segments fills the first segment with
+ * room, so interleaved data may overtake across segments; such cases
+ * (`"ordered":false`) check that every byte arrives exactly once instead.
+ * Messages carry a sequence number and check their length and payload.
+ * MPMC records carry a producer id and sequence number that must arrive in
+ * order per producer, each exactly once. The harness is meant to be built
+ * with `-fsanitize=thread` as well.
+ *
+ * Every case prints one JSON object per line with its throughput and the
+ * p50/p99 call latency of both sides (sampled, power-of-two buckets). With
+ * a baseline file, a case slower than `baseline * (1 - tolerance)` is a
+ * regression. Baseline lines are `<mode> <depth> <size> <MB/s>`; `#` starts
+ * a comment, and `--write-baseline` records the current results.
+ *
+ * Exit status: 0 passed, 1 data error or stall, 2 throughput regression,
+ * 3 usage error.
+ *
+ * Usage: m_cfifo_stress [--bytes N] [--mode NAME] [--baseline FILE]
+ *                       [--tolerance F] [--write-baseline FILE]
+ *
+ * @see m_cfifo_bench.c
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "m_cfifo.h"
+#include "m_cfifo_spsc.h"
+#include "m_cfifo_mpmc.h"
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#define STRESS_DEFAULT_BYTES  (1024u * 1024u)
+#define STRESS_MAX_DEPTH      16u
+#define STRESS_STORAGE        65536u
+#define STRESS_MAX_CHUNK      512u
+#define STRESS_PATTERN_PERIOD 251u
+#define STRESS_SAMPLE_EVERY   16u
+#define STRESS_LATENCY_BINS   40u
+#define STRESS_STALL_NS       (10ull * 1000000000ull)
+#define STRESS_POLL_NS        1000000l
+#define STRESS_MAX_BASELINE   256u
+#define STRESS_MPMC_RECORD    8u
+#define STRESS_MSG_SEQ        4u
+
+#define STRESS_EXIT_FAILED     1
+#define STRESS_EXIT_REGRESSION 2
+#define STRESS_EXIT_USAGE      3
+
+
+
+//*****************************************************************************
+// Local Types
+//*****************************************************************************
+
+/**
+ * @brief Sampled call latencies in power-of-two nanosecond buckets.
+ */
+typedef struct
+{
+  uint64_t count;
+  uint64_t bin[STRESS_LATENCY_BINS];
+}stress_tLatency;
+
+struct stress_case;
+
+/**
+ * @brief Moves up to @p len bytes; returns the number moved.
+ */
+typedef uint32_t (*stress_tTransfer)(struct stress_case* c, uint8_t* data, uint32_t len);
+
+/**
+ * @brief One FIFO mode under test.
+ *
+ * Stream modes provide `push`/`pop` and share the stream threads; the
+ * others provide their own thread functions.
+ */
+typedef struct
+{
+  const char* name;
+  bool cascaded;
+  uint32_t bytes_divisor;
+  void (*setup)(struct stress_case* c);
+  stress_tTransfer push;
+  stress_tTransfer pop;
+  void* (*producer)(void* arg);
+  void* (*consumer)(void* arg);
+}stress_tMode;
+
+/**
+ * @brief State of one running case, shared by its threads.
+ */
+typedef struct stress_case
+{
+  const stress_tMode* mode;
+  uint32_t depth;
+  uint32_t segment_size;
+  uint32_t capacity;
+  uint32_t bytes;
+  bool ordered;
+  uint32_t histogram[256];
+
+  _Atomic bool abort;
+  _Atomic uint32_t progress;
+  _Atomic uint32_t running;
+  uint64_t stop;
+  bool failed;
+  char error[160];
+  pthread_mutex_t error_lock;
+
+  stress_tLatency push_latency;
+  stress_tLatency pop_latency;
+
+  m_cfifo_tSpscWriter writer;
+  m_cfifo_tSpscReader reader;
+  uint32_t msg_count;
+  uint8_t* msg_seen;
+  uint32_t mpmc_records;
+  _Atomic uint64_t mpmc_seq_sum[2];
+  stress_tLatency mpmc_latency[4];
+}stress_tCase;
+
+/**
+ * @brief Start argument of a case thread.
+ */
+typedef struct
+{
+  stress_tCase* c;
+  void* (*run)(void* arg);
+}stress_tThread;
+
+/**
+ * @brief One line of a baseline file.
+ */
+typedef struct
+{
+  char mode[24];
+  uint32_t depth;
+  uint32_t size;
+  double mb_per_s;
+}stress_tBaseline;
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+static uint64_t stress_Now(void);
+static uint32_t stress_Random(uint32_t* state);
+static void stress_Fail(stress_tCase* c, const char* fmt, ...);
+static void stress_Record(stress_tLatency* lat, uint64_t ns);
+static uint64_t stress_Percentile(const stress_tLatency* lat, uint32_t percent);
+static void stress_Merge(stress_tLatency* dst, const stress_tLatency* src);
+
+static void stress_SetupCore(stress_tCase* c);
+static void stress_SetupSpsc(stress_tCase* c);
+static void stress_SetupSpscBatch(stress_tCase* c);
+static void stress_SetupMpmc(stress_tCase* c);
+
+static uint32_t stress_ThisPushN(stress_tCase* c, uint8_t* data, uint32_t len);
+static uint32_t stress_ThisPopN(stress_tCase* c, uint8_t* data, uint32_t len);
+static uint32_t stress_AllPushN(stress_tCase* c, uint8_t* data, uint32_t len);
+static uint32_t stress_AllPopN(stress_tCase* c, uint8_t* data, uint32_t len);
+static uint32_t stress_AllPush(stress_tCase* c, uint8_t* data, uint32_t len);
+static uint32_t stress_AllPop(stress_tCase* c, uint8_t* data, uint32_t len);
+static uint32_t stress_SpscPushN(stress_tCase* c, uint8_t* data, uint32_t len);
+static uint32_t stress_SpscPopN(stress_tCase* c, uint8_t* data, uint32_t len);
+static uint32_t stress_WriterPushN(stress_tCase* c, uint8_t* data, uint32_t len);
+static uint32_t stress_ReaderPopN(stress_tCase* c, uint8_t* data, uint32_t len);
+
+static void* stress_StreamProducer(void* arg);
+static void* stress_StreamConsumer(void* arg);
+static void* stress_MsgProducer(void* arg);
+static void* stress_MsgConsumer(void* arg);
+static void* stress_MpmcProducer(void* arg);
+static void* stress_MpmcConsumer(void* arg);
+
+static uint32_t stress_MsgLen(const stress_tCase* c, uint32_t seq);
+static void stress_SetupMsg(stress_tCase* c);
+static void* stress_Thread(void* arg);
+static void stress_Report(stress_tCase* c, uint32_t threads, double seconds, FILE* baseline_out);
+static bool stress_RunCase(const stress_tMode* mode, uint32_t depth, uint32_t size, FILE* baseline_out);
+static bool stress_LoadBaseline(const char* path);
+static const stress_tBaseline* stress_FindBaseline(const char* mode, uint32_t depth, uint32_t size);
+
+
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static const stress_tMode stress_modes[] =
+{
+  { "this_n",     false, 1,  stress_SetupCore,      stress_ThisPushN,   stress_ThisPopN,   stress_StreamProducer, stress_StreamConsumer },
+  { "all_n",      true,  1,  stress_SetupCore,      stress_AllPushN,    stress_AllPopN,    stress_StreamProducer, stress_StreamConsumer },
+  { "all_byte",   true,  16, stress_SetupCore,      stress_AllPush,     stress_AllPop,     stress_StreamProducer, stress_StreamConsumer },
+  { "all_msg",    true,  1,  stress_SetupMsg,       NULL,               NULL,              stress_MsgProducer,    stress_MsgConsumer },
+  { "spsc_n",     false, 1,  stress_SetupSpsc,      stress_SpscPushN,   stress_SpscPopN,   stress_StreamProducer, stress_StreamConsumer },
+  { "spsc_batch", false, 1,  stress_SetupSpscBatch, stress_WriterPushN, stress_ReaderPopN, stress_StreamProducer, stress_StreamConsumer },
+  { "mpmc",       false, 1,  stress_SetupMpmc,      NULL,               NULL,              stress_MpmcProducer,   stress_MpmcConsumer },
+};
+
+static const uint32_t stress_sizes[] = { 8u, 61u, 256u, 4096u, 65535u };
+
+static uint8_t stress_pattern[STRESS_PATTERN_PERIOD + STRESS_MAX_CHUNK];
+static uint8_t stress_storage[STRESS_STORAGE];
+static uint32_t stress_mpmc_storage[STRESS_STORAGE / sizeof(uint32_t)];
+
+static m_cfifo_tCFifo stress_fifo[STRESS_MAX_DEPTH];
+static m_cfifo_tCascade stress_cascade;
+static m_cfifo_tSpscFifo stress_spsc;
+static m_cfifo_tMpmcFifo stress_mpmc;
+static pthread_mutex_t stress_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t stress_bytes = STRESS_DEFAULT_BYTES;
+static double stress_tolerance = 0.3;
+static stress_tBaseline stress_baseline[STRESS_MAX_BASELINE];
+static uint32_t stress_baseline_count;
+static bool stress_regression;
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static uint64_t stress_Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t stress_Random(uint32_t* state)
+{
+  // xorshift32: same sequence in every thread seeded alike
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static void stress_Fail(stress_tCase* c, const char* fmt, ...)
+{
+  va_list args;
+
+  pthread_mutex_lock(&c->error_lock);
+  if (!c->failed)
+  {
+    c->failed = true;
+    va_start(args, fmt);
+    vsnprintf(c->error, sizeof(c->error), fmt, args);
+    va_end(args);
+  }
+  pthread_mutex_unlock(&c->error_lock);
+  atomic_store(&c->abort, true);
+}
+
+static void stress_Record(stress_tLatency* lat, uint64_t ns)
+{
+  uint32_t bin = 0;
+
+  while (ns > 1 && bin < STRESS_LATENCY_BINS - 1u)
+  {
+    ns >>= 1;
+    bin++;
+  }
+  lat->bin[bin]++;
+  lat->count++;
+}
+
+static uint64_t stress_Percentile(const stress_tLatency* lat, uint32_t percent)
+{
+  uint64_t rank = (lat->count * percent + 99u) / 100u;
+  uint64_t seen = 0;
+
+  for (uint32_t bin = 0; bin < STRESS_LATENCY_BINS; bin++)
+  {
+    seen += lat->bin[bin];
+    if (seen >= rank && seen != 0)
+      return 2ull << bin;
+  }
+
+  return 0;
+}
+
+static void stress_Merge(stress_tLatency* dst, const stress_tLatency* src)
+{
+  for (uint32_t bin = 0; bin < STRESS_LATENCY_BINS; bin++)
+    dst->bin[bin] += src->bin[bin];
+  dst->count += src->count;
+}
+
+static void stress_SetupCore(stress_tCase* c)
+{
+  for (uint32_t i = 0; i < c->depth; i++)
+  {
+    m_cfifo_InitBuffer(&stress_fifo[i]);
+    m_cfifo_ConfigBuffer(&stress_fifo[i], &stress_storage[i * c->segment_size], (m_cfifo_tIndex)c->segment_size);
+    m_cfifo_This_Clear(&stress_fifo[i]);
+    if (i > 0)
+      m_cfifo_CascadeAsNextBuffer(&stress_fifo[i - 1], &stress_fifo[i]);
+  }
+
+  if (c->mode->cascaded)
+    m_cfifo_AttachCascade(&stress_cascade, &stress_fifo[0]);
+}
+
+static void stress_SetupSpsc(stress_tCase* c)
+{
+  m_cfifo_Spsc_InitBuffer(&stress_spsc);
+  m_cfifo_Spsc_ConfigBuffer(&stress_spsc, stress_storage, (uint16_t)c->capacity);
+}
+
+static void stress_SetupSpscBatch(stress_tCase* c)
+{
+  uint16_t batch = (uint16_t)((c->capacity < 128u) ? c->capacity / 4u : 32u);
+
+  stress_SetupSpsc(c);
+  m_cfifo_Spsc_WriterInit(&c->writer, &stress_spsc, batch);
+  m_cfifo_Spsc_ReaderInit(&c->reader, &stress_spsc, batch);
+}
+
+static void stress_SetupMpmc(stress_tCase* c)
+{
+  m_cfifo_Mpmc_InitBuffer(&stress_mpmc);
+  m_cfifo_Mpmc_ConfigBuffer(&stress_mpmc, stress_mpmc_storage, (uint16_t)(c->capacity / STRESS_MPMC_RECORD), STRESS_MPMC_RECORD);
+  c->capacity = m_cfifo_Mpmc_GetRecordCapacity(&stress_mpmc) * STRESS_MPMC_RECORD;
+
+  // Two producers, each sending half of the bytes
+  c->mpmc_records = c->bytes / (2u * STRESS_MPMC_RECORD);
+  c->bytes = 2u * c->mpmc_records * STRESS_MPMC_RECORD;
+  atomic_init(&c->mpmc_seq_sum[0], 0);
+  atomic_init(&c->mpmc_seq_sum[1], 0);
+}
+
+static uint32_t stress_ThisPushN(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  m_cfifo_tIndex n;
+
+  (void)c;
+  pthread_mutex_lock(&stress_lock);
+  n = m_cfifo_This_PushN(&stress_fifo[0], data, (m_cfifo_tIndex)len);
+  pthread_mutex_unlock(&stress_lock);
+
+  return n;
+}
+
+static uint32_t stress_ThisPopN(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  m_cfifo_tIndex n;
+
+  (void)c;
+  pthread_mutex_lock(&stress_lock);
+  n = m_cfifo_This_PopN(&stress_fifo[0], data, (m_cfifo_tIndex)len);
+  pthread_mutex_unlock(&stress_lock);
+
+  return n;
+}
+
+static uint32_t stress_AllPushN(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  m_cfifo_tIndex n;
+
+  (void)c;
+  pthread_mutex_lock(&stress_lock);
+  n = m_cfifo_All_PushN(&stress_fifo[0], data, (m_cfifo_tIndex)len);
+  pthread_mutex_unlock(&stress_lock);
+
+  return n;
+}
+
+static uint32_t stress_AllPopN(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  m_cfifo_tIndex n;
+
+  (void)c;
+  pthread_mutex_lock(&stress_lock);
+  n = m_cfifo_All_PopN(&stress_fifo[0], data, (m_cfifo_tIndex)len);
+  pthread_mutex_unlock(&stress_lock);
+
+  return n;
+}
+
+static uint32_t stress_AllPush(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  uint32_t n = 0;
+  bool ok = true;
+
+  (void)c;
+  while (ok && n < len)
+  {
+    pthread_mutex_lock(&stress_lock);
+    ok = m_cfifo_All_Push(&stress_fifo[0], data[n]);
+    pthread_mutex_unlock(&stress_lock);
+    if (ok)
+      n++;
+  }
+
+  return n;
+}
+
+static uint32_t stress_AllPop(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  uint32_t n = 0;
+  bool ok = true;
+
+  (void)c;
+  while (ok && n < len)
+  {
+    pthread_mutex_lock(&stress_lock);
+    ok = m_cfifo_All_Pop(&stress_fifo[0], &data[n]);
+    pthread_mutex_unlock(&stress_lock);
+    if (ok)
+      n++;
+  }
+
+  return n;
+}
+
+static uint32_t stress_SpscPushN(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  (void)c;
+  return m_cfifo_Spsc_PushN(&stress_spsc, data, (uint16_t)len);
+}
+
+static uint32_t stress_SpscPopN(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  (void)c;
+  return m_cfifo_Spsc_PopN(&stress_spsc, data, (uint16_t)len);
+}
+
+static uint32_t stress_WriterPushN(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  uint32_t n = m_cfifo_Spsc_WriterPushN(&c->writer, data, (uint16_t)len);
+
+  // Publish a partial batch instead of waiting for the ring to fill
+  if (n < len)
+    m_cfifo_Spsc_WriterFlush(&c->writer);
+
+  return n;
+}
+
+static uint32_t stress_ReaderPopN(stress_tCase* c, uint8_t* data, uint32_t len)
+{
+  uint32_t n = m_cfifo_Spsc_ReaderPopN(&c->reader, data, (uint16_t)len);
+
+  if (n < len)
+    m_cfifo_Spsc_ReaderFlush(&c->reader);
+
+  return n;
+}
+
+static void* stress_StreamProducer(void* arg)
+{
+  stress_tCase* c = (stress_tCase*)arg;
+  uint32_t max_chunk = (c->capacity * 2u < STRESS_MAX_CHUNK) ? c->capacity * 2u : STRESS_MAX_CHUNK;
+  uint32_t rnd = 0x9E3779B9u;
+  uint32_t sent = 0;
+  uint32_t calls = 0;
+  uint32_t len;
+  uint32_t n;
+  uint64_t t0 = 0;
+
+  while (sent < c->bytes && !atomic_load_explicit(&c->abort, memory_order_relaxed))
+  {
+    len = 1u + stress_Random(&rnd) % max_chunk;
+    if (len > c->bytes - sent)
+      len = c->bytes - sent;
+
+    if (++calls % STRESS_SAMPLE_EVERY == 0)
+      t0 = stress_Now();
+    n = c->mode->push(c, &stress_pattern[sent % STRESS_PATTERN_PERIOD], len);
+    if (calls % STRESS_SAMPLE_EVERY == 0 && n != 0)
+      stress_Record(&c->push_latency, stress_Now() - t0);
+
+    if (n == 0)
+      sched_yield();
+    sent += n;
+  }
+
+  if (c->mode->push == stress_WriterPushN)
+    m_cfifo_Spsc_WriterFlush(&c->writer);
+
+  return NULL;
+}
+
+static void* stress_StreamConsumer(void* arg)
+{
+  stress_tCase* c = (stress_tCase*)arg;
+  uint8_t buffer[STRESS_MAX_CHUNK];
+  uint32_t rnd = 0x7F4A7C15u;
+  uint32_t received = 0;
+  uint32_t calls = 0;
+  uint32_t len;
+  uint32_t n;
+  uint64_t t0 = 0;
+
+  while (received < c->bytes && !atomic_load_explicit(&c->abort, memory_order_relaxed))
+  {
+    len = 1u + stress_Random(&rnd) % STRESS_MAX_CHUNK;
+    if (len > c->bytes - received)
+      len = c->bytes - received;
+
+    if (++calls % STRESS_SAMPLE_EVERY == 0)
+      t0 = stress_Now();
+    n = c->mode->pop(c, buffer, len);
+    if (calls % STRESS_SAMPLE_EVERY == 0 && n != 0)
+      stress_Record(&c->pop_latency, stress_Now() - t0);
+
+    if (n == 0)
+    {
+      sched_yield();
+      continue;
+    }
+
+    if (!c->ordered)
+    {
+      for (uint32_t i = 0; i < n; i++)
+        c->histogram[buffer[i]]++;
+    }
+    else if (memcmp(buffer, &stress_pattern[received % STRESS_PATTERN_PERIOD], n) != 0)
+    {
+      for (uint32_t i = 0; i < n; i++)
+      {
+        if (buffer[i] != stress_pattern[(received + i) % STRESS_PATTERN_PERIOD])
+        {
+          stress_Fail(c, "byte %u is 0x%02x, expected 0x%02x", (unsigned)(received + i), (unsigned)buffer[i],
+                      (unsigned)stress_pattern[(received + i) % STRESS_PATTERN_PERIOD]);
+          break;
+        }
+      }
+      break;
+    }
+
+    received += n;
+    atomic_fetch_add_explicit(&c->progress, n, memory_order_relaxed);
+  }
+
+  return NULL;
+}
+
+static uint32_t stress_MsgLen(const stress_tCase* c, uint32_t seq)
+{
+  uint32_t max = c->segment_size - (uint32_t)M_CFIFO_MSG_HEADER_MAX;
+  uint32_t x = seq * 0x9E3779B1u;
+
+  if (max > STRESS_MAX_CHUNK)
+    max = STRESS_MAX_CHUNK;
+  x ^= x >> 15;
+
+  // Sequence number plus pattern, so that every message checks itself
+  return STRESS_MSG_SEQ + x % (max - STRESS_MSG_SEQ + 1u);
+}
+
+static void stress_SetupMsg(stress_tCase* c)
+{
+  uint32_t bytes = 0;
+
+  stress_SetupCore(c);
+
+  c->msg_count = 0;
+  while (bytes < c->bytes)
+    bytes += stress_MsgLen(c, c->msg_count++);
+  c->bytes = bytes;
+  c->msg_seen = calloc(c->msg_count, 1);
+}
+
+static void* stress_MsgProducer(void* arg)
+{
+  stress_tCase* c = (stress_tCase*)arg;
+  uint8_t msg[STRESS_MAX_CHUNK];
+  uint32_t calls = 0;
+  uint32_t len;
+  bool ok;
+  uint64_t t0 = 0;
+
+  for (uint32_t seq = 0; seq < c->msg_count && !atomic_load_explicit(&c->abort, memory_order_relaxed); seq++)
+  {
+    len = stress_MsgLen(c, seq);
+    memcpy(msg, &seq, STRESS_MSG_SEQ);
+    memcpy(&msg[STRESS_MSG_SEQ], &stress_pattern[seq % STRESS_PATTERN_PERIOD], len - STRESS_MSG_SEQ);
+
+    do
+    {
+      if (++calls % STRESS_SAMPLE_EVERY == 0)
+        t0 = stress_Now();
+      pthread_mutex_lock(&stress_lock);
+      ok = m_cfifo_All_PushMsg(&stress_fifo[0], msg, (m_cfifo_tIndex)len);
+      pthread_mutex_unlock(&stress_lock);
+      if (calls % STRESS_SAMPLE_EVERY == 0 && ok)
+        stress_Record(&c->push_latency, stress_Now() - t0);
+      if (!ok)
+        sched_yield();
+    } while (!ok && !atomic_load_explicit(&c->abort, memory_order_relaxed));
+  }
+
+  return NULL;
+}
+
+static void* stress_MsgConsumer(void* arg)
+{
+  stress_tCase* c = (stress_tCase*)arg;
+  uint8_t msg[STRESS_MAX_CHUNK];
+  uint32_t received = 0;
+  uint32_t calls = 0;
+  uint32_t seq;
+  m_cfifo_tIndex len;
+  bool ok;
+  uint64_t t0 = 0;
+
+  while (received < c->msg_count && !atomic_load_explicit(&c->abort, memory_order_relaxed))
+  {
+    if (++calls % STRESS_SAMPLE_EVERY == 0)
+      t0 = stress_Now();
+    pthread_mutex_lock(&stress_lock);
+    ok = m_cfifo_All_PopMsg(&stress_fifo[0], msg, sizeof(msg), &len);
+    pthread_mutex_unlock(&stress_lock);
+    if (calls % STRESS_SAMPLE_EVERY == 0 && ok)
+      stress_Record(&c->pop_latency, stress_Now() - t0);
+
+    if (!ok)
+    {
+      sched_yield();
+      continue;
+    }
+
+    memcpy(&seq, msg, STRESS_MSG_SEQ);
+    if (len < STRESS_MSG_SEQ || seq >= c->msg_count || len != stress_MsgLen(c, seq) ||
+        memcmp(&msg[STRESS_MSG_SEQ], &stress_pattern[seq % STRESS_PATTERN_PERIOD], len - STRESS_MSG_SEQ) != 0)
+    {
+      stress_Fail(c, "message %u of %u is corrupted (length %u)", (unsigned)received, (unsigned)c->msg_count, (unsigned)len);
+      break;
+    }
+    if (c->msg_seen[seq] != 0 || (c->ordered && seq != received))
+    {
+      stress_Fail(c, "message %u arrived as number %u", (unsigned)seq, (unsigned)received);
+      break;
+    }
+
+    c->msg_seen[seq] = 1;
+    received++;
+    atomic_fetch_add_explicit(&c->progress, len, memory_order_relaxed);
+  }
+
+  return NULL;
+}
+
+static void* stress_MpmcProducer(void* arg)
+{
+  stress_tCase* c = (stress_tCase*)arg;
+  static _Atomic uint32_t next_id;
+  uint32_t record[2];
+  uint32_t id = atomic_fetch_add(&next_id, 1u) & 1u;
+  uint32_t calls = 0;
+  uint32_t seq = 0;
+  bool ok;
+  uint64_t t0 = 0;
+
+  record[0] = id;
+  while (seq < c->mpmc_records && !atomic_load_explicit(&c->abort, memory_order_relaxed))
+  {
+    record[1] = seq;
+    if (++calls % STRESS_SAMPLE_EVERY == 0)
+      t0 = stress_Now();
+    ok = m_cfifo_Mpmc_Push(&stress_mpmc, record);
+    if (calls % STRESS_SAMPLE_EVERY == 0 && ok)
+      stress_Record(&c->mpmc_latency[id], stress_Now() - t0);
+
+    if (ok)
+      seq++;
+    else
+      sched_yield();
+  }
+
+  return NULL;
+}
+
+static void* stress_MpmcConsumer(void* arg)
+{
+  stress_tCase* c = (stress_tCase*)arg;
+  static _Atomic uint32_t next_id;
+  uint32_t record[2];
+  uint32_t id = 2u + (atomic_fetch_add(&next_id, 1u) & 1u);
+  int64_t last[2] = { -1, -1 };
+  uint32_t calls = 0;
+  bool ok;
+  uint64_t t0 = 0;
+
+  while (atomic_load(&c->progress) < c->bytes && !atomic_load_explicit(&c->abort, memory_order_relaxed))
+  {
+    if (++calls % STRESS_SAMPLE_EVERY == 0)
+      t0 = stress_Now();
+    ok = m_cfifo_Mpmc_Pop(&stress_mpmc, record);
+    if (calls % STRESS_SAMPLE_EVERY == 0 && ok)
+      stress_Record(&c->mpmc_latency[id], stress_Now() - t0);
+
+    if (!ok)
+    {
+      sched_yield();
+      continue;
+    }
+
+    // Records of one producer are dequeued in order by every consumer
+    if (record[0] > 1u || record[1] >= c->mpmc_records || (int64_t)record[1] <= last[record[0]])
+    {
+      stress_Fail(c, "record %u of producer %u out of order", (unsigned)record[1], (unsigned)record[0]);
+      break;
+    }
+    last[record[0]] = record[1];
+    atomic_fetch_add(&c->mpmc_seq_sum[record[0]], record[1]);
+    atomic_fetch_add(&c->progress, STRESS_MPMC_RECORD);
+  }
+
+  return NULL;
+}
+
+static void* stress_Thread(void* arg)
+{
+  stress_tThread* thread = (stress_tThread*)arg;
+
+  thread->run(thread->c);
+  if (atomic_fetch_sub(&thread->c->running, 1u) == 1u)
+    thread->c->stop = stress_Now();
+
+  return NULL;
+}
+
+static void stress_Report(stress_tCase* c, uint32_t threads, double seconds, FILE* baseline_out)
+{
+  double mb_per_s = (seconds > 0.0) ? (double)c->bytes / seconds / 1e6 : 0.0;
+  const stress_tBaseline* base = stress_FindBaseline(c->mode->name, c->depth, c->capacity);
+  const char* status = "ok";
+
+  if (c->failed)
+    status = "failed";
+  else if (base != NULL && mb_per_s < base->mb_per_s * (1.0 - stress_tolerance))
+  {
+    status = "regression";
+    stress_regression = true;
+  }
+
+  printf("{\"mode\":\"%s\",\"depth\":%u,\"size\":%u,\"threads\":%u,\"ordered\":%s,\"bytes\":%u,\"seconds\":%.6f,"
+         "\"mb_per_s\":%.3f,\"push_p50_ns\":%llu,\"push_p99_ns\":%llu,\"pop_p50_ns\":%llu,\"pop_p99_ns\":%llu",
+         c->mode->name, (unsigned)c->depth, (unsigned)c->capacity, (unsigned)threads, c->ordered ? "true" : "false", (unsigned)c->bytes, seconds, mb_per_s,
+         (unsigned long long)stress_Percentile(&c->push_latency, 50), (unsigned long long)stress_Percentile(&c->push_latency, 99),
+         (unsigned long long)stress_Percentile(&c->pop_latency, 50), (unsigned long long)stress_Percentile(&c->pop_latency, 99));
+  if (base != NULL)
+    printf(",\"baseline_mb_per_s\":%.3f", base->mb_per_s);
+  printf(",\"status\":\"%s\"", status);
+  if (c->failed)
+    printf(",\"error\":\"%s\"", c->error);
+  printf("}\n");
+  fflush(stdout);
+
+  if (baseline_out != NULL && !c->failed)
+    fprintf(baseline_out, "%s %u %u %.3f\n", c->mode->name, (unsigned)c->depth, (unsigned)c->capacity, mb_per_s);
+}
+
+static bool stress_RunCase(const stress_tMode* mode, uint32_t depth, uint32_t size, FILE* baseline_out)
+{
+  static stress_tCase c;
+  stress_tThread args[4];
+  pthread_t thread[4];
+  uint32_t threads = (mode->setup == stress_SetupMpmc) ? 4u : 2u;
+  uint32_t started = 0;
+  uint32_t progress = 0;
+  bool stalled = false;
+  struct timespec poll = { 0, STRESS_POLL_NS };
+  uint64_t start;
+  uint64_t last_progress;
+
+  memset(&c, 0, sizeof(c));
+  c.mode = mode;
+  c.depth = depth;
+  c.segment_size = (size / depth == 0) ? 1u : size / depth;
+  c.capacity = c.segment_size * depth;
+  c.bytes = stress_bytes / mode->bytes_divisor;
+
+  // Cascaded pushes fill the first segment with room and pops drain the
+  // first non-empty one, so interleaved data may overtake across segments
+  c.ordered = (depth == 1u);
+
+  // Skip cases the mode cannot represent
+  if (mode->setup == stress_SetupMsg && c.segment_size < M_CFIFO_MSG_HEADER_MAX + STRESS_MSG_SEQ)
+    return true;
+  if (mode->setup == stress_SetupMpmc && c.capacity < 2u * STRESS_MPMC_RECORD)
+    return true;
+  if ((mode->setup == stress_SetupSpsc || mode->setup == stress_SetupSpscBatch) && c.capacity > M_CFIFO_SPSC_MAX_SIZE)
+    c.capacity = M_CFIFO_SPSC_MAX_SIZE;
+
+  atomic_init(&c.abort, false);
+  atomic_init(&c.progress, 0);
+  atomic_init(&c.running, threads);
+  pthread_mutex_init(&c.error_lock, NULL);
+  mode->setup(&c);
+
+  start = stress_Now();
+  for (uint32_t i = 0; i < threads; i++)
+  {
+    args[i].c = &c;
+    args[i].run = (i & 1u) ? mode->consumer : mode->producer;
+    if (pthread_create(&thread[i], NULL, stress_Thread, &args[i]) != 0)
+    {
+      stress_Fail(&c, "cannot start thread %u", (unsigned)i);
+      atomic_fetch_sub(&c.running, threads - i);
+      break;
+    }
+    started++;
+  }
+
+  // Watchdog: a stalled case is aborted; a thread stuck inside a FIFO call
+  // cannot be, so the harness reports and exits instead
+  last_progress = start;
+  while (atomic_load(&c.running) != 0)
+  {
+    nanosleep(&poll, NULL);
+    if (atomic_load_explicit(&c.progress, memory_order_relaxed) != progress)
+    {
+      progress = atomic_load_explicit(&c.progress, memory_order_relaxed);
+      last_progress = stress_Now();
+    }
+    else if (stress_Now() - last_progress > STRESS_STALL_NS)
+    {
+      if (stalled)
+      {
+        stress_Report(&c, threads, (double)(stress_Now() - start) / 1e9, NULL);
+        exit(STRESS_EXIT_FAILED);
+      }
+      stress_Fail(&c, "stalled after %u of %u bytes", (unsigned)progress, (unsigned)c.bytes);
+      stalled = true;
+      last_progress = stress_Now();
+    }
+  }
+  for (uint32_t i = 0; i < started; i++)
+    pthread_join(thread[i], NULL);
+  if (c.stop == 0)
+    c.stop = stress_Now();
+
+  if (!c.ordered && mode->setup != stress_SetupMsg && !c.failed)
+  {
+    for (uint32_t v = 0; v < 256u; v++)
+    {
+      uint32_t expect = c.bytes / STRESS_PATTERN_PERIOD + ((v < c.bytes % STRESS_PATTERN_PERIOD) ? 1u : 0u);
+
+      if (v >= STRESS_PATTERN_PERIOD)
+        expect = 0;
+      if (c.histogram[v] != expect)
+      {
+        stress_Fail(&c, "byte 0x%02x received %u times, expected %u", (unsigned)v, (unsigned)c.histogram[v], (unsigned)expect);
+        break;
+      }
+    }
+  }
+
+  if (mode->setup == stress_SetupMpmc)
+  {
+    uint64_t expect = (uint64_t)c.mpmc_records * (c.mpmc_records - 1u) / 2u;
+
+    for (uint32_t p = 0; p < 2u; p++)
+    {
+      if (!c.failed && atomic_load(&c.mpmc_seq_sum[p]) != expect)
+        stress_Fail(&c, "producer %u: records lost or duplicated", (unsigned)p);
+    }
+    stress_Merge(&c.push_latency, &c.mpmc_latency[0]);
+    stress_Merge(&c.push_latency, &c.mpmc_latency[1]);
+    stress_Merge(&c.pop_latency, &c.mpmc_latency[2]);
+    stress_Merge(&c.pop_latency, &c.mpmc_latency[3]);
+  }
+
+  stress_Report(&c, threads, (double)(c.stop - start) / 1e9, baseline_out);
+
+  free(c.msg_seen);
+  pthread_mutex_destroy(&c.error_lock);
+
+  return !c.failed;
+}
+static bool stress_LoadBaseline(const char* path)
+{
+  FILE* f = fopen(path, "r");
+  char line[128];
+  stress_tBaseline* b;
+
+  if (f == NULL)
+    return false;
+
+  while (fgets(line, sizeof(line), f) != NULL && stress_baseline_count < STRESS_MAX_BASELINE)
+  {
+    b = &stress_baseline[stress_baseline_count];
+    if (line[0] == '#')
+      continue;
+    if (sscanf(line, "%23s %u %u %lf", b->mode, &b->depth, &b->size, &b->mb_per_s) == 4)
+      stress_baseline_count++;
+  }
+  fclose(f);
+
+  return true;
+}
+
+static const stress_tBaseline* stress_FindBaseline(const char* mode, uint32_t depth, uint32_t size)
+{
+  for (uint32_t i = 0; i < stress_baseline_count; i++)
+  {
+    if (strcmp(stress_baseline[i].mode, mode) == 0 && stress_baseline[i].depth == depth && stress_baseline[i].size == size)
+      return &stress_baseline[i];
+  }
+
+  return NULL;
+}
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+int main(int argc, char** argv)
+{
+  const char* only = NULL;
+  const char* write_path = NULL;
+  FILE* baseline_out = NULL;
+  bool passed = true;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--bytes") == 0 && i + 1 < argc)
+      stress_bytes = (uint32_t)strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc)
+      only = argv[++i];
+    else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+      stress_tolerance = strtod(argv[++i], NULL);
+    else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+    {
+      if (!stress_LoadBaseline(argv[++i]))
+      {
+        fprintf(stderr, "cannot read baseline %s\n", argv[i]);
+        return STRESS_EXIT_USAGE;
+      }
+    }
+    else if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc)
+      write_path = argv[++i];
+    else
+    {
+      fprintf(stderr, "usage: %s [--bytes N] [--mode NAME] [--baseline FILE] [--tolerance F] [--write-baseline FILE]\n", argv[0]);
+      return STRESS_EXIT_USAGE;
+    }
+  }
+  if (stress_bytes < STRESS_MAX_CHUNK)
+    stress_bytes = STRESS_MAX_CHUNK;
+
+  if (write_path != NULL)
+  {
+    baseline_out = fopen(write_path, "w");
+    if (baseline_out == NULL)
+    {
+      fprintf(stderr, "cannot write baseline %s\n", write_path);
+      return STRESS_EXIT_USAGE;
+    }
+    fprintf(baseline_out, "# mode depth size MB/s, written by m_cfifo_stress --bytes %u\n", (unsigned)stress_bytes);
+  }
+
+  for (uint32_t i = 0; i < sizeof(stress_pattern); i++)
+    stress_pattern[i] = (uint8_t)(i % STRESS_PATTERN_PERIOD);
+
+  for (uint32_t m = 0; m < sizeof(stress_modes) / sizeof(stress_modes[0]); m++)
+  {
+    const stress_tMode* mode = &stress_modes[m];
+
+    if (only != NULL && strcmp(only, mode->name) != 0)
+      continue;
+
+    for (uint32_t depth = 1; depth <= (mode->cascaded ? STRESS_MAX_DEPTH : 1u); depth *= 2u)
+    {
+      for (uint32_t s = 0; s < sizeof(stress_sizes) / sizeof(stress_sizes[0]); s++)
+      {
+        if (!stress_RunCase(mode, depth, stress_sizes[s], baseline_out))
+          passed = false;
+      }
+    }
+  }
+
+  if (baseline_out != NULL)
+    fclose(baseline_out);
+
+  if (!passed)
+    return STRESS_EXIT_FAILED;
+  if (stress_regression)
+    return STRESS_EXIT_REGRESSION;
+
+  return 0;
+}
@@ -8,11 +8,16 @@
  * The implementation provides:
  * - Internal versions of push/pop/clear/state operations
  * - Static helper functions for pointer incrementing and adjacency lookup
- * - Public API wrappers with expected semaphore protection points
+ * - Public API wrappers bracketed by @ref M_CFIFO_LOCK / @ref M_CFIFO_UNLOCK
  *
  * Design notes:
- * - Read/write indices wrap using modulo buffer size.
- * - When no buffer is configured, pop operations return the dummy byte.
+ * - Read/write indices wrap with a mask for power-of-two buffer sizes and
+ *   with a compare otherwise; no division is used on the hot paths.
+ * - With @ref M_CFIFO_FREE_RUNNING_INDEX the indices run freely and the
+ *   usage is their difference.
+ * - Without a buffer the FIFO is a pattern source: pops return the dummy
+ *   byte for `buffer_size` bytes, or endlessly for @ref M_CFIFO_INDEX_MAX,
+ *   in which case the indices are not touched at all.
  * - Cascading enables multi-buffer storage through linked FIFO structures.
  *
  * @warning Internal functions must not be called directly outside this module.
@@ -26,6 +31,61 @@
 
 #include "m_cfifo.h"
 #include <stddef.h>
+#include <string.h>
+
+
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#if M_CFIFO_STATS
+#define M_CFIFO_STATS_ADD(cfifo, field, n)  ((cfifo)->stats.field += (n))
+#define M_CFIFO_STATS_PEAK(cfifo)           do { if (m_cfifo_This_GetUsageInternal(cfifo) > (cfifo)->stats.peak_usage) \
+                                                   (cfifo)->stats.peak_usage = m_cfifo_This_GetUsageInternal(cfifo); } while (0)
+#else
+#define M_CFIFO_STATS_ADD(cfifo, field, n)  ((void)0)
+#define M_CFIFO_STATS_PEAK(cfifo)           ((void)0)
+#endif
+
+#if M_CFIFO_PERSIST
+#define M_CFIFO_PERSIST_SAVE(cfifo)         do { if ((cfifo)->persist != NULL) m_cfifo_PersistSave(cfifo); } while (0)
+#else
+#define M_CFIFO_PERSIST_SAVE(cfifo)         ((void)0)
+#endif
+
+#if M_CFIFO_TRACE
+#define M_CFIFO_TRACE_BEGIN(t)                  uint32_t t = m_cfifo_TraceNow()
+#define M_CFIFO_TRACE_END(cfifo, op, t, bytes)  m_cfifo_TraceEmit((cfifo), (cfifo), (op), (t), (bytes))
+#else
+#define M_CFIFO_TRACE_BEGIN(t)                  ((void)0)
+#define M_CFIFO_TRACE_END(cfifo, op, t, bytes)  ((void)0)
+#endif
+
+#if M_CFIFO_TRACE >= 2
+#define M_CFIFO_TRACE_SEGMENT(cfifo, segment, op, bytes)  m_cfifo_TraceEmit((cfifo), (segment), (op), m_cfifo_TraceNow(), (bytes))
+#else
+#define M_CFIFO_TRACE_SEGMENT(cfifo, segment, op, bytes)  ((void)0)
+#endif
+
+// Bytes checksummed per step of a CRC copy, small enough to stay in L1
+#define M_CFIFO_CRC_BLOCK   256u
+
+// Defined in m_cfifo_crc.h; the internal copy functions take an optional
+// CRC state even when M_CFIFO_CRC is 0 and only ever pass NULL then
+struct _cfifo_crc;
+
+
+
+#if M_CFIFO_TRACE
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static m_cfifo_tCFifo* m_cfifo_trace_ring = NULL;
+static m_cfifo_tTraceClock m_cfifo_trace_clock = NULL;
+static m_cfifo_tTotal m_cfifo_trace_dropped = 0;
+#endif
 
 
 
@@ -54,6 +114,7 @@ static bool m_cfifo_This_PushInternal(m_cfifo_tCFifo* cfifo, uint8_t data);
  *
  * Removes and returns the oldest byte from the FIFO.
  * If no buffer is assigned, the configured dummy byte is returned instead.
+ * An endless pattern source is not advanced.
  *
  * @param cfifo Pointer to the FIFO instance.
  * @param data  Output pointer for retrieved byte (may be NULL).
@@ -64,6 +125,297 @@ static bool m_cfifo_This_PushInternal(m_cfifo_tCFifo* cfifo, uint8_t data);
 static bool m_cfifo_This_PopInternal(m_cfifo_tCFifo* cfifo, uint8_t* data);
 
 
+/**
+ * @brief Internal bulk push operation for a single FIFO instance.
+ *
+ * Copies as many bytes as fit into the free space, splitting the copy at
+ * the wrap point of the buffer. The usage counter is updated once.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Source bytes.
+ * @param len   Number of bytes to store.
+ * @param crc   Running CRC updated over the written bytes (NULL for none).
+ *
+ * @return Number of bytes written.
+ */
+static m_cfifo_tIndex m_cfifo_This_PushNInternal(m_cfifo_tCFifo* cfifo, const uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc);
+
+
+/**
+ * @brief Internal bulk push including the overwrite policy.
+ *
+ * Body of @ref m_cfifo_This_PushN without locking. With overwrite enabled,
+ * the oldest bytes are dropped first; the bytes of an oversized block that
+ * can never be stored count as pushed and are added to @p crc as well.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Source bytes.
+ * @param len   Number of bytes to push.
+ * @param crc   Running CRC (NULL for none).
+ *
+ * @return Number of bytes pushed.
+ */
+static m_cfifo_tIndex m_cfifo_This_PushNPolicyInternal(m_cfifo_tCFifo* cfifo, const uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc);
+
+
+/**
+ * @brief Internal cascaded bulk push, the body of @ref m_cfifo_All_PushN.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param data  Source bytes.
+ * @param len   Number of bytes to push.
+ * @param crc   Running CRC (NULL for none).
+ *
+ * @return Number of bytes pushed across all FIFOs.
+ */
+static m_cfifo_tIndex m_cfifo_All_PushNInternal(m_cfifo_tCFifo* cfifo, const uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc);
+
+
+/**
+ * @brief Internal bulk pop operation for a single FIFO instance.
+ *
+ * Copies up to @p len of the oldest bytes out of the FIFO, splitting the
+ * copy at the wrap point of the buffer. The usage counter is updated once.
+ * If no buffer is assigned, the output is filled with the dummy byte and
+ * an endless pattern source is not advanced.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Destination buffer (may be NULL to discard).
+ * @param len   Maximum number of bytes to read.
+ * @param crc   Running CRC updated over the read bytes (NULL for none).
+ *
+ * @return Number of bytes read.
+ */
+static m_cfifo_tIndex m_cfifo_This_PopNInternal(m_cfifo_tCFifo* cfifo, uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc);
+
+
+/**
+ * @brief Internal cascaded bulk pop, the body of @ref m_cfifo_All_PopN.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param data  Destination buffer (may be NULL to discard).
+ * @param len   Maximum number of bytes to pop.
+ * @param crc   Running CRC (NULL for none).
+ *
+ * @return Number of bytes popped across all FIFOs.
+ */
+static m_cfifo_tIndex m_cfifo_All_PopNInternal(m_cfifo_tCFifo* cfifo, uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc);
+
+
+/**
+ * @brief Copies a contiguous region and adds it to a running CRC.
+ *
+ * Without @p crc (or without @ref M_CFIFO_CRC) this is a plain `memcpy`.
+ * Otherwise the region is processed in blocks that are checksummed and
+ * then copied while still in the cache.
+ *
+ * @param dst Destination (may be NULL to only checksum).
+ * @param src Source region.
+ * @param len Number of bytes.
+ * @param crc Running CRC (NULL for none).
+ */
+static void m_cfifo_CopyCrc(uint8_t* dst, const uint8_t* src, m_cfifo_tIndex len, struct _cfifo_crc* crc);
+
+
+/**
+ * @brief Internal non-consuming copy out of a single FIFO instance.
+ *
+ * @param cfifo  Pointer to the FIFO instance.
+ * @param offset Number of stored bytes to skip before copying.
+ * @param data   Destination buffer.
+ * @param len    Maximum number of bytes to copy.
+ *
+ * @return Number of bytes copied.
+ */
+static m_cfifo_tIndex m_cfifo_This_PeekInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex offset, uint8_t* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Internal byte search for a single FIFO instance.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param byte  Byte value to search for.
+ * @param max   Maximum number of stored bytes to scan.
+ * @return Offset from the read pointer, or @ref M_CFIFO_NOT_FOUND.
+ */
+static m_cfifo_tIndex m_cfifo_This_FindInternal(m_cfifo_tCFifo* cfifo, uint8_t byte, m_cfifo_tIndex max);
+
+
+/**
+ * @brief Searches a contiguous memory region for a byte.
+ *
+ * Uses `memchr`, or a word-at-a-time scan with @ref M_CFIFO_FIND_SWAR.
+ *
+ * @param data Start of the region.
+ * @param byte Byte value to search for.
+ * @param len  Length of the region.
+ * @return Offset of the byte, or @ref M_CFIFO_NOT_FOUND.
+ */
+static m_cfifo_tIndex m_cfifo_ScanBytes(const uint8_t* data, uint8_t byte, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Internal all-or-nothing message push for a single FIFO instance.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Payload bytes.
+ * @param len   Payload length.
+ *
+ * @retval true  Header and payload written.
+ * @retval false Not enough space; the FIFO is unchanged.
+ */
+static bool m_cfifo_This_PushMsgInternal(m_cfifo_tCFifo* cfifo, const uint8_t* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Internal decoding of the oldest message header.
+ *
+ * @param cfifo      Pointer to the FIFO instance.
+ * @param len        Output for the payload length.
+ * @param header_len Output for the header length.
+ *
+ * @retval true  A complete message (header and payload) is stored.
+ * @retval false No complete message stored.
+ */
+static bool m_cfifo_This_PeekMsgInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len, m_cfifo_tIndex* header_len);
+
+
+/**
+ * @brief Internal message pop for a single FIFO instance.
+ *
+ * @param cfifo   Pointer to the FIFO instance.
+ * @param data    Destination buffer (may be NULL to discard).
+ * @param max_len Size of the destination buffer.
+ * @param len     Output for the payload length (may be NULL).
+ *
+ * @retval true  Message consumed.
+ * @retval false No complete message, or destination too small.
+ */
+static bool m_cfifo_This_PopMsgInternal(m_cfifo_tCFifo* cfifo, uint8_t* data, m_cfifo_tIndex max_len, m_cfifo_tIndex* len);
+
+
+#if M_CFIFO_OVERWRITE
+/**
+ * @brief Drops the oldest data so that @p len bytes fit into the FIFO.
+ *
+ * The number of dropped bytes is rounded up to a multiple of @p unit so
+ * that records are discarded as a whole, and added to `dropped_count`.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Number of bytes that must fit (at most `buffer_size`).
+ * @param unit  Granularity of the dropped data (1 for bytes).
+ */
+static void m_cfifo_This_DropOldestInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len, m_cfifo_tIndex unit);
+
+
+/**
+ * @brief Drops the oldest messages until a message of @p len bytes fits.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Payload length of the message to store.
+ *
+ * @retval true  Header and payload fit into the free space.
+ * @retval false The message is larger than the buffer, or the stored data
+ *               does not start with a complete message.
+ */
+static bool m_cfifo_This_DropMsgInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len);
+#endif
+
+
+/**
+ * @brief Internal lookup of the contiguous free region at the write pointer.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Output for the region size in bytes.
+ *
+ * @return Start of the region, or NULL if no space is available.
+ */
+static uint8_t* m_cfifo_This_GetWriteSpanInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len);
+
+
+/**
+ * @brief Internal lookup of the contiguous stored region at the read pointer.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Output for the region size in bytes.
+ *
+ * @return Start of the region, or NULL if no data is available.
+ */
+static uint8_t* m_cfifo_This_GetReadSpanInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len);
+
+
+/**
+ * @brief Internal copy of stored bytes from one FIFO into another.
+ *
+ * Copies the overlap of the read spans of @p src and the write spans of
+ * @p dst, so every call needs at most three memory copies. A pattern
+ * source is served with memset instead.
+ *
+ * @param dst       Destination FIFO.
+ * @param src       Source FIFO.
+ * @param max_bytes Maximum number of bytes to move.
+ *
+ * @return Number of bytes moved.
+ */
+static m_cfifo_tIndex m_cfifo_This_TransferInternal(m_cfifo_tCFifo* dst, m_cfifo_tCFifo* src, m_cfifo_tIndex max_bytes);
+
+
+/**
+ * @brief Takes the locks of two FIFOs without risking a lock-order deadlock.
+ *
+ * A lock shared by both (@ref M_CFIFO_SAME_LOCK) is taken once; distinct
+ * locks are taken in address order.
+ *
+ * @param a First FIFO.
+ * @param b Second FIFO.
+ */
+static void m_cfifo_LockPair(m_cfifo_tCFifo* a, m_cfifo_tCFifo* b);
+
+
+/**
+ * @brief Releases the locks taken by @ref m_cfifo_LockPair.
+ *
+ * @param a First FIFO, as given to @ref m_cfifo_LockPair.
+ * @param b Second FIFO, as given to @ref m_cfifo_LockPair.
+ */
+static void m_cfifo_UnlockPair(m_cfifo_tCFifo* a, m_cfifo_tCFifo* b);
+
+
+/**
+ * @brief Internal buffer assignment shared by the configuration functions.
+ *
+ * @param cfifo       Pointer to the FIFO instance.
+ * @param buffer      Pointer to the data buffer (may be NULL).
+ * @param buffer_size Size of the buffer in bytes.
+ * @param record_size Size of one record in bytes.
+ */
+static void m_cfifo_ConfigBufferInternal(m_cfifo_tCFifo* cfifo, const void* buffer, m_cfifo_tIndex buffer_size, m_cfifo_tIndex record_size);
+
+
+/**
+ * @brief Internal record push for a single FIFO instance.
+ *
+ * @param cfifo  Pointer to the FIFO instance.
+ * @param record Source record of `record_size` bytes.
+ *
+ * @retval true  Record written.
+ * @retval false Not enough space for a whole record.
+ */
+static bool m_cfifo_This_PushRecordInternal(m_cfifo_tCFifo* cfifo, const uint8_t* record);
+
+
+/**
+ * @brief Internal record pop for a single FIFO instance.
+ *
+ * @param cfifo  Pointer to the FIFO instance.
+ * @param record Destination of `record_size` bytes (may be NULL).
+ *
+ * @retval true  Record read.
+ * @retval false No whole record stored.
+ */
+static bool m_cfifo_This_PopRecordInternal(m_cfifo_tCFifo* cfifo, uint8_t* record);
+
+
 /**
  * @brief Internal reset of FIFO read/write state.
  *
@@ -92,7 +444,7 @@ static void m_cfifo_This_SetFullInternal(m_cfifo_tCFifo* cfifo);
  * @param cfifo Pointer to the FIFO instance.
  * @return Configured buffer size in bytes.
  */
-static uint16_t m_cfifo_This_GetSizeInternal(m_cfifo_tCFifo* cfifo);
+static m_cfifo_tIndex m_cfifo_This_GetSizeInternal(m_cfifo_tCFifo* cfifo);
 
 
 /**
@@ -101,7 +453,7 @@ static uint16_t m_cfifo_This_GetSizeInternal(m_cfifo_tCFifo* cfifo);
  * @param cfifo Pointer to the FIFO instance.
  * @return Number of used bytes.
  */
-static uint16_t m_cfifo_This_GetUsageInternal(m_cfifo_tCFifo* cfifo);
+static m_cfifo_tIndex m_cfifo_This_GetUsageInternal(m_cfifo_tCFifo* cfifo);
 
 
 /**
@@ -126,10 +478,23 @@ static bool m_cfifo_This_IsEmptyInternal(m_cfifo_tCFifo* cfifo);
 static bool m_cfifo_This_IsFullInternal(m_cfifo_tCFifo* cfifo);
 
 
+/**
+ * @brief Internal check for an endless pattern source.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ *
+ * @retval true  No buffer and `buffer_size` is @ref M_CFIFO_INDEX_MAX.
+ * @retval false Buffered FIFO or counted pattern source.
+ */
+static bool m_cfifo_This_IsEndlessInternal(m_cfifo_tCFifo* cfifo);
+
+
 /**
  * @brief Advances the read pointer of the FIFO.
  *
- * Increments the read index and wraps using modulo `buffer_size`.
+ * Increments the read index and removes one byte from the usage count.
+ * The index wraps with `index_mask` for power-of-two sizes and with a
+ * compare otherwise, so no division is needed.
  * Intended only for use inside internal FIFO operations.
  *
  * @param cfifo Pointer to the FIFO instance.
@@ -140,7 +505,9 @@ static void m_cfifo_IncRdPtr(m_cfifo_tCFifo* cfifo);
 /**
  * @brief Advances the write pointer of the FIFO.
  *
- * Increments the write index and wraps using modulo `buffer_size`.
+ * Increments the write index and adds one byte to the usage count.
+ * The index wraps with `index_mask` for power-of-two sizes and with a
+ * compare otherwise, so no division is needed.
  * Intended only for use inside internal FIFO operations.
  *
  * @param cfifo Pointer to the FIFO instance.
@@ -149,331 +516,2131 @@ static void m_cfifo_IncWrPtr(m_cfifo_tCFifo* cfifo);
 
 
 /**
- * @brief Retrieves an adjacent FIFO based on traversal direction.
- *
- * Returns either the `next` or `prev` FIFO depending on the specified
- * direction. Used during cascading operations.
+ * @brief Advances the read pointer of the FIFO by several positions.
  *
- * @param cfifo     Pointer to the current FIFO (may be NULL).
- * @param direction Traversal direction (UP = next, DOWN = prev).
+ * Removes @p count bytes from the usage count. Wraps by a single subtraction
+ * (or `index_mask`), so @p count must not exceed `buffer_size`.
  *
- * @return Pointer to the adjacent FIFO, or NULL if unavailable.
+ * @param cfifo Pointer to the FIFO instance.
+ * @param count Number of positions to advance.
  */
-static m_cfifo_tCFifo* m_cfifo_GetAdjacentFifo(m_cfifo_tCFifo* cfifo, m_cfifo_tDirection direction);
+static void m_cfifo_AddRdPtr(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count);
 
 
+/**
+ * @brief Advances the write pointer of the FIFO by several positions.
+ *
+ * Adds @p count bytes to the usage count. Wraps by a single subtraction
+ * (or `index_mask`), so @p count must not exceed `buffer_size`.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param count Number of positions to advance.
+ */
+static void m_cfifo_AddWrPtr(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count);
 
-//*****************************************************************************
-// Global Functions
-//*****************************************************************************
 
-void m_cfifo_InitBuffer(m_cfifo_tCFifo* cfifo)
-{
-  cfifo->prev = NULL;
-  cfifo->next = NULL;
-  cfifo->dummy_byte = 0x00;
-  m_cfifo_ConfigBuffer(cfifo, NULL, 0);
-}
+/**
+ * @brief Returns the buffer position addressed by the read pointer.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @return Read position in the range `[0, buffer_size)`.
+ */
+static m_cfifo_tIndex m_cfifo_GetRdPos(m_cfifo_tCFifo* cfifo);
 
-void m_cfifo_CascadeAsNextBuffer(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* cfifo_next)
-{
-  //Semaphore take
-  cfifo->next        = cfifo_next;
-  cfifo_next->prev   = cfifo;
-  //Semaphore give
-}
 
-void m_cfifo_ConfigBuffer(m_cfifo_tCFifo* cfifo, const void* buffer, uint16_t buffer_size)
-{
-  //Semaphore take
-  cfifo->buffer      = (uint8_t*)buffer;
-  cfifo->buffer_size = buffer_size;
-  m_cfifo_This_SetFullInternal(cfifo);
-  //Semaphore give
-}
+/**
+ * @brief Returns the buffer position addressed by the write pointer.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @return Write position in the range `[0, buffer_size)`.
+ */
+static m_cfifo_tIndex m_cfifo_GetWrPos(m_cfifo_tCFifo* cfifo);
 
-void m_cfifo_SetDummyByte(m_cfifo_tCFifo* cfifo, uint8_t data)
-{
-  //Semaphore take
-  cfifo->dummy_byte = data;
-  //Semaphore give
-}  
 
-bool m_cfifo_This_Push(m_cfifo_tCFifo* cfifo, uint8_t data)
-{
-    bool res;
+/**
+ * @brief Returns the number of bytes addressable without wrapping.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param pos   Buffer position in the range `[0, buffer_size)`.
+ * @return `buffer_size - pos`, or `buffer_size` for a mirrored buffer.
+ */
+static m_cfifo_tIndex m_cfifo_GetRoomToEnd(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex pos);
 
-    //Semaphore take
-    res = m_cfifo_This_PushInternal(cfifo, data);
-    //Semaphore give
 
-    return res;
-}
+/**
+ * @brief Computes the wrap mask for a buffer size.
+ *
+ * @param buffer_size Size of the buffer in bytes.
+ * @return `buffer_size - 1` if the size is a power of two, otherwise 0.
+ */
+static m_cfifo_tIndex m_cfifo_GetIndexMask(m_cfifo_tIndex buffer_size);
 
-bool m_cfifo_All_Push(m_cfifo_tCFifo* cfifo, uint8_t data)
-{
-  bool success;
-  //Semaphore take
-  m_cfifo_tCFifo* actual_buffer = cfifo;
-  success = false;
-  
-  while (!success && actual_buffer != NULL)
-  {
-    success = m_cfifo_This_PushInternal(actual_buffer, data);
-    actual_buffer = actual_buffer->next;
-  }
-  //Semaphore give
-  return success;
-}
 
-bool m_cfifo_This_Pop(m_cfifo_tCFifo* cfifo, uint8_t* data)
-{
-    bool res;
-    //Semaphore take
-    res = m_cfifo_This_PopInternal(cfifo, data);
-    //Semaphore give
-    return res;
-}
+/**
+ * @brief Checks whether a FIFO is the head of an attached cascade descriptor.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ *
+ * @retval true  Cached cascade totals may be used for @p cfifo.
+ * @retval false The chain has to be walked.
+ */
+static bool m_cfifo_IsCascadeHead(m_cfifo_tCFifo* cfifo);
 
-bool m_cfifo_All_Pop(m_cfifo_tCFifo* cfifo, uint8_t* data)
-{
-  bool success;
-  
-  //Semaphore take
-  m_cfifo_tCFifo* actual_buffer = cfifo;
-  success = false;
-  
-  while (!success && actual_buffer != NULL)
-  {
-    success = m_cfifo_This_PopInternal(actual_buffer, data);
-    actual_buffer = actual_buffer->next;
-  }
-  //Semaphore give
-  
-  return success;
-}
 
-void m_cfifo_This_Clear(m_cfifo_tCFifo* cfifo)
-{
-    //Semaphore take
-     m_cfifo_This_ClearInternal(cfifo);
-    //Semaphore give
+/**
+ * @brief Returns the FIFO a cascaded push walk starts at.
+ *
+ * For the head of an attached cascade this is the write cursor: every
+ * segment before it is known to be full.
+ *
+ * @param cfifo Pointer to the first FIFO of the walk.
+ * @return First FIFO that may accept data, or NULL if all are full.
+ */
+static m_cfifo_tCFifo* m_cfifo_GetWriteCursor(m_cfifo_tCFifo* cfifo);
+
+
+/**
+ * @brief Stores the FIFO a cascaded push walk ended at.
+ *
+ * @param cfifo   Pointer to the first FIFO of the walk.
+ * @param segment FIFO that accepted the last byte, or NULL if all are full.
+ */
+static void m_cfifo_SetWriteCursor(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* segment);
+
+
+/**
+ * @brief Returns the FIFO a cascaded pop walk starts at.
+ *
+ * For the head of an attached cascade this is the read cursor: every
+ * segment before it is known to be empty.
+ *
+ * @param cfifo Pointer to the first FIFO of the walk.
+ * @return First FIFO that may hold data, or NULL if all are empty.
+ */
+static m_cfifo_tCFifo* m_cfifo_GetReadCursor(m_cfifo_tCFifo* cfifo);
+
+
+/**
+ * @brief Stores the FIFO a cascaded pop walk ended at.
+ *
+ * @param cfifo   Pointer to the first FIFO of the walk.
+ * @param segment FIFO that supplied the last byte, or NULL if all are empty.
+ */
+static void m_cfifo_SetReadCursor(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* segment);
+
+
+/**
+ * @brief Returns the FIFO a cascaded push walk continues with.
+ *
+ * This is the `next` FIFO of @p segment. With @ref M_CFIFO_POOL, a pool
+ * segment is appended to the chain of a pooled cascade head instead of
+ * ending the walk, unless @p segment is an empty segment of at least the
+ * pool block size (a fresh segment could not take the data either).
+ *
+ * @param cfifo   Pointer to the first FIFO of the walk.
+ * @param segment FIFO that could not take (all of) the data.
+ * @return Next FIFO, or NULL if the walk ends.
+ */
+static m_cfifo_tCFifo* m_cfifo_GetNextWriteSegment(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* segment);
+
+
+/**
+ * @brief Internal part of @ref m_cfifo_AttachCascade without locking.
+ *
+ * Links every FIFO of the chain, numbers the segments, computes the totals
+ * and resets the cursors. The pool of the descriptor is left unchanged.
+ *
+ * @param cascade Pointer to the descriptor.
+ * @param head    Pointer to the first FIFO of the cascade.
+ */
+static void m_cfifo_AttachCascadeInternal(m_cfifo_tCascade* cascade, m_cfifo_tCFifo* head);
+
+
+#if M_CFIFO_POOL
+/**
+ * @brief Appends a pool segment to the chain of a pooled cascade.
+ *
+ * @param cascade Pointer to the cascade descriptor (pool must be set).
+ * @param tail    Last FIFO of the chain.
+ * @return Appended empty segment, or NULL if the pool is exhausted.
+ */
+static m_cfifo_tCFifo* m_cfifo_PoolGrowInternal(m_cfifo_tCascade* cascade, m_cfifo_tCFifo* tail);
+
+
+/**
+ * @brief Returns empty pool segments at the front of a pooled cascade.
+ *
+ * Walks the leading empty segments of the chain and hands every pool
+ * segment except the last one of the chain back to the pool, moving the
+ * cursors that pointed at it to its successor.
+ *
+ * @param cfifo Pointer to the head of the cascade.
+ */
+static void m_cfifo_PoolShrinkInternal(m_cfifo_tCFifo* cfifo);
+#endif
+
+
+/**
+ * @brief Updates the cascade descriptor after data was added to a FIFO.
+ *
+ * Adds @p count to the cached usage and moves the read cursor back to
+ * @p cfifo if it lies behind it.
+ *
+ * @param cfifo Pointer to the FIFO instance (must be attached).
+ * @param count Number of bytes added.
+ */
+static void m_cfifo_CascadeOnWrite(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count);
+
+
+/**
+ * @brief Updates the cascade descriptor after data was removed from a FIFO.
+ *
+ * Subtracts @p count from the cached usage and moves the write cursor back
+ * to @p cfifo if it lies behind it.
+ *
+ * @param cfifo Pointer to the FIFO instance (must be attached).
+ * @param count Number of bytes removed.
+ */
+static void m_cfifo_CascadeOnRead(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count);
+
+
+#if M_CFIFO_NOTIFY
+/**
+ * @brief Signals the high watermark if @p count new bytes crossed it.
+ *
+ * Called after the write index and usage were updated.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param count Number of bytes just written.
+ */
+static void m_cfifo_NotifyOnWrite(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count);
+
+
+/**
+ * @brief Signals the low watermark if @p count removed bytes crossed it.
+ *
+ * Called after the read index and usage were updated.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param count Number of bytes just removed.
+ */
+static void m_cfifo_NotifyOnRead(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count);
+#endif
+
+
+#if M_CFIFO_PERSIST
+/**
+ * @brief Writes the current indices into the older copy of the header.
+ *
+ * @param cfifo Pointer to a FIFO with a persistent header.
+ */
+static void m_cfifo_PersistSave(m_cfifo_tCFifo* cfifo);
+
+
+/**
+ * @brief Computes the checksum of a header copy (FNV-1a over all fields
+ *        before `check`).
+ *
+ * @param copy Pointer to the copy.
+ * @return Checksum value.
+ */
+static uint32_t m_cfifo_PersistChecksum(const m_cfifo_tPersistCopy* copy);
+
+
+/**
+ * @brief Checks a header copy against the configured buffer.
+ *
+ * Verifies magic, version, build options, checksum, buffer size and the
+ * consistency of the indices.
+ *
+ * @param cfifo Pointer to the configured FIFO instance.
+ * @param copy  Pointer to the copy.
+ *
+ * @retval true  Copy describes a valid state of this FIFO.
+ * @retval false Copy is stale, torn or from another configuration.
+ */
+static bool m_cfifo_PersistIsValid(m_cfifo_tCFifo* cfifo, const m_cfifo_tPersistCopy* copy);
+#endif
+
+
+#if M_CFIFO_TRACE
+/**
+ * @brief Reads the trace clock.
+ *
+ * @return Current timestamp, or 0 without a clock.
+ */
+static uint32_t m_cfifo_TraceNow(void);
+
+
+/**
+ * @brief Writes one event into the trace ring.
+ *
+ * Called while @p cfifo is still locked, so the ring lock is only taken
+ * when it is not the same (@ref M_CFIFO_SAME_LOCK). Does nothing without a
+ * ring or for calls on the ring itself.
+ *
+ * @param cfifo   Traced FIFO the call started on (gives the instance id).
+ * @param segment FIFO whose index and usage are recorded (@p cfifo itself,
+ *                or the visited segment of a cascaded walk).
+ * @param op      @ref m_cfifo_tTraceOp, plus @ref M_CFIFO_TRACE_CASCADED.
+ * @param start   Timestamp taken at the start of the call.
+ * @param bytes   Number of bytes moved.
+ */
+static void m_cfifo_TraceEmit(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* segment, unsigned op, uint32_t start, m_cfifo_tTotal bytes);
+#endif
+
+
+/**
+ * @brief Retrieves an adjacent FIFO based on traversal direction.
+ *
+ * Returns either the `next` or `prev` FIFO depending on the specified
+ * direction. Used during cascading operations.
+ *
+ * @param cfifo     Pointer to the current FIFO (may be NULL).
+ * @param direction Traversal direction (UP = next, DOWN = prev).
+ *
+ * @return Pointer to the adjacent FIFO, or NULL if unavailable.
+ */
+static m_cfifo_tCFifo* m_cfifo_GetAdjacentFifo(m_cfifo_tCFifo* cfifo, m_cfifo_tDirection direction);
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+void m_cfifo_InitBuffer(m_cfifo_tCFifo* cfifo)
+{
+  cfifo->prev = NULL;
+  cfifo->next = NULL;
+  cfifo->cascade = NULL;
+  cfifo->segment_index = 0;
+  cfifo->dummy_byte = 0x00;
+#if M_CFIFO_OVERWRITE
+  cfifo->overwrite = false;
+  cfifo->dropped_count = 0;
+#endif
+#if M_CFIFO_STATS
+  memset(&cfifo->stats, 0, sizeof(cfifo->stats));
+#endif
+#if M_CFIFO_PERSIST
+  cfifo->persist = NULL;
+#endif
+#if M_CFIFO_TRACE
+  cfifo->trace_id = 0;
+#endif
+#if M_CFIFO_NOTIFY
+  cfifo->signal = NULL;
+  cfifo->wait = NULL;
+  cfifo->notify_ctx = NULL;
+  cfifo->low_watermark = M_CFIFO_INDEX_MAX;
+  cfifo->high_watermark = 1;
+#endif
+#if M_CFIFO_INSTANCE_LOCK
+  cfifo->lock = NULL;
+  cfifo->unlock = NULL;
+  cfifo->lock_ctx = NULL;
+#endif
+  m_cfifo_ConfigBuffer(cfifo, NULL, 0);
+}
+
+void m_cfifo_CascadeAsNextBuffer(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* cfifo_next)
+{
+  M_CFIFO_LOCK(cfifo);
+  cfifo->next        = cfifo_next;
+  cfifo_next->prev   = cfifo;
+  M_CFIFO_UNLOCK(cfifo);
+
+  if (cfifo->cascade != NULL)
+  {
+    m_cfifo_tCFifo* head = cfifo->cascade->head;
+
+    M_CFIFO_LOCK(head);
+    m_cfifo_AttachCascadeInternal(cfifo->cascade, head);
+    M_CFIFO_UNLOCK(head);
+  }
+}
+
+void m_cfifo_AttachCascade(m_cfifo_tCascade* cascade, m_cfifo_tCFifo* head)
+{
+  M_CFIFO_LOCK(head);
+#if M_CFIFO_POOL
+  cascade->pool = NULL;
+#endif
+  m_cfifo_AttachCascadeInternal(cascade, head);
+  M_CFIFO_UNLOCK(head);
+}
+
+void m_cfifo_DetachCascade(m_cfifo_tCascade* cascade)
+{
+  m_cfifo_tCFifo* head = cascade->head;
+  m_cfifo_tCFifo* actual_buffer = head;
+
+  if (head == NULL)
+    return;
+
+  M_CFIFO_LOCK(head);
+  while (actual_buffer != NULL)
+  {
+    if (actual_buffer->cascade == cascade)
+      actual_buffer->cascade = NULL;
+    actual_buffer = actual_buffer->next;
+  }
+  cascade->head = NULL;
+  M_CFIFO_UNLOCK(head);
+}
+
+#if M_CFIFO_POOL
+void m_cfifo_InitPool(m_cfifo_tPool* pool, m_cfifo_tCFifo* segments, void* arena, uint16_t segment_count, m_cfifo_tIndex block_size)
+{
+  uint8_t* block = (uint8_t*)arena;
+  uint16_t i;
+
+  pool->segments      = segments;
+  pool->free_list     = NULL;
+  pool->block_size    = block_size;
+  pool->segment_count = segment_count;
+  pool->free_count    = segment_count;
+
+  // Link in reverse so that the first block is handed out first
+  for (i = segment_count; i > 0; i--)
+  {
+    m_cfifo_tCFifo* segment = &segments[i - 1u];
+
+    m_cfifo_InitBuffer(segment);
+    m_cfifo_ConfigBufferInternal(segment, &block[(size_t)(i - 1u) * block_size], block_size, 1);
+    m_cfifo_This_ClearInternal(segment);
+    segment->next = pool->free_list;
+    pool->free_list = segment;
+  }
+}
+
+void m_cfifo_AttachPool(m_cfifo_tCascade* cascade, m_cfifo_tPool* pool)
+{
+  M_CFIFO_LOCK(cascade->head);
+  cascade->pool = pool;
+  M_CFIFO_UNLOCK(cascade->head);
+}
+
+uint16_t m_cfifo_GetPoolFree(m_cfifo_tPool* pool)
+{
+  return pool->free_count;
+}
+#endif
+
+void m_cfifo_ConfigBuffer(m_cfifo_tCFifo* cfifo, const void* buffer, m_cfifo_tIndex buffer_size)
+{
+  // Without a buffer, M_CFIFO_INDEX_MAX is reserved for the endless source
+  if (buffer == NULL && buffer_size == M_CFIFO_INDEX_MAX)
+    buffer_size = (m_cfifo_tIndex)(M_CFIFO_INDEX_MAX - 1u);
+
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_ConfigBufferInternal(cfifo, buffer, buffer_size, 1);
+  M_CFIFO_UNLOCK(cfifo);
+}
+
+#if M_CFIFO_MIRROR
+void m_cfifo_ConfigMirrorBuffer(m_cfifo_tCFifo* cfifo, const void* buffer, m_cfifo_tIndex buffer_size)
+{
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_ConfigBufferInternal(cfifo, buffer, buffer_size, 1);
+  cfifo->mirrored = (buffer != NULL);
+  M_CFIFO_UNLOCK(cfifo);
+}
+#endif
+
+void m_cfifo_ConfigRecordBuffer(m_cfifo_tCFifo* cfifo, const void* buffer, m_cfifo_tIndex record_count, m_cfifo_tIndex record_size)
+{
+  if (record_size == 0)
+    record_size = 1;
+
+  if (record_count > M_CFIFO_INDEX_MAX / record_size)
+    record_count = (m_cfifo_tIndex)(M_CFIFO_INDEX_MAX / record_size);
+
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_ConfigBufferInternal(cfifo, buffer, (m_cfifo_tIndex)(record_count * record_size), record_size);
+  M_CFIFO_UNLOCK(cfifo);
+}
+
+#if M_CFIFO_PERSIST
+bool m_cfifo_ConfigPersistBuffer(m_cfifo_tCFifo* cfifo, m_cfifo_tPersist* persist, const void* buffer, m_cfifo_tIndex buffer_size)
+{
+  const m_cfifo_tPersistCopy* newest = NULL;
+  bool valid_a;
+  bool valid_b;
+
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_ConfigBufferInternal(cfifo, buffer, buffer_size, 1);
+
+  valid_a = m_cfifo_PersistIsValid(cfifo, &persist->copy[0]);
+  valid_b = m_cfifo_PersistIsValid(cfifo, &persist->copy[1]);
+  if (valid_a && valid_b)
+  {
+    // The copy written last is one sequence step ahead of the other
+    if ((int8_t)(uint8_t)(persist->copy[1].sequence - persist->copy[0].sequence) > 0)
+      newest = &persist->copy[1];
+    else
+      newest = &persist->copy[0];
+  }
+  else if (valid_a)
+  {
+    newest = &persist->copy[0];
+  }
+  else if (valid_b)
+  {
+    newest = &persist->copy[1];
+  }
+
+  if (newest != NULL)
+  {
+    m_cfifo_tPersistCopy* older = (newest == &persist->copy[0]) ? &persist->copy[1] : &persist->copy[0];
+
+    // Make sure the next update overwrites the other copy, even if torn
+    older->magic = 0;
+    older->sequence = (uint8_t)(newest->sequence - 1u);
+
+    // Cascade totals follow the reconfiguration, which left the FIFO full
+    if (cfifo->cascade != NULL)
+      m_cfifo_CascadeOnRead(cfifo, cfifo->buffer_size - newest->used_count);
+
+    cfifo->rdPtr = newest->rdPtr;
+    cfifo->wrPtr = newest->wrPtr;
+#if !M_CFIFO_FREE_RUNNING_INDEX
+    cfifo->used_count = newest->used_count;
+#endif
+  }
+  else
+  {
+    // Start a fresh sequence in which copy 0 is the older one
+    memset(persist, 0, sizeof(*persist));
+    persist->copy[1].sequence = 1;
+    m_cfifo_This_ClearInternal(cfifo);
+  }
+
+  cfifo->persist = persist;
+  m_cfifo_PersistSave(cfifo);
+  M_CFIFO_UNLOCK(cfifo);
+
+  return newest != NULL;
+}
+#endif
+
+void m_cfifo_SetDummyByte(m_cfifo_tCFifo* cfifo, uint8_t data)
+{
+  M_CFIFO_LOCK(cfifo);
+  cfifo->dummy_byte = data;
+  M_CFIFO_UNLOCK(cfifo);
+}  
+
+void m_cfifo_ConfigSource(m_cfifo_tCFifo* cfifo, uint8_t pattern, m_cfifo_tIndex count)
+{
+  // M_CFIFO_INDEX_MAX is reserved for the endless source
+  if (count == 0)
+    count = M_CFIFO_INDEX_MAX;
+  else if (count == M_CFIFO_INDEX_MAX)
+    count = (m_cfifo_tIndex)(M_CFIFO_INDEX_MAX - 1u);
+
+  M_CFIFO_LOCK(cfifo);
+  cfifo->dummy_byte = pattern;
+  m_cfifo_ConfigBufferInternal(cfifo, NULL, count, 1);
+  M_CFIFO_UNLOCK(cfifo);
+}
+
+#if M_CFIFO_INSTANCE_LOCK
+void m_cfifo_SetLockHooks(m_cfifo_tCFifo* cfifo, m_cfifo_tLockHook lock, m_cfifo_tLockHook unlock, void* ctx)
+{
+  cfifo->lock     = lock;
+  cfifo->unlock   = unlock;
+  cfifo->lock_ctx = ctx;
+}
+#endif
+
+#if M_CFIFO_TRACE
+void m_cfifo_TraceAttach(m_cfifo_tCFifo* ring, m_cfifo_tTraceClock clock)
+{
+  m_cfifo_trace_ring    = ring;
+  m_cfifo_trace_clock   = clock;
+  m_cfifo_trace_dropped = 0;
+}
+
+m_cfifo_tTotal m_cfifo_TraceGetDropped(void)
+{
+  return m_cfifo_trace_dropped;
+}
+
+void m_cfifo_SetTraceId(m_cfifo_tCFifo* cfifo, uint16_t id)
+{
+  M_CFIFO_LOCK(cfifo);
+  cfifo->trace_id = id;
+  M_CFIFO_UNLOCK(cfifo);
+}
+#endif
+
+#if M_CFIFO_OVERWRITE
+void m_cfifo_SetOverwrite(m_cfifo_tCFifo* cfifo, bool enable)
+{
+  M_CFIFO_LOCK(cfifo);
+  cfifo->overwrite = enable;
+  cfifo->dropped_count = 0;
+  M_CFIFO_UNLOCK(cfifo);
+}
+
+m_cfifo_tTotal m_cfifo_This_GetDropped(m_cfifo_tCFifo* cfifo)
+{
+  m_cfifo_tTotal res;
+
+  M_CFIFO_LOCK(cfifo);
+  res = cfifo->dropped_count;
+  M_CFIFO_UNLOCK(cfifo);
+
+  return res;
+}
+#endif
+
+#if M_CFIFO_STATS
+void m_cfifo_GetStats(m_cfifo_tCFifo* cfifo, m_cfifo_tStats* stats)
+{
+  M_CFIFO_LOCK(cfifo);
+  *stats = cfifo->stats;
+  M_CFIFO_UNLOCK(cfifo);
+}
+
+void m_cfifo_ResetStats(m_cfifo_tCFifo* cfifo)
+{
+  M_CFIFO_LOCK(cfifo);
+  memset(&cfifo->stats, 0, sizeof(cfifo->stats));
+  cfifo->stats.peak_usage = m_cfifo_This_GetUsageInternal(cfifo);
+  M_CFIFO_UNLOCK(cfifo);
+}
+
+uint16_t m_cfifo_All_GetStats(m_cfifo_tCFifo* cfifo, m_cfifo_tStats* stats, uint16_t count)
+{
+  uint16_t copied;
+
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = cfifo;
+  copied = 0;
+
+  while (copied < count && actual_buffer != NULL)
+  {
+    stats[copied++] = actual_buffer->stats;
+    actual_buffer = actual_buffer->next;
+  }
+  M_CFIFO_UNLOCK(cfifo);
+
+  return copied;
+}
+
+void m_cfifo_All_ResetStats(m_cfifo_tCFifo* cfifo)
+{
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = cfifo;
+
+  while (actual_buffer != NULL)
+  {
+    memset(&actual_buffer->stats, 0, sizeof(actual_buffer->stats));
+    actual_buffer->stats.peak_usage = m_cfifo_This_GetUsageInternal(actual_buffer);
+    actual_buffer = actual_buffer->next;
+  }
+  M_CFIFO_UNLOCK(cfifo);
+}
+#endif
+
+#if M_CFIFO_NOTIFY
+void m_cfifo_SetNotifyHooks(m_cfifo_tCFifo* cfifo, m_cfifo_tSignalHook signal, m_cfifo_tWaitHook wait, void* ctx)
+{
+  M_CFIFO_LOCK(cfifo);
+  cfifo->signal     = signal;
+  cfifo->wait       = wait;
+  cfifo->notify_ctx = ctx;
+  M_CFIFO_UNLOCK(cfifo);
+}
+
+void m_cfifo_SetWatermarks(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex low, m_cfifo_tIndex high)
+{
+  M_CFIFO_LOCK(cfifo);
+  cfifo->low_watermark  = low;
+  cfifo->high_watermark = (high == 0) ? 1 : high;
+  M_CFIFO_UNLOCK(cfifo);
+}
+
+m_cfifo_tIndex m_cfifo_PopWait(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len, uint32_t timeout)
+{
+  m_cfifo_tWaitHook wait;
+  void* ctx;
+  m_cfifo_tIndex popped;
+  bool signaled;
+
+  // The hooks are written by m_cfifo_SetNotifyHooks under the lock
+  M_CFIFO_LOCK(cfifo);
+  wait = cfifo->wait;
+  ctx  = cfifo->notify_ctx;
+  M_CFIFO_UNLOCK(cfifo);
+
+  popped = m_cfifo_This_PopN(cfifo, data, len);
+  signaled = true;
+
+  while (popped == 0 && len != 0 && signaled && timeout != 0 && wait != NULL)
+  {
+    // Retry after a timeout too: data below the high watermark is not signaled
+    signaled = wait(ctx, M_CFIFO_HIGH_WATERMARK, timeout);
+    popped = m_cfifo_This_PopN(cfifo, data, len);
+  }
+
+  return popped;
+}
+
+m_cfifo_tIndex m_cfifo_PushWait(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len, uint32_t timeout)
+{
+  const uint8_t* src = (const uint8_t*)data;
+  m_cfifo_tWaitHook wait;
+  void* ctx;
+  m_cfifo_tIndex pushed;
+  bool signaled;
+
+  M_CFIFO_LOCK(cfifo);
+  wait = cfifo->wait;
+  ctx  = cfifo->notify_ctx;
+  M_CFIFO_UNLOCK(cfifo);
+
+  pushed = m_cfifo_This_PushN(cfifo, src, len);
+  signaled = true;
+
+  while (pushed < len && signaled && timeout != 0 && wait != NULL)
+  {
+    signaled = wait(ctx, M_CFIFO_LOW_WATERMARK, timeout);
+    pushed += m_cfifo_This_PushN(cfifo, &src[pushed], len - pushed);
+  }
+
+  return pushed;
+}
+#endif
+
+bool m_cfifo_This_Push(m_cfifo_tCFifo* cfifo, uint8_t data)
+{
+    bool res;
+
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+#if M_CFIFO_OVERWRITE
+    if (cfifo->overwrite && cfifo->buffer != NULL)
+        m_cfifo_This_DropOldestInternal(cfifo, 1, 1);
+#endif
+    res = m_cfifo_This_PushInternal(cfifo, data);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH, t, res ? 1 : 0);
+    M_CFIFO_UNLOCK(cfifo);
+
+    return res;
+}
+
+bool m_cfifo_All_Push(m_cfifo_tCFifo* cfifo, uint8_t data)
+{
+  bool success;
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetWriteCursor(cfifo);
+  success = false;
+  
+  while (!success && actual_buffer != NULL)
+  {
+    success = m_cfifo_This_PushInternal(actual_buffer, data);
+    M_CFIFO_TRACE_SEGMENT(cfifo, actual_buffer, M_CFIFO_TRACE_SEGMENT_WRITE, success ? 1 : 0);
+    if (!success)
+      actual_buffer = m_cfifo_GetNextWriteSegment(cfifo, actual_buffer);
+  }
+  m_cfifo_SetWriteCursor(cfifo, actual_buffer);
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH | M_CFIFO_TRACE_CASCADED, t, success ? 1 : 0);
+  M_CFIFO_UNLOCK(cfifo);
+  return success;
+}
+
+m_cfifo_tIndex m_cfifo_This_PushN(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len)
+{
+    m_cfifo_tIndex res;
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PushNPolicyInternal(cfifo, (const uint8_t*)data, len, NULL);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH_N, t, res);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_All_PushN(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len)
+{
+  m_cfifo_tIndex pushed;
+
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  pushed = m_cfifo_All_PushNInternal(cfifo, (const uint8_t*)data, len, NULL);
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH_N | M_CFIFO_TRACE_CASCADED, t, pushed);
+  M_CFIFO_UNLOCK(cfifo);
+
+  return pushed;
+}
+
+bool m_cfifo_This_PushRecord(m_cfifo_tCFifo* cfifo, const void* record)
+{
+    bool res;
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+#if M_CFIFO_OVERWRITE
+    if (cfifo->overwrite && cfifo->buffer != NULL && cfifo->record_size <= cfifo->buffer_size)
+        m_cfifo_This_DropOldestInternal(cfifo, cfifo->record_size, cfifo->record_size);
+#endif
+    res = m_cfifo_This_PushRecordInternal(cfifo, (const uint8_t*)record);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH_RECORD, t, res ? cfifo->record_size : 0);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+bool m_cfifo_All_PushRecord(m_cfifo_tCFifo* cfifo, const void* record)
+{
+  bool success;
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetWriteCursor(cfifo);
+  success = false;
+
+  while (!success && actual_buffer != NULL)
+  {
+    success = m_cfifo_This_PushRecordInternal(actual_buffer, (const uint8_t*)record);
+    M_CFIFO_TRACE_SEGMENT(cfifo, actual_buffer, M_CFIFO_TRACE_SEGMENT_WRITE, success ? actual_buffer->record_size : 0);
+    if (!success)
+      actual_buffer = m_cfifo_GetNextWriteSegment(cfifo, actual_buffer);
+  }
+  m_cfifo_SetWriteCursor(cfifo, actual_buffer);
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH_RECORD | M_CFIFO_TRACE_CASCADED, t, success ? cfifo->record_size : 0);
+  M_CFIFO_UNLOCK(cfifo);
+  return success;
+}
+
+bool m_cfifo_This_Pop(m_cfifo_tCFifo* cfifo, uint8_t* data)
+{
+    bool res;
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PopInternal(cfifo, data);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP, t, res ? 1 : 0);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_This_PopN(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len)
+{
+    m_cfifo_tIndex res;
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PopNInternal(cfifo, (uint8_t*)data, len, NULL);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP_N, t, res);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+bool m_cfifo_All_Pop(m_cfifo_tCFifo* cfifo, uint8_t* data)
+{
+  bool success;
+  
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetReadCursor(cfifo);
+  success = false;
+  
+  while (!success && actual_buffer != NULL)
+  {
+    success = m_cfifo_This_PopInternal(actual_buffer, data);
+    M_CFIFO_TRACE_SEGMENT(cfifo, actual_buffer, M_CFIFO_TRACE_SEGMENT_READ, success ? 1 : 0);
+    if (!success)
+      actual_buffer = actual_buffer->next;
+  }
+  m_cfifo_SetReadCursor(cfifo, actual_buffer);
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP | M_CFIFO_TRACE_CASCADED, t, success ? 1 : 0);
+  M_CFIFO_UNLOCK(cfifo);
+  
+  return success;
+}
+
+m_cfifo_tIndex m_cfifo_All_PopN(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len)
+{
+  m_cfifo_tIndex popped;
+
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  popped = m_cfifo_All_PopNInternal(cfifo, (uint8_t*)data, len, NULL);
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP_N | M_CFIFO_TRACE_CASCADED, t, popped);
+  M_CFIFO_UNLOCK(cfifo);
+
+  return popped;
+}
+
+#if M_CFIFO_CRC
+m_cfifo_tIndex m_cfifo_This_PushNCrc(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len, m_cfifo_tCrc* crc)
+{
+    m_cfifo_tIndex res;
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PushNPolicyInternal(cfifo, (const uint8_t*)data, len, crc);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH_N, t, res);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_All_PushNCrc(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len, m_cfifo_tCrc* crc)
+{
+  m_cfifo_tIndex pushed;
+
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  pushed = m_cfifo_All_PushNInternal(cfifo, (const uint8_t*)data, len, crc);
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH_N | M_CFIFO_TRACE_CASCADED, t, pushed);
+  M_CFIFO_UNLOCK(cfifo);
+
+  return pushed;
+}
+
+m_cfifo_tIndex m_cfifo_This_PopNCrc(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len, m_cfifo_tCrc* crc)
+{
+    m_cfifo_tIndex res;
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PopNInternal(cfifo, (uint8_t*)data, len, crc);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP_N, t, res);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_All_PopNCrc(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len, m_cfifo_tCrc* crc)
+{
+  m_cfifo_tIndex popped;
+
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  popped = m_cfifo_All_PopNInternal(cfifo, (uint8_t*)data, len, crc);
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP_N | M_CFIFO_TRACE_CASCADED, t, popped);
+  M_CFIFO_UNLOCK(cfifo);
+
+  return popped;
+}
+#endif
+
+m_cfifo_tIndex m_cfifo_This_Peek(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex offset, void* data, m_cfifo_tIndex len)
+{
+    m_cfifo_tIndex res;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PeekInternal(cfifo, offset, (uint8_t*)data, len);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_All_Peek(m_cfifo_tCFifo* cfifo, m_cfifo_tTotal offset, void* data, m_cfifo_tIndex len)
+{
+  m_cfifo_tIndex copied;
+  m_cfifo_tIndex used;
+
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetReadCursor(cfifo);
+  uint8_t* dst = (uint8_t*)data;
+  copied = 0;
+
+  while (copied < len && actual_buffer != NULL)
+  {
+    used = m_cfifo_This_GetUsageInternal(actual_buffer);
+
+    if (offset >= used)
+    {
+      offset -= used;
+    }
+    else
+    {
+      copied += m_cfifo_This_PeekInternal(actual_buffer, (m_cfifo_tIndex)offset, &dst[copied], len - copied);
+      offset = 0;
+    }
+    actual_buffer = actual_buffer->next;
+  }
+  M_CFIFO_UNLOCK(cfifo);
+
+  return copied;
+}
+
+m_cfifo_tIndex m_cfifo_This_Skip(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len)
+{
+    m_cfifo_tIndex res;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PopNInternal(cfifo, NULL, len, NULL);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_All_Skip(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len)
+{
+  return m_cfifo_All_PopN(cfifo, NULL, len);
+}
+
+m_cfifo_tIndex m_cfifo_This_Find(m_cfifo_tCFifo* cfifo, uint8_t byte, m_cfifo_tIndex max)
+{
+    m_cfifo_tIndex res;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_FindInternal(cfifo, byte, max);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_All_Find(m_cfifo_tCFifo* cfifo, uint8_t byte, m_cfifo_tIndex max)
+{
+  m_cfifo_tIndex scanned;
+  m_cfifo_tIndex used;
+  m_cfifo_tIndex found;
+
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetReadCursor(cfifo);
+  found = M_CFIFO_NOT_FOUND;
+  scanned = 0;
+
+  while (scanned < max && actual_buffer != NULL)
+  {
+    found = m_cfifo_This_FindInternal(actual_buffer, byte, max - scanned);
+    if (found != M_CFIFO_NOT_FOUND)
+    {
+      found += scanned;
+      break;
+    }
+
+    used = m_cfifo_This_GetUsageInternal(actual_buffer);
+    if (used > max - scanned)
+      used = (m_cfifo_tIndex)(max - scanned);
+    scanned += used;
+    actual_buffer = actual_buffer->next;
+  }
+  M_CFIFO_UNLOCK(cfifo);
+
+  return found;
+}
+
+m_cfifo_tIndex m_cfifo_Transfer(m_cfifo_tCFifo* dst, m_cfifo_tCFifo* src, m_cfifo_tIndex max_bytes)
+{
+  m_cfifo_tIndex moved;
+
+  M_CFIFO_TRACE_BEGIN(t);
+  m_cfifo_LockPair(dst, src);
+
+  // The walk would read from a segment it writes to
+  for (m_cfifo_tCFifo* segment = dst; segment != NULL; segment = segment->next)
+  {
+    if (segment == src)
+    {
+      m_cfifo_UnlockPair(dst, src);
+      return 0;
+    }
+  }
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetWriteCursor(dst);
+  moved = 0;
+
+  while (moved < max_bytes && actual_buffer != NULL)
+  {
+    m_cfifo_tIndex step = m_cfifo_This_TransferInternal(actual_buffer, src, max_bytes - moved);
+    moved += step;
+    M_CFIFO_TRACE_SEGMENT(dst, actual_buffer, M_CFIFO_TRACE_SEGMENT_WRITE, step);
+    if (moved == max_bytes || m_cfifo_This_IsEmptyInternal(src))
+      break;
+    actual_buffer = m_cfifo_GetNextWriteSegment(dst, actual_buffer);
+  }
+  m_cfifo_SetWriteCursor(dst, actual_buffer);
+  M_CFIFO_TRACE_END(dst, M_CFIFO_TRACE_TRANSFER | M_CFIFO_TRACE_CASCADED, t, moved);
+  m_cfifo_UnlockPair(dst, src);
+
+  return moved;
+}
+
+bool m_cfifo_This_PushMsg(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len)
+{
+    bool res;
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+#if M_CFIFO_OVERWRITE
+    if (cfifo->overwrite && cfifo->buffer != NULL && !m_cfifo_This_DropMsgInternal(cfifo, len))
+    {
+        M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH_MSG, t, 0);
+        M_CFIFO_UNLOCK(cfifo);
+        return false;
+    }
+#endif
+    res = m_cfifo_This_PushMsgInternal(cfifo, (const uint8_t*)data, len);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH_MSG, t, res ? len : 0);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+bool m_cfifo_All_PushMsg(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len)
+{
+  bool success;
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetWriteCursor(cfifo);
+  m_cfifo_tCFifo* first_free = NULL;
+  success = false;
+
+  // A large message may skip segments that still have room, so the write
+  // cursor may only advance over segments that are actually full
+  while (!success && actual_buffer != NULL)
+  {
+    if (first_free == NULL && !m_cfifo_This_IsFullInternal(actual_buffer))
+      first_free = actual_buffer;
+    success = m_cfifo_This_PushMsgInternal(actual_buffer, (const uint8_t*)data, len);
+    M_CFIFO_TRACE_SEGMENT(cfifo, actual_buffer, M_CFIFO_TRACE_SEGMENT_WRITE, success ? len : 0);
+    if (!success)
+      actual_buffer = m_cfifo_GetNextWriteSegment(cfifo, actual_buffer);
+  }
+  m_cfifo_SetWriteCursor(cfifo, first_free);
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_PUSH_MSG | M_CFIFO_TRACE_CASCADED, t, success ? len : 0);
+  M_CFIFO_UNLOCK(cfifo);
+  return success;
+}
+
+bool m_cfifo_This_PeekMsgLen(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len)
+{
+    bool res;
+    m_cfifo_tIndex header_len;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PeekMsgInternal(cfifo, len, &header_len);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+bool m_cfifo_All_PeekMsgLen(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len)
+{
+  bool success;
+  m_cfifo_tIndex header_len;
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetReadCursor(cfifo);
+  success = false;
+
+  while (!success && actual_buffer != NULL)
+  {
+    success = m_cfifo_This_PeekMsgInternal(actual_buffer, len, &header_len);
+    actual_buffer = actual_buffer->next;
+  }
+  M_CFIFO_UNLOCK(cfifo);
+  return success;
+}
+
+bool m_cfifo_This_PopMsg(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex max_len, m_cfifo_tIndex* len)
+{
+    bool res;
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PopMsgInternal(cfifo, (uint8_t*)data, max_len, len);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP_MSG, t, (res && len != NULL) ? *len : 0);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+bool m_cfifo_All_PopMsg(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex max_len, m_cfifo_tIndex* len)
+{
+  bool success;
+  m_cfifo_tIndex msg_len;
+  m_cfifo_tIndex header_len;
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetReadCursor(cfifo);
+  success = false;
+
+  while (actual_buffer != NULL && !m_cfifo_This_PeekMsgInternal(actual_buffer, &msg_len, &header_len))
+  {
+    M_CFIFO_TRACE_SEGMENT(cfifo, actual_buffer, M_CFIFO_TRACE_SEGMENT_READ, 0);
+    actual_buffer = actual_buffer->next;
+  }
+
+  if (actual_buffer != NULL)
+  {
+    success = m_cfifo_This_PopMsgInternal(actual_buffer, (uint8_t*)data, max_len, len);
+    M_CFIFO_TRACE_SEGMENT(cfifo, actual_buffer, M_CFIFO_TRACE_SEGMENT_READ, success ? msg_len : 0);
+  }
+  else if (len != NULL)
+    *len = 0;
+#if M_CFIFO_POOL
+  if (m_cfifo_IsCascadeHead(cfifo) && cfifo->cascade->pool != NULL)
+    m_cfifo_PoolShrinkInternal(cfifo);
+#endif
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP_MSG | M_CFIFO_TRACE_CASCADED, t, success ? msg_len : 0);
+  M_CFIFO_UNLOCK(cfifo);
+  return success;
+}
+
+uint8_t* m_cfifo_This_AcquireWrite(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len)
+{
+    uint8_t* res;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_GetWriteSpanInternal(cfifo, len);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_This_CommitWrite(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len)
+{
+    m_cfifo_tIndex span;
+
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+    m_cfifo_This_GetWriteSpanInternal(cfifo, &span);
+    if (len > span)
+        len = span;
+    m_cfifo_AddWrPtr(cfifo, len);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_COMMIT_WRITE, t, len);
+    M_CFIFO_UNLOCK(cfifo);
+
+    return len;
+}
+
+const uint8_t* m_cfifo_This_AcquireRead(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len)
+{
+    const uint8_t* res;
+    M_CFIFO_LOCK(cfifo);
+    if (cfifo->buffer == NULL)
+    {
+        // Pattern source: a fixed-address region that reads as dummy_byte
+        *len = m_cfifo_This_GetUsageInternal(cfifo);
+        res = (*len != 0) ? &cfifo->dummy_byte : NULL;
+    }
+    else
+    {
+        res = m_cfifo_This_GetReadSpanInternal(cfifo, len);
+    }
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_This_ReleaseRead(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len)
+{
+    m_cfifo_tIndex span;
+
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+    if (cfifo->buffer == NULL)
+        span = m_cfifo_This_GetUsageInternal(cfifo);
+    else
+        m_cfifo_This_GetReadSpanInternal(cfifo, &span);
+    if (len > span)
+        len = span;
+    if (!m_cfifo_This_IsEndlessInternal(cfifo))
+        m_cfifo_AddRdPtr(cfifo, len);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_RELEASE_READ, t, len);
+    M_CFIFO_UNLOCK(cfifo);
+
+    return len;
+}
+
+bool m_cfifo_This_PopRecord(m_cfifo_tCFifo* cfifo, void* record)
+{
+    bool res;
+    M_CFIFO_TRACE_BEGIN(t);
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_PopRecordInternal(cfifo, (uint8_t*)record);
+    M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP_RECORD, t, res ? cfifo->record_size : 0);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+bool m_cfifo_All_PopRecord(m_cfifo_tCFifo* cfifo, void* record)
+{
+  bool success;
+  M_CFIFO_TRACE_BEGIN(t);
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetReadCursor(cfifo);
+  success = false;
+
+  while (!success && actual_buffer != NULL)
+  {
+    success = m_cfifo_This_PopRecordInternal(actual_buffer, (uint8_t*)record);
+    M_CFIFO_TRACE_SEGMENT(cfifo, actual_buffer, M_CFIFO_TRACE_SEGMENT_READ, success ? actual_buffer->record_size : 0);
+    if (!success)
+      actual_buffer = actual_buffer->next;
+  }
+  m_cfifo_SetReadCursor(cfifo, actual_buffer);
+  M_CFIFO_TRACE_END(cfifo, M_CFIFO_TRACE_POP_RECORD | M_CFIFO_TRACE_CASCADED, t, success ? cfifo->record_size : 0);
+  M_CFIFO_UNLOCK(cfifo);
+  return success;
+}
+
+void m_cfifo_This_Clear(m_cfifo_tCFifo* cfifo)
+{
+    M_CFIFO_LOCK(cfifo);
+     m_cfifo_This_ClearInternal(cfifo);
+    M_CFIFO_UNLOCK(cfifo);
 }
 
 void m_cfifo_All_Clear(m_cfifo_tCFifo* cfifo, m_cfifo_tDirection direction)
 {
     m_cfifo_tCFifo* actual_buffer = cfifo;
     
-    //Semaphore take
+    M_CFIFO_LOCK(cfifo);
     while (actual_buffer != NULL)
     {
       m_cfifo_This_ClearInternal(actual_buffer);
       actual_buffer = m_cfifo_GetAdjacentFifo(actual_buffer, direction);
     }
-    //Semaphore give
+    M_CFIFO_UNLOCK(cfifo);
 }
 
 void m_cfifo_This_SetFull(m_cfifo_tCFifo* cfifo)
 {
-    //Semaphore take
+    M_CFIFO_LOCK(cfifo);
     m_cfifo_This_SetFullInternal(cfifo);
-    //Semaphore give
+    M_CFIFO_UNLOCK(cfifo);
 }
 
 void m_cfifo_All_SetFull(m_cfifo_tCFifo* cfifo, m_cfifo_tDirection direction)
 {
     m_cfifo_tCFifo* actual_buffer = cfifo;
 
-    //Semaphore take
+    M_CFIFO_LOCK(cfifo);
     while (actual_buffer != NULL)
     {
       m_cfifo_This_SetFullInternal(actual_buffer);
       actual_buffer = m_cfifo_GetAdjacentFifo(actual_buffer, direction);
     }
-    //Semaphore give
+    M_CFIFO_UNLOCK(cfifo);
 }
 
-uint16_t m_cfifo_This_GetSize(m_cfifo_tCFifo* cfifo)
+m_cfifo_tIndex m_cfifo_This_GetSize(m_cfifo_tCFifo* cfifo)
 {
-    uint16_t res;
-    //Semaphore take
+    m_cfifo_tIndex res;
+    M_CFIFO_LOCK(cfifo);
     res = m_cfifo_This_GetSizeInternal(cfifo);
-    //Semaphore give
+    M_CFIFO_UNLOCK(cfifo);
     return res;
 }
 
-uint32_t m_cfifo_All_GetSize(m_cfifo_tCFifo* cfifo)
+m_cfifo_tIndex m_cfifo_This_GetRecordCapacity(m_cfifo_tCFifo* cfifo)
 {
-  uint32_t size_total;
+    m_cfifo_tIndex res;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_GetSizeInternal(cfifo) / cfifo->record_size;
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tTotal m_cfifo_All_GetSize(m_cfifo_tCFifo* cfifo)
+{
+  m_cfifo_tTotal size_total;
   
-  //Semaphore take
+  M_CFIFO_LOCK(cfifo);
   size_total = 0;
   m_cfifo_tCFifo* actual_buffer = cfifo;
+
+  if (m_cfifo_IsCascadeHead(cfifo))
+  {
+    size_total = cfifo->cascade->size_total;
+    actual_buffer = NULL;
+  }
  
   while (actual_buffer != NULL)
   {
     size_total += m_cfifo_This_GetSizeInternal(actual_buffer);
     actual_buffer = actual_buffer->next;
   }
-  //Semaphore give
+  M_CFIFO_UNLOCK(cfifo);
+
+  return size_total;
+}
+
+m_cfifo_tIndex m_cfifo_This_GetUsage(m_cfifo_tCFifo* cfifo)
+{
+    m_cfifo_tIndex res;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_GetUsageInternal(cfifo);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tIndex m_cfifo_This_GetRecordUsage(m_cfifo_tCFifo* cfifo)
+{
+    m_cfifo_tIndex res;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_GetUsageInternal(cfifo) / cfifo->record_size;
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+m_cfifo_tTotal m_cfifo_All_GetUsage(m_cfifo_tCFifo* cfifo)
+{
+  m_cfifo_tTotal total_used;
+  
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = cfifo;
+  total_used = 0;
+
+  if (m_cfifo_IsCascadeHead(cfifo))
+  {
+    total_used = cfifo->cascade->used_total;
+    actual_buffer = NULL;
+  }
+  
+  while(actual_buffer != NULL)
+  {
+    total_used += m_cfifo_This_GetUsageInternal(actual_buffer);
+    actual_buffer = actual_buffer->next;
+  }
+  M_CFIFO_UNLOCK(cfifo);
+  
+  return total_used;
+}
+
+bool m_cfifo_This_IsEmpty(m_cfifo_tCFifo* cfifo)
+{
+    bool res;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_IsEmptyInternal(cfifo);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+bool m_cfifo_All_IsEmpty(m_cfifo_tCFifo* cfifo)
+{
+  bool is_empty;
+
+  M_CFIFO_LOCK(cfifo);
+  m_cfifo_tCFifo* actual_buffer = cfifo;
+  is_empty = true;
+
+  if (m_cfifo_IsCascadeHead(cfifo))
+  {
+    is_empty = cfifo->cascade->used_total == 0;
+    actual_buffer = NULL;
+  }
+  
+  while (is_empty && actual_buffer != NULL)
+  {
+    is_empty = m_cfifo_This_IsEmptyInternal(actual_buffer);
+    actual_buffer = actual_buffer->next;
+  }
+  M_CFIFO_UNLOCK(cfifo);
+
+  return is_empty;
+}
+
+bool m_cfifo_This_IsFull(m_cfifo_tCFifo* cfifo)
+{
+    bool res;
+    M_CFIFO_LOCK(cfifo);
+    res = m_cfifo_This_IsFullInternal(cfifo);
+    M_CFIFO_UNLOCK(cfifo);
+    return res;
+}
+
+bool m_cfifo_All_IsFull(m_cfifo_tCFifo* cfifo)
+{
+  bool is_full;
+
+  m_cfifo_tCFifo* actual_buffer = cfifo;
+
+  M_CFIFO_LOCK(cfifo);
+  is_full = true;
+
+  if (m_cfifo_IsCascadeHead(cfifo))
+  {
+    is_full = cfifo->cascade->used_total >= cfifo->cascade->size_total;
+    actual_buffer = NULL;
+  }
+  
+  while (is_full && actual_buffer != NULL)
+  {
+    is_full = m_cfifo_This_IsFullInternal(actual_buffer);
+    actual_buffer = actual_buffer->next;
+  }
+  M_CFIFO_UNLOCK(cfifo);
+
+  return is_full;
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static bool m_cfifo_This_PushInternal(m_cfifo_tCFifo* cfifo, uint8_t data)
+{
+    if (cfifo->buffer == NULL)
+        return false;
+
+    if (m_cfifo_This_IsFullInternal(cfifo))
+    {
+        M_CFIFO_STATS_ADD(cfifo, push_fail, 1);
+        return false;
+    }
+
+    cfifo->buffer[m_cfifo_GetWrPos(cfifo)] = data;
+    m_cfifo_IncWrPtr(cfifo);
+
+    return true;
+}
+
+static bool m_cfifo_This_PopInternal(m_cfifo_tCFifo* cfifo, uint8_t* data)
+{
+    if (m_cfifo_This_IsEmptyInternal(cfifo))
+    {
+        M_CFIFO_STATS_ADD(cfifo, pop_fail, 1);
+        return false;
+    }
+
+    if (cfifo->buffer == NULL)
+    {
+        if (data != NULL)
+            *data = cfifo->dummy_byte;
+        if (m_cfifo_This_IsEndlessInternal(cfifo))
+            return true;
+    }
+    else
+    {
+        if (data != NULL)
+            *data = cfifo->buffer[m_cfifo_GetRdPos(cfifo)];
+    }
+
+    m_cfifo_IncRdPtr(cfifo);
+
+    return true;
+}
+
+static m_cfifo_tIndex m_cfifo_This_PushNInternal(m_cfifo_tCFifo* cfifo, const uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc)
+{
+    m_cfifo_tIndex space;
+    m_cfifo_tIndex pos;
+    m_cfifo_tIndex first;
+
+    if (cfifo->buffer == NULL)
+        return 0;
+
+    space = cfifo->buffer_size - m_cfifo_This_GetUsageInternal(cfifo);
+    if (len > space)
+    {
+        M_CFIFO_STATS_ADD(cfifo, push_fail, 1);
+        len = space;
+    }
+
+    if (len == 0)
+        return 0;
+
+    pos = m_cfifo_GetWrPos(cfifo);
+    first = m_cfifo_GetRoomToEnd(cfifo, pos);
+    if (first > len)
+        first = len;
+
+    m_cfifo_CopyCrc(&cfifo->buffer[pos], data, first, crc);
+    if (len > first)
+        m_cfifo_CopyCrc(cfifo->buffer, &data[first], len - first, crc);
+
+    m_cfifo_AddWrPtr(cfifo, len);
+
+    return len;
+}
+
+static m_cfifo_tIndex m_cfifo_This_PushNPolicyInternal(m_cfifo_tCFifo* cfifo, const uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc)
+{
+    m_cfifo_tIndex res = 0;
+
+#if M_CFIFO_OVERWRITE
+    if (cfifo->overwrite && cfifo->buffer != NULL && cfifo->buffer_size != 0)
+    {
+        // Only the newest buffer_size bytes of an oversized block survive
+        if (len > cfifo->buffer_size)
+        {
+            res = len - cfifo->buffer_size;
+            cfifo->dropped_count += res;
+            m_cfifo_CopyCrc(NULL, data, res, crc);
+        }
+        m_cfifo_This_DropOldestInternal(cfifo, len - res, 1);
+    }
+#endif
+    res += m_cfifo_This_PushNInternal(cfifo, &data[res], len - res, crc);
+
+    return res;
+}
+
+static m_cfifo_tIndex m_cfifo_All_PushNInternal(m_cfifo_tCFifo* cfifo, const uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc)
+{
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetWriteCursor(cfifo);
+  m_cfifo_tIndex pushed = 0;
+
+  while (pushed < len && actual_buffer != NULL)
+  {
+    m_cfifo_tIndex step = m_cfifo_This_PushNInternal(actual_buffer, &data[pushed], len - pushed, crc);
+    pushed += step;
+    M_CFIFO_TRACE_SEGMENT(cfifo, actual_buffer, M_CFIFO_TRACE_SEGMENT_WRITE, step);
+    if (pushed < len)
+      actual_buffer = m_cfifo_GetNextWriteSegment(cfifo, actual_buffer);
+  }
+  m_cfifo_SetWriteCursor(cfifo, actual_buffer);
+
+  return pushed;
+}
+
+static m_cfifo_tIndex m_cfifo_This_PopNInternal(m_cfifo_tCFifo* cfifo, uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc)
+{
+    m_cfifo_tIndex used;
+    m_cfifo_tIndex pos;
+    m_cfifo_tIndex first;
+
+    used = m_cfifo_This_GetUsageInternal(cfifo);
+    if (len > used)
+    {
+        if (used == 0)
+            M_CFIFO_STATS_ADD(cfifo, pop_fail, 1);
+        len = used;
+    }
+
+    if (len == 0)
+        return 0;
+
+    if (cfifo->buffer == NULL)
+    {
+        if (data != NULL)
+            memset(data, cfifo->dummy_byte, len);
+#if M_CFIFO_CRC
+        // The pattern bytes exist nowhere in memory: checksum them in blocks
+        for (pos = 0; crc != NULL && pos < len; pos += first)
+        {
+            uint8_t fill[32];
+
+            first = ((size_t)(len - pos) < sizeof(fill)) ? (m_cfifo_tIndex)(len - pos) : (m_cfifo_tIndex)sizeof(fill);
+            memset(fill, cfifo->dummy_byte, first);
+            m_cfifo_Crc_Update(crc, fill, first);
+        }
+#endif
+        if (m_cfifo_This_IsEndlessInternal(cfifo))
+            return len;
+    }
+    else if (data != NULL || crc != NULL)
+    {
+        pos = m_cfifo_GetRdPos(cfifo);
+        first = m_cfifo_GetRoomToEnd(cfifo, pos);
+        if (first > len)
+            first = len;
+
+        m_cfifo_CopyCrc(data, &cfifo->buffer[pos], first, crc);
+        if (len > first)
+            m_cfifo_CopyCrc((data != NULL) ? &data[first] : NULL, cfifo->buffer, len - first, crc);
+    }
+
+    m_cfifo_AddRdPtr(cfifo, len);
+
+    return len;
+}
+
+static m_cfifo_tIndex m_cfifo_All_PopNInternal(m_cfifo_tCFifo* cfifo, uint8_t* data, m_cfifo_tIndex len, struct _cfifo_crc* crc)
+{
+  m_cfifo_tCFifo* actual_buffer = m_cfifo_GetReadCursor(cfifo);
+  m_cfifo_tIndex popped = 0;
+
+  while (popped < len && actual_buffer != NULL)
+  {
+    m_cfifo_tIndex step = m_cfifo_This_PopNInternal(actual_buffer, (data != NULL) ? &data[popped] : NULL, len - popped, crc);
+    popped += step;
+    M_CFIFO_TRACE_SEGMENT(cfifo, actual_buffer, M_CFIFO_TRACE_SEGMENT_READ, step);
+    if (popped < len)
+      actual_buffer = actual_buffer->next;
+  }
+  m_cfifo_SetReadCursor(cfifo, actual_buffer);
+
+  return popped;
+}
+
+static void m_cfifo_CopyCrc(uint8_t* dst, const uint8_t* src, m_cfifo_tIndex len, struct _cfifo_crc* crc)
+{
+#if M_CFIFO_CRC
+    m_cfifo_tIndex block;
+
+    if (crc != NULL)
+    {
+        // Checksum a block, then copy it while it is still in the cache
+        for (; len > 0; len -= block, src += block)
+        {
+            block = (len < M_CFIFO_CRC_BLOCK) ? len : (m_cfifo_tIndex)M_CFIFO_CRC_BLOCK;
+            m_cfifo_Crc_Update(crc, src, block);
+            if (dst != NULL)
+            {
+                memcpy(dst, src, block);
+                dst += block;
+            }
+        }
+        return;
+    }
+#else
+    (void)crc;
+#endif
+
+    if (dst != NULL)
+        memcpy(dst, src, len);
+}
+
+static m_cfifo_tIndex m_cfifo_This_PeekInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex offset, uint8_t* data, m_cfifo_tIndex len)
+{
+    m_cfifo_tIndex used;
+    m_cfifo_tIndex pos;
+    m_cfifo_tIndex first;
+
+    used = m_cfifo_This_GetUsageInternal(cfifo);
+    if (offset >= used)
+        return 0;
+
+    if (len > used - offset)
+        len = used - offset;
+
+    if (cfifo->buffer == NULL)
+    {
+        memset(data, cfifo->dummy_byte, len);
+        return len;
+    }
+
+    // Compare against the room up to the end so that the sum cannot overflow
+    pos = m_cfifo_GetRdPos(cfifo);
+    if (offset >= cfifo->buffer_size - pos)
+        pos = (m_cfifo_tIndex)(offset - (cfifo->buffer_size - pos));
+    else
+        pos += offset;
+
+    first = m_cfifo_GetRoomToEnd(cfifo, pos);
+    if (first > len)
+        first = len;
+
+    memcpy(data, &cfifo->buffer[pos], first);
+    if (len > first)
+        memcpy(&data[first], cfifo->buffer, len - first);
+
+    return len;
+}
+
+static m_cfifo_tIndex m_cfifo_This_FindInternal(m_cfifo_tCFifo* cfifo, uint8_t byte, m_cfifo_tIndex max)
+{
+    m_cfifo_tIndex pos;
+    m_cfifo_tIndex first;
+    m_cfifo_tIndex found;
+
+    if (max > m_cfifo_This_GetUsageInternal(cfifo))
+        max = m_cfifo_This_GetUsageInternal(cfifo);
+    if (max == 0)
+        return M_CFIFO_NOT_FOUND;
+
+    if (cfifo->buffer == NULL)
+        return (cfifo->dummy_byte == byte) ? 0 : M_CFIFO_NOT_FOUND;
+
+    pos = m_cfifo_GetRdPos(cfifo);
+    first = m_cfifo_GetRoomToEnd(cfifo, pos);
+    if (first > max)
+        first = max;
+
+    found = m_cfifo_ScanBytes(&cfifo->buffer[pos], byte, first);
+    if (found == M_CFIFO_NOT_FOUND && max > first)
+    {
+        found = m_cfifo_ScanBytes(cfifo->buffer, byte, max - first);
+        if (found != M_CFIFO_NOT_FOUND)
+            found += first;
+    }
+
+    return found;
+}
+
+static m_cfifo_tIndex m_cfifo_ScanBytes(const uint8_t* data, uint8_t byte, m_cfifo_tIndex len)
+{
+#if M_CFIFO_FIND_SWAR
+    const uintptr_t ones = (uintptr_t)-1 / 0xFFu;
+    const uintptr_t highs = ones << 7;
+    const uintptr_t pattern = ones * byte;
+    m_cfifo_tIndex i = 0;
+
+    // Bytes up to the first aligned word
+    while (i < len && ((uintptr_t)&data[i] % sizeof(uintptr_t)) != 0)
+    {
+        if (data[i] == byte)
+            return i;
+        i++;
+    }
+
+    // A word contains the byte if XOR with the pattern yields a zero byte
+    while ((size_t)(len - i) >= sizeof(uintptr_t))
+    {
+        uintptr_t word = *(const uintptr_t*)(const void*)&data[i] ^ pattern;
+        if (((word - ones) & ~word & highs) != 0)
+            break;
+        i += (m_cfifo_tIndex)sizeof(uintptr_t);
+    }
+
+    while (i < len)
+    {
+        if (data[i] == byte)
+            return i;
+        i++;
+    }
+
+    return M_CFIFO_NOT_FOUND;
+#else
+    const uint8_t* hit = (const uint8_t*)memchr(data, byte, len);
+
+    return (hit == NULL) ? M_CFIFO_NOT_FOUND : (m_cfifo_tIndex)(hit - data);
+#endif
+}
+
+static bool m_cfifo_This_PushMsgInternal(m_cfifo_tCFifo* cfifo, const uint8_t* data, m_cfifo_tIndex len)
+{
+    uint8_t header[M_CFIFO_MSG_HEADER_MAX];
+    m_cfifo_tIndex header_len;
+    m_cfifo_tIndex value;
+    m_cfifo_tIndex free_count;
+
+    if (cfifo->buffer == NULL)
+        return false;
+
+    header_len = 0;
+    value = len;
+    do
+    {
+        header[header_len] = (uint8_t)(value & 0x7Fu);
+        value >>= 7;
+        if (value != 0)
+            header[header_len] |= 0x80u;
+        header_len++;
+    } while (value != 0);
+
+    free_count = cfifo->buffer_size - m_cfifo_This_GetUsageInternal(cfifo);
+    if (free_count < header_len || free_count - header_len < len)
+    {
+        M_CFIFO_STATS_ADD(cfifo, push_fail, 1);
+        return false;
+    }
+
+    m_cfifo_This_PushNInternal(cfifo, header, header_len, NULL);
+    m_cfifo_This_PushNInternal(cfifo, data, len, NULL);
+
+    return true;
+}
+
+static bool m_cfifo_This_PeekMsgInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len, m_cfifo_tIndex* header_len)
+{
+    uint8_t header[M_CFIFO_MSG_HEADER_MAX];
+    m_cfifo_tIndex available;
+    m_cfifo_tTotal value;
+    m_cfifo_tIndex i;
+
+    available = m_cfifo_This_PeekInternal(cfifo, 0, header, M_CFIFO_MSG_HEADER_MAX);
+    value = 0;
+
+    for (i = 0; i < available; i++)
+    {
+        value |= (m_cfifo_tTotal)(header[i] & 0x7Fu) << (7u * i);
+        if ((header[i] & 0x80u) == 0)
+            break;
+    }
+
+    if (i >= available || value > M_CFIFO_INDEX_MAX)
+        return false;
+
+    if (m_cfifo_This_GetUsageInternal(cfifo) - (i + 1u) < value)
+        return false;
+
+    *len = (m_cfifo_tIndex)value;
+    *header_len = i + 1u;
+
+    return true;
+}
+
+static bool m_cfifo_This_PopMsgInternal(m_cfifo_tCFifo* cfifo, uint8_t* data, m_cfifo_tIndex max_len, m_cfifo_tIndex* len)
+{
+    m_cfifo_tIndex msg_len;
+    m_cfifo_tIndex header_len;
+
+    if (!m_cfifo_This_PeekMsgInternal(cfifo, &msg_len, &header_len))
+    {
+        M_CFIFO_STATS_ADD(cfifo, pop_fail, 1);
+        if (len != NULL)
+            *len = 0;
+        return false;
+    }
 
-  return size_total;
-}
+    if (len != NULL)
+        *len = msg_len;
 
-uint16_t m_cfifo_This_GetUsage(m_cfifo_tCFifo* cfifo)
-{
-    uint16_t res;
-    //Semaphore take
-    res = m_cfifo_This_GetUsageInternal(cfifo);
-    //Semaphore give
-    return res;
+    if (data != NULL && msg_len > max_len)
+        return false;
+
+    m_cfifo_This_PopNInternal(cfifo, NULL, header_len, NULL);
+    m_cfifo_This_PopNInternal(cfifo, data, msg_len, NULL);
+
+    return true;
 }
 
-uint32_t m_cfifo_All_GetUsage(m_cfifo_tCFifo* cfifo)
+#if M_CFIFO_OVERWRITE
+static void m_cfifo_This_DropOldestInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len, m_cfifo_tIndex unit)
 {
-  uint32_t total_used;
-  
-  //Semaphore take
-  m_cfifo_tCFifo* actual_buffer = cfifo;
-  total_used = 0;
-  
-  while(actual_buffer != NULL)
-  {
-    total_used += m_cfifo_This_GetUsageInternal(actual_buffer);
-    actual_buffer = actual_buffer->next;
-  }
-  //Semaphore give
-  
-  return total_used;
+    m_cfifo_tIndex used;
+    m_cfifo_tIndex drop;
+
+    used = m_cfifo_This_GetUsageInternal(cfifo);
+    if (len <= cfifo->buffer_size - used)
+        return;
+
+    drop = (m_cfifo_tIndex)(len - (cfifo->buffer_size - used));
+    if (unit > 1 && drop % unit != 0)
+        drop = (m_cfifo_tIndex)(drop + unit - drop % unit);
+    if (drop > used)
+        drop = used;
+
+    m_cfifo_AddRdPtr(cfifo, drop);
+    cfifo->dropped_count += drop;
 }
 
-bool m_cfifo_This_IsEmpty(m_cfifo_tCFifo* cfifo)
+static bool m_cfifo_This_DropMsgInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len)
 {
-    bool res;
-    //Semaphore take
-    res = m_cfifo_This_IsEmptyInternal(cfifo);
-    //Semaphore give
-    return res;
+    m_cfifo_tIndex header_len;
+    m_cfifo_tIndex value;
+    m_cfifo_tIndex msg_len;
+    m_cfifo_tIndex msg_header_len;
+    m_cfifo_tIndex free_count;
+
+    header_len = 1;
+    for (value = len >> 7; value != 0; value >>= 7)
+        header_len++;
+
+    if (cfifo->buffer_size < header_len || cfifo->buffer_size - header_len < len)
+        return false;
+
+    free_count = cfifo->buffer_size - m_cfifo_This_GetUsageInternal(cfifo);
+    while (free_count < header_len || free_count - header_len < len)
+    {
+        if (!m_cfifo_This_PeekMsgInternal(cfifo, &msg_len, &msg_header_len))
+            return false;
+
+        m_cfifo_AddRdPtr(cfifo, msg_header_len + msg_len);
+        cfifo->dropped_count += (m_cfifo_tTotal)msg_header_len + msg_len;
+        free_count = (m_cfifo_tIndex)(free_count + msg_header_len + msg_len);
+    }
+
+    return true;
 }
+#endif
 
-bool m_cfifo_All_IsEmpty(m_cfifo_tCFifo* cfifo)
+static uint8_t* m_cfifo_This_GetWriteSpanInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len)
 {
-  bool is_empty;
+    m_cfifo_tIndex space;
+    m_cfifo_tIndex pos;
+    m_cfifo_tIndex first;
 
-  //Semaphore take
-  m_cfifo_tCFifo* actual_buffer = cfifo;
-  is_empty = true;
-  
-  while (actual_buffer != NULL)
-  {
-    is_empty = is_empty && m_cfifo_This_IsEmptyInternal(actual_buffer);
-    actual_buffer = actual_buffer->next;
-  }
-  //Semaphore give
+    *len = 0;
 
-  return is_empty;
+    if (cfifo->buffer == NULL)
+        return NULL;
+
+    if (m_cfifo_This_IsFullInternal(cfifo))
+        return NULL;
+
+    space = cfifo->buffer_size - m_cfifo_This_GetUsageInternal(cfifo);
+    pos = m_cfifo_GetWrPos(cfifo);
+    first = m_cfifo_GetRoomToEnd(cfifo, pos);
+
+    *len = (first < space) ? first : space;
+
+    return &cfifo->buffer[pos];
 }
 
-bool m_cfifo_This_IsFull(m_cfifo_tCFifo* cfifo)
+static uint8_t* m_cfifo_This_GetReadSpanInternal(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len)
 {
-    bool res;
-    //Semaphore take
-    res = m_cfifo_This_IsFullInternal(cfifo);
-    //Semaphore give
-    return res;
+    m_cfifo_tIndex used;
+    m_cfifo_tIndex pos;
+    m_cfifo_tIndex first;
+
+    *len = 0;
+
+    if (cfifo->buffer == NULL)
+        return NULL;
+
+    if (m_cfifo_This_IsEmptyInternal(cfifo))
+        return NULL;
+
+    used = m_cfifo_This_GetUsageInternal(cfifo);
+    pos = m_cfifo_GetRdPos(cfifo);
+    first = m_cfifo_GetRoomToEnd(cfifo, pos);
+
+    *len = (first < used) ? first : used;
+
+    return &cfifo->buffer[pos];
 }
 
-bool m_cfifo_All_IsFull(m_cfifo_tCFifo* cfifo)
+static m_cfifo_tIndex m_cfifo_This_TransferInternal(m_cfifo_tCFifo* dst, m_cfifo_tCFifo* src, m_cfifo_tIndex max_bytes)
 {
-  bool is_full;
+    m_cfifo_tIndex moved = 0;
+    m_cfifo_tIndex rd_len;
+    m_cfifo_tIndex wr_len;
+    m_cfifo_tIndex count;
+    uint8_t* rd;
+    uint8_t* wr;
+
+    while (moved < max_bytes)
+    {
+        if (src->buffer == NULL)
+        {
+            rd = NULL;
+            rd_len = m_cfifo_This_GetUsageInternal(src);
+        }
+        else
+        {
+            rd = m_cfifo_This_GetReadSpanInternal(src, &rd_len);
+        }
+        wr = m_cfifo_This_GetWriteSpanInternal(dst, &wr_len);
+        if (rd_len == 0 || wr_len == 0)
+            break;
+
+        count = (rd_len < wr_len) ? rd_len : wr_len;
+        if (count > max_bytes - moved)
+            count = max_bytes - moved;
+
+        if (rd == NULL)
+            memset(wr, src->dummy_byte, count);
+        else
+            memcpy(wr, rd, count);
+        if (!m_cfifo_This_IsEndlessInternal(src))
+            m_cfifo_AddRdPtr(src, count);
+        m_cfifo_AddWrPtr(dst, count);
+        moved += count;
+    }
 
-  m_cfifo_tCFifo* actual_buffer = cfifo;
+    return moved;
+}
 
-  //Semaphore take
-  is_full = true;
-  
-  while (actual_buffer != NULL)
-  {
-    is_full = is_full && m_cfifo_This_IsFullInternal(actual_buffer);
-    actual_buffer = actual_buffer->next;
-  }
-  //Semaphore give
+static void m_cfifo_LockPair(m_cfifo_tCFifo* a, m_cfifo_tCFifo* b)
+{
+    m_cfifo_tCFifo* first = ((uintptr_t)a < (uintptr_t)b) ? a : b;
+    m_cfifo_tCFifo* second = (first == a) ? b : a;
 
-  return is_full;
+    (void)second;  // unused if the lock macros ignore their argument
+    M_CFIFO_LOCK(first);
+    if (!M_CFIFO_SAME_LOCK(first, second))
+        M_CFIFO_LOCK(second);
 }
 
+static void m_cfifo_UnlockPair(m_cfifo_tCFifo* a, m_cfifo_tCFifo* b)
+{
+    m_cfifo_tCFifo* first = ((uintptr_t)a < (uintptr_t)b) ? a : b;
+    m_cfifo_tCFifo* second = (first == a) ? b : a;
 
+    (void)second;
+    if (!M_CFIFO_SAME_LOCK(first, second))
+        M_CFIFO_UNLOCK(second);
+    M_CFIFO_UNLOCK(first);
+}
 
-//*****************************************************************************
-// Local Functions
-//*****************************************************************************
+static void m_cfifo_ConfigBufferInternal(m_cfifo_tCFifo* cfifo, const void* buffer, m_cfifo_tIndex buffer_size, m_cfifo_tIndex record_size)
+{
+#if M_CFIFO_FREE_RUNNING_INDEX
+    // Free-running indices need a power-of-two size: round down (not for pattern sources)
+    while (buffer != NULL && m_cfifo_GetIndexMask(buffer_size) == 0 && buffer_size > 1)
+        buffer_size &= (m_cfifo_tIndex)(buffer_size - 1);
+#endif
+    if (cfifo->cascade != NULL)
+        cfifo->cascade->size_total += (m_cfifo_tTotal)buffer_size - cfifo->buffer_size;
+#if M_CFIFO_PERSIST
+    cfifo->persist     = NULL;
+#endif
+
+    cfifo->buffer      = (uint8_t*)buffer;
+    cfifo->buffer_size = buffer_size;
+    cfifo->index_mask  = m_cfifo_GetIndexMask(buffer_size);
+    cfifo->record_size = record_size;
+#if M_CFIFO_MIRROR
+    cfifo->mirrored    = false;
+#endif
+    m_cfifo_This_SetFullInternal(cfifo);
+}
 
-static bool m_cfifo_This_PushInternal(m_cfifo_tCFifo* cfifo, uint8_t data)
+static bool m_cfifo_This_PushRecordInternal(m_cfifo_tCFifo* cfifo, const uint8_t* record)
 {
     if (cfifo->buffer == NULL)
         return false;
 
-    if (m_cfifo_This_IsFullInternal(cfifo))
+    if (cfifo->buffer_size - m_cfifo_This_GetUsageInternal(cfifo) < cfifo->record_size)
+    {
+        M_CFIFO_STATS_ADD(cfifo, push_fail, 1);
         return false;
+    }
 
-    cfifo->buffer[cfifo->wrPtr] = data;
-    m_cfifo_IncWrPtr(cfifo);
-    cfifo->used_count++;
+    m_cfifo_This_PushNInternal(cfifo, record, cfifo->record_size, NULL);
 
     return true;
 }
 
-static bool m_cfifo_This_PopInternal(m_cfifo_tCFifo* cfifo, uint8_t* data)
+static bool m_cfifo_This_PopRecordInternal(m_cfifo_tCFifo* cfifo, uint8_t* record)
 {
-    if (m_cfifo_This_IsEmptyInternal(cfifo))
-        return false;
-
-    if (cfifo->buffer == NULL)
-    {
-        if (data != NULL)
-            *data = cfifo->dummy_byte;
-    }
-    else
+    if (m_cfifo_This_GetUsageInternal(cfifo) < cfifo->record_size)
     {
-        if (data != NULL)
-            *data = cfifo->buffer[cfifo->rdPtr];
+        M_CFIFO_STATS_ADD(cfifo, pop_fail, 1);
+        return false;
     }
 
-    m_cfifo_IncRdPtr(cfifo);
-    cfifo->used_count--;
+    m_cfifo_This_PopNInternal(cfifo, record, cfifo->record_size, NULL);
 
     return true;
 }
 
 static void m_cfifo_This_ClearInternal(m_cfifo_tCFifo* cfifo)
 {
+    m_cfifo_tIndex used = m_cfifo_This_GetUsageInternal(cfifo);
+
+    if (cfifo->cascade != NULL)
+        m_cfifo_CascadeOnRead(cfifo, used);
+
     cfifo->rdPtr = 0;
     cfifo->wrPtr = 0;
+#if !M_CFIFO_FREE_RUNNING_INDEX
     cfifo->used_count = 0;
+#endif
+    M_CFIFO_PERSIST_SAVE(cfifo);
+#if M_CFIFO_NOTIFY
+    m_cfifo_NotifyOnRead(cfifo, used);
+#endif
 }
 
 static void m_cfifo_This_SetFullInternal(m_cfifo_tCFifo* cfifo)
 {
+    m_cfifo_tIndex used = m_cfifo_This_GetUsageInternal(cfifo);
+
+    // Usage may shrink here if the buffer was reconfigured to a smaller size
+    if (cfifo->cascade != NULL)
+    {
+        if (cfifo->buffer_size >= used)
+            m_cfifo_CascadeOnWrite(cfifo, cfifo->buffer_size - used);
+        else
+            m_cfifo_CascadeOnRead(cfifo, used - cfifo->buffer_size);
+    }
+
     cfifo->rdPtr = 0;
+#if M_CFIFO_FREE_RUNNING_INDEX
+    cfifo->wrPtr = cfifo->buffer_size;
+#else
     cfifo->wrPtr = 0;
     cfifo->used_count = cfifo->buffer_size;
+#endif
+    M_CFIFO_PERSIST_SAVE(cfifo);
+#if M_CFIFO_NOTIFY
+    if (cfifo->buffer_size > used)
+        m_cfifo_NotifyOnWrite(cfifo, cfifo->buffer_size - used);
+#endif
 }
 
-static uint16_t m_cfifo_This_GetSizeInternal(m_cfifo_tCFifo* cfifo)
+static m_cfifo_tIndex m_cfifo_This_GetSizeInternal(m_cfifo_tCFifo* cfifo)
 {
     return cfifo->buffer_size;
 }
 
-static uint16_t m_cfifo_This_GetUsageInternal(m_cfifo_tCFifo* cfifo)
+static m_cfifo_tIndex m_cfifo_This_GetUsageInternal(m_cfifo_tCFifo* cfifo)
 {
+#if M_CFIFO_FREE_RUNNING_INDEX
+    return (m_cfifo_tIndex)(cfifo->wrPtr - cfifo->rdPtr);
+#else
     return cfifo->used_count;
+#endif
 }
 
 static bool m_cfifo_This_IsEmptyInternal(m_cfifo_tCFifo* cfifo)
 {
     bool is_empty;
 
-    is_empty = cfifo->used_count == 0;
+    is_empty = m_cfifo_This_GetUsageInternal(cfifo) == 0;
 
     return is_empty;
 }
@@ -482,19 +2649,323 @@ static bool m_cfifo_This_IsFullInternal(m_cfifo_tCFifo* cfifo)
 {
     bool is_full;
 
-    is_full = cfifo->used_count >= cfifo->buffer_size;
+    is_full = m_cfifo_This_GetUsageInternal(cfifo) >= cfifo->buffer_size;
 
     return is_full;
 }
 
+static bool m_cfifo_This_IsEndlessInternal(m_cfifo_tCFifo* cfifo)
+{
+    return cfifo->buffer == NULL && cfifo->buffer_size == M_CFIFO_INDEX_MAX;
+}
+
 static void m_cfifo_IncRdPtr(m_cfifo_tCFifo* cfifo)
 {
-  cfifo->rdPtr = (cfifo->rdPtr + 1) % cfifo->buffer_size;
+  if (cfifo->cascade != NULL)
+    m_cfifo_CascadeOnRead(cfifo, 1);
+
+#if M_CFIFO_FREE_RUNNING_INDEX
+  cfifo->rdPtr++;
+#else
+  if (cfifo->index_mask != 0)
+    cfifo->rdPtr = (cfifo->rdPtr + 1) & cfifo->index_mask;
+  else if (++cfifo->rdPtr >= cfifo->buffer_size)
+    cfifo->rdPtr = 0;
+
+  cfifo->used_count--;
+#endif
+  M_CFIFO_STATS_ADD(cfifo, bytes_out, 1);
+  M_CFIFO_PERSIST_SAVE(cfifo);
+#if M_CFIFO_NOTIFY
+  m_cfifo_NotifyOnRead(cfifo, 1);
+#endif
 }
 
 static void m_cfifo_IncWrPtr(m_cfifo_tCFifo* cfifo)
 {
-  cfifo->wrPtr = (cfifo->wrPtr + 1) % cfifo->buffer_size;
+  if (cfifo->cascade != NULL)
+    m_cfifo_CascadeOnWrite(cfifo, 1);
+
+#if M_CFIFO_FREE_RUNNING_INDEX
+  cfifo->wrPtr++;
+#else
+  if (cfifo->index_mask != 0)
+    cfifo->wrPtr = (cfifo->wrPtr + 1) & cfifo->index_mask;
+  else if (++cfifo->wrPtr >= cfifo->buffer_size)
+    cfifo->wrPtr = 0;
+
+  cfifo->used_count++;
+#endif
+  M_CFIFO_STATS_ADD(cfifo, bytes_in, 1);
+  M_CFIFO_STATS_PEAK(cfifo);
+  M_CFIFO_PERSIST_SAVE(cfifo);
+#if M_CFIFO_NOTIFY
+  m_cfifo_NotifyOnWrite(cfifo, 1);
+#endif
+}
+
+static void m_cfifo_AddRdPtr(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count)
+{
+  if (cfifo->cascade != NULL)
+    m_cfifo_CascadeOnRead(cfifo, count);
+
+#if M_CFIFO_FREE_RUNNING_INDEX
+  cfifo->rdPtr += count;
+#else
+  if (cfifo->index_mask != 0)
+    cfifo->rdPtr = (m_cfifo_tIndex)(cfifo->rdPtr + count) & cfifo->index_mask;
+  else if (count >= cfifo->buffer_size - cfifo->rdPtr)
+    cfifo->rdPtr = (m_cfifo_tIndex)(count - (cfifo->buffer_size - cfifo->rdPtr));
+  else
+    cfifo->rdPtr += count;
+  cfifo->used_count -= count;
+#endif
+  M_CFIFO_STATS_ADD(cfifo, bytes_out, count);
+  M_CFIFO_PERSIST_SAVE(cfifo);
+#if M_CFIFO_NOTIFY
+  m_cfifo_NotifyOnRead(cfifo, count);
+#endif
+}
+
+static void m_cfifo_AddWrPtr(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count)
+{
+  if (cfifo->cascade != NULL)
+    m_cfifo_CascadeOnWrite(cfifo, count);
+
+#if M_CFIFO_FREE_RUNNING_INDEX
+  cfifo->wrPtr += count;
+#else
+  if (cfifo->index_mask != 0)
+    cfifo->wrPtr = (m_cfifo_tIndex)(cfifo->wrPtr + count) & cfifo->index_mask;
+  else if (count >= cfifo->buffer_size - cfifo->wrPtr)
+    cfifo->wrPtr = (m_cfifo_tIndex)(count - (cfifo->buffer_size - cfifo->wrPtr));
+  else
+    cfifo->wrPtr += count;
+  cfifo->used_count += count;
+#endif
+  M_CFIFO_STATS_ADD(cfifo, bytes_in, count);
+  M_CFIFO_STATS_PEAK(cfifo);
+  M_CFIFO_PERSIST_SAVE(cfifo);
+#if M_CFIFO_NOTIFY
+  m_cfifo_NotifyOnWrite(cfifo, count);
+#endif
+}
+
+static m_cfifo_tIndex m_cfifo_GetRdPos(m_cfifo_tCFifo* cfifo)
+{
+#if M_CFIFO_FREE_RUNNING_INDEX
+  return cfifo->rdPtr & cfifo->index_mask;
+#else
+  return cfifo->rdPtr;
+#endif
+}
+
+static m_cfifo_tIndex m_cfifo_GetWrPos(m_cfifo_tCFifo* cfifo)
+{
+#if M_CFIFO_FREE_RUNNING_INDEX
+  return cfifo->wrPtr & cfifo->index_mask;
+#else
+  return cfifo->wrPtr;
+#endif
+}
+
+static m_cfifo_tIndex m_cfifo_GetRoomToEnd(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex pos)
+{
+#if M_CFIFO_MIRROR
+  if (cfifo->mirrored)
+    return cfifo->buffer_size;
+#endif
+  return cfifo->buffer_size - pos;
+}
+
+static m_cfifo_tIndex m_cfifo_GetIndexMask(m_cfifo_tIndex buffer_size)
+{
+  if (buffer_size != 0 && (buffer_size & (buffer_size - 1)) == 0)
+    return buffer_size - 1;
+  else
+    return 0;
+}
+
+static bool m_cfifo_IsCascadeHead(m_cfifo_tCFifo* cfifo)
+{
+  return cfifo->cascade != NULL && cfifo->cascade->head == cfifo;
+}
+
+static m_cfifo_tCFifo* m_cfifo_GetWriteCursor(m_cfifo_tCFifo* cfifo)
+{
+  m_cfifo_tCFifo* segment;
+
+  if (!m_cfifo_IsCascadeHead(cfifo))
+    return cfifo;
+
+  segment = cfifo->cascade->wr_segment;
+#if M_CFIFO_POOL
+  // A full pooled cascade may grow again once other users freed segments
+  if (segment == NULL && cfifo->cascade->pool != NULL && cfifo->cascade->pool->free_list != NULL)
+  {
+    segment = cfifo;
+    while (segment->next != NULL)
+      segment = segment->next;
+  }
+#endif
+
+  return segment;
+}
+
+static void m_cfifo_SetWriteCursor(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* segment)
+{
+  if (m_cfifo_IsCascadeHead(cfifo))
+    cfifo->cascade->wr_segment = segment;
+}
+
+static m_cfifo_tCFifo* m_cfifo_GetReadCursor(m_cfifo_tCFifo* cfifo)
+{
+  if (m_cfifo_IsCascadeHead(cfifo))
+    return cfifo->cascade->rd_segment;
+  else
+    return cfifo;
+}
+
+static void m_cfifo_SetReadCursor(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* segment)
+{
+  if (m_cfifo_IsCascadeHead(cfifo))
+  {
+    cfifo->cascade->rd_segment = segment;
+#if M_CFIFO_POOL
+    if (cfifo->cascade->pool != NULL)
+      m_cfifo_PoolShrinkInternal(cfifo);
+#endif
+  }
+}
+
+static m_cfifo_tCFifo* m_cfifo_GetNextWriteSegment(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* segment)
+{
+#if M_CFIFO_POOL
+  m_cfifo_tPool* pool;
+
+  if (segment->next == NULL && m_cfifo_IsCascadeHead(cfifo) && cfifo->cascade->pool != NULL)
+  {
+    pool = cfifo->cascade->pool;
+    if (m_cfifo_This_IsEmptyInternal(segment) && segment->buffer_size >= pool->block_size)
+      return NULL;
+    return m_cfifo_PoolGrowInternal(cfifo->cascade, segment);
+  }
+#else
+  (void)cfifo;
+#endif
+
+  return segment->next;
+}
+
+static void m_cfifo_AttachCascadeInternal(m_cfifo_tCascade* cascade, m_cfifo_tCFifo* head)
+{
+  m_cfifo_tCFifo* actual_buffer = head;
+  uint16_t segment_index;
+
+  cascade->head = head;
+  cascade->wr_segment = head;
+  cascade->rd_segment = head;
+  cascade->size_total = 0;
+  cascade->used_total = 0;
+  segment_index = 0;
+
+  while (actual_buffer != NULL)
+  {
+    actual_buffer->cascade = cascade;
+    actual_buffer->segment_index = segment_index++;
+    cascade->size_total += m_cfifo_This_GetSizeInternal(actual_buffer);
+    cascade->used_total += m_cfifo_This_GetUsageInternal(actual_buffer);
+    actual_buffer = actual_buffer->next;
+  }
+}
+
+#if M_CFIFO_POOL
+static m_cfifo_tCFifo* m_cfifo_PoolGrowInternal(m_cfifo_tCascade* cascade, m_cfifo_tCFifo* tail)
+{
+  m_cfifo_tPool* pool = cascade->pool;
+  m_cfifo_tCFifo* segment = pool->free_list;
+
+  if (segment == NULL)
+    return NULL;
+
+  pool->free_list = segment->next;
+  pool->free_count--;
+
+  segment->next        = NULL;
+  segment->prev        = tail;
+  segment->cascade     = cascade;
+  segment->record_size = cascade->head->record_size;
+  tail->next           = segment;
+  cascade->size_total += m_cfifo_This_GetSizeInternal(segment);
+
+  if (tail->segment_index < UINT16_MAX)
+  {
+    segment->segment_index = tail->segment_index + 1u;
+  }
+  else
+  {
+    // Indices only need to increase along the chain: renumber once they run out
+    uint16_t segment_index = 0;
+    for (tail = cascade->head; tail != NULL; tail = tail->next)
+      tail->segment_index = segment_index++;
+  }
+
+  return segment;
+}
+
+static void m_cfifo_PoolShrinkInternal(m_cfifo_tCFifo* cfifo)
+{
+  m_cfifo_tCascade* cascade = cfifo->cascade;
+  m_cfifo_tPool* pool = cascade->pool;
+  m_cfifo_tCFifo* segment = cfifo;
+  m_cfifo_tCFifo* next;
+
+  while (segment != NULL && m_cfifo_This_IsEmptyInternal(segment))
+  {
+    next = segment->next;
+
+    if (segment != cfifo && next != NULL &&
+        segment >= pool->segments && segment < &pool->segments[pool->segment_count])
+    {
+      segment->prev->next = next;
+      next->prev = segment->prev;
+
+      if (cascade->rd_segment == segment)
+        cascade->rd_segment = next;
+      if (cascade->wr_segment == segment)
+        cascade->wr_segment = next;
+      cascade->size_total -= m_cfifo_This_GetSizeInternal(segment);
+
+      segment->prev    = NULL;
+      segment->cascade = NULL;
+      segment->next    = pool->free_list;
+      pool->free_list  = segment;
+      pool->free_count++;
+    }
+
+    segment = next;
+  }
+}
+#endif
+
+static void m_cfifo_CascadeOnWrite(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count)
+{
+  m_cfifo_tCascade* cascade = cfifo->cascade;
+
+  cascade->used_total += count;
+
+  if (cascade->rd_segment == NULL || cfifo->segment_index < cascade->rd_segment->segment_index)
+    cascade->rd_segment = cfifo;
+}
+
+static void m_cfifo_CascadeOnRead(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count)
+{
+  m_cfifo_tCascade* cascade = cfifo->cascade;
+
+  cascade->used_total -= count;
+
+  if (cascade->wr_segment == NULL || cfifo->segment_index < cascade->wr_segment->segment_index)
+    cascade->wr_segment = cfifo;
 }
 
 static m_cfifo_tCFifo* m_cfifo_GetAdjacentFifo(m_cfifo_tCFifo* cfifo, m_cfifo_tDirection direction)
@@ -509,3 +2980,152 @@ static m_cfifo_tCFifo* m_cfifo_GetAdjacentFifo(m_cfifo_tCFifo* cfifo, m_cfifo_tD
   else
     return NULL;
 }
+
+#if M_CFIFO_NOTIFY
+static void m_cfifo_NotifyOnWrite(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count)
+{
+  m_cfifo_tIndex used;
+
+  if (cfifo->signal == NULL)
+    return;
+
+  used = m_cfifo_This_GetUsageInternal(cfifo);
+  if (used >= cfifo->high_watermark && used - count < cfifo->high_watermark)
+    cfifo->signal(cfifo->notify_ctx, M_CFIFO_HIGH_WATERMARK);
+}
+
+static void m_cfifo_NotifyOnRead(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex count)
+{
+  m_cfifo_tIndex used;
+  m_cfifo_tIndex low;
+
+  if (cfifo->signal == NULL || cfifo->buffer_size == 0)
+    return;
+
+  used = m_cfifo_This_GetUsageInternal(cfifo);
+  low = cfifo->low_watermark;
+  if (low >= cfifo->buffer_size)
+    low = (m_cfifo_tIndex)(cfifo->buffer_size - 1u);
+
+  if (used <= low && count > low - used)
+    cfifo->signal(cfifo->notify_ctx, M_CFIFO_LOW_WATERMARK);
+}
+#endif
+
+#if M_CFIFO_PERSIST
+static void m_cfifo_PersistSave(m_cfifo_tCFifo* cfifo)
+{
+  m_cfifo_tPersist* persist = cfifo->persist;
+  uint8_t sequence;
+  volatile m_cfifo_tPersistCopy* copy;
+
+  // Overwrite the older copy, so the newer one survives a torn update
+  if ((int8_t)(uint8_t)(persist->copy[1].sequence - persist->copy[0].sequence) > 0)
+  {
+    copy = &persist->copy[0];
+    sequence = (uint8_t)(persist->copy[1].sequence + 1u);
+  }
+  else
+  {
+    copy = &persist->copy[1];
+    sequence = (uint8_t)(persist->copy[0].sequence + 1u);
+  }
+
+  // Invalidate first; the checksum is written last
+  copy->magic        = 0;
+  copy->version      = M_CFIFO_PERSIST_VERSION;
+  copy->index_size   = (uint8_t)sizeof(m_cfifo_tIndex);
+  copy->free_running = M_CFIFO_FREE_RUNNING_INDEX;
+  copy->sequence     = sequence;
+  copy->buffer_size  = cfifo->buffer_size;
+  copy->rdPtr        = cfifo->rdPtr;
+  copy->wrPtr        = cfifo->wrPtr;
+  copy->used_count   = m_cfifo_This_GetUsageInternal(cfifo);
+  copy->magic        = M_CFIFO_PERSIST_MAGIC;
+  copy->check        = m_cfifo_PersistChecksum((const m_cfifo_tPersistCopy*)copy);
+}
+
+static uint32_t m_cfifo_PersistChecksum(const m_cfifo_tPersistCopy* copy)
+{
+  const volatile uint8_t* data = (const volatile uint8_t*)copy;
+  uint32_t hash = 2166136261u;
+  size_t i;
+
+  for (i = 0; i < offsetof(m_cfifo_tPersistCopy, check); i++)
+  {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static bool m_cfifo_PersistIsValid(m_cfifo_tCFifo* cfifo, const m_cfifo_tPersistCopy* copy)
+{
+  if (copy->magic != M_CFIFO_PERSIST_MAGIC || copy->version != M_CFIFO_PERSIST_VERSION ||
+      copy->index_size != sizeof(m_cfifo_tIndex) || copy->free_running != M_CFIFO_FREE_RUNNING_INDEX ||
+      copy->check != m_cfifo_PersistChecksum(copy))
+    return false;
+
+  if (cfifo->buffer == NULL || copy->buffer_size != cfifo->buffer_size || copy->used_count > cfifo->buffer_size)
+    return false;
+
+#if M_CFIFO_FREE_RUNNING_INDEX
+  return (m_cfifo_tIndex)(copy->wrPtr - copy->rdPtr) == copy->used_count;
+#else
+  if (copy->rdPtr >= cfifo->buffer_size || copy->wrPtr >= cfifo->buffer_size)
+    return false;
+
+  // The stored bytes must span exactly from the read to the write index
+  if (copy->used_count >= cfifo->buffer_size - copy->rdPtr)
+    return copy->wrPtr == copy->used_count - (cfifo->buffer_size - copy->rdPtr);
+  return copy->wrPtr == copy->rdPtr + copy->used_count;
+#endif
+}
+#endif
+
+
+#if M_CFIFO_TRACE
+static uint32_t m_cfifo_TraceNow(void)
+{
+  return (m_cfifo_trace_clock != NULL) ? m_cfifo_trace_clock() : 0;
+}
+
+static void m_cfifo_TraceEmit(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* segment, unsigned op, uint32_t start, m_cfifo_tTotal bytes)
+{
+  m_cfifo_tCFifo* ring = m_cfifo_trace_ring;
+  m_cfifo_tTraceEvent event;
+  const m_cfifo_tIndex size = (m_cfifo_tIndex)sizeof(event);
+  m_cfifo_tTotal usage;
+
+  if (ring == NULL || cfifo == ring)
+    return;
+
+  if ((op & M_CFIFO_TRACE_CASCADED) != 0 && m_cfifo_IsCascadeHead(segment))
+    usage = segment->cascade->used_total;
+  else
+    usage = m_cfifo_This_GetUsageInternal(segment);
+
+  event.timestamp = start;
+  event.duration  = m_cfifo_TraceNow() - start;
+  event.instance  = cfifo->trace_id;
+  event.op        = (uint8_t)op;
+  event.segment   = (uint8_t)((segment->segment_index > UINT8_MAX) ? UINT8_MAX : segment->segment_index);
+  event.bytes     = (uint16_t)((bytes > UINT16_MAX) ? UINT16_MAX : bytes);
+  event.usage     = (uint16_t)((usage > UINT16_MAX) ? UINT16_MAX : usage);
+
+  // The traced FIFO's lock is held; take the ring's only if it is another one
+  if (!M_CFIFO_SAME_LOCK(ring, cfifo))
+    M_CFIFO_TRACE_LOCK(ring);
+#if M_CFIFO_OVERWRITE
+  if (ring->overwrite && ring->buffer != NULL && size <= ring->buffer_size)
+    m_cfifo_This_DropOldestInternal(ring, size, size);
+#endif
+  if (ring->buffer == NULL || (m_cfifo_tIndex)(ring->buffer_size - m_cfifo_This_GetUsageInternal(ring)) < size)
+    m_cfifo_trace_dropped++;
+  else
+    m_cfifo_This_PushNInternal(ring, (const uint8_t*)&event, size, NULL);
+  if (!M_CFIFO_SAME_LOCK(ring, cfifo))
+    M_CFIFO_TRACE_UNLOCK(ring);
+}
+#endif
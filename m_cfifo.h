@@ -12,8 +12,10 @@
  * be configured with a backing data buffer via @ref m_cfifo_ConfigBuffer before use.
  *
  * Thread safety:
- * - The module is designed for external semaphore protection.
- * - Public API functions are expected to be wrapped by the caller if required.
+ * - Every public function brackets its work with @ref M_CFIFO_LOCK and
+ *   @ref M_CFIFO_UNLOCK, which compile to nothing by default.
+ * - Cascaded (`All_*`) functions take the lock of the first FIFO once for
+ *   the whole walk.
  *
  * @note Internal helper functions are declared only in the implementation file.
  *
@@ -27,17 +29,321 @@
 
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <inttypes.h>
 
 //*****************************************************************************
 // Global Defines
 //*****************************************************************************
 
+/**
+ * @brief Optional user configuration header.
+ *
+ * Define `M_CFIFO_USER_CONFIG` (e.g. `-DM_CFIFO_USER_CONFIG='"my_cfifo_cfg.h"'`)
+ * to provide the compile-time options below from a single file.
+ */
+#ifdef M_CFIFO_USER_CONFIG
+#include M_CFIFO_USER_CONFIG
+#endif
+
+/**
+ * @brief Compile-time option for the width of sizes, indices and lengths.
+ *
+ * - 16 (default): @ref m_cfifo_tIndex is `uint16_t`, buffers up to 65535 bytes.
+ * - 32: @ref m_cfifo_tIndex is `uint32_t`, buffers up to 4 GiB.
+ * - 0: @ref m_cfifo_tIndex is `size_t`, the native width of the target.
+ *
+ * Cascade totals (@ref m_cfifo_tTotal) are kept one step wider so that a
+ * chain of maximum-size segments cannot overflow them.
+ */
+#ifndef M_CFIFO_INDEX_WIDTH
+#define M_CFIFO_INDEX_WIDTH 16
+#endif
+
+/**
+ * @brief Compile-time option for free-running read/write indices.
+ *
+ * When set to 1, `rdPtr` and `wrPtr` are never wrapped; the buffer position
+ * is obtained with `index_mask` and the usage is `wrPtr - rdPtr`, so the
+ * `used_count` member is removed. Buffer sizes must then be a power of two
+ * (at most half of @ref M_CFIFO_INDEX_MAX + 1, e.g. 32768 for 16-bit
+ * indices); @ref m_cfifo_ConfigBuffer rounds other sizes down.
+ *
+ * When set to 0 (default), any buffer size is supported and power-of-two
+ * sizes automatically wrap with `index_mask` instead of a compare.
+ */
+#ifndef M_CFIFO_FREE_RUNNING_INDEX
+#define M_CFIFO_FREE_RUNNING_INDEX 0
+#endif
+
+/**
+ * @brief Largest length header written in front of a message.
+ *
+ * Message lengths are stored as a little-endian base-128 varint: 1 byte for
+ * lengths below 128, 2 bytes below 16384, 3 bytes up to 65535 and one more
+ * byte per further 7 bits of @ref m_cfifo_tIndex.
+ */
+#define M_CFIFO_MSG_HEADER_MAX  ((sizeof(m_cfifo_tIndex) * 8u + 6u) / 7u)
+
+/**
+ * @brief Compile-time option for the per-instance overwrite policy.
+ *
+ * When set to 1, every FIFO carries an `overwrite` flag and a `dropped_count`
+ * counter. With the flag enabled by @ref m_cfifo_SetOverwrite, the `This_*`
+ * push functions discard the oldest data instead of failing when the FIFO
+ * is full.
+ */
+#ifndef M_CFIFO_OVERWRITE
+#define M_CFIFO_OVERWRITE 0
+#endif
+
+/**
+ * @brief Compile-time option for per-instance usage statistics.
+ *
+ * When set to 1, every FIFO carries an @ref m_cfifo_tStats block that
+ * records the peak usage, failed pushes and pops, and the byte throughput.
+ * Read it with @ref m_cfifo_GetStats or, per segment, @ref m_cfifo_All_GetStats.
+ */
+#ifndef M_CFIFO_STATS
+#define M_CFIFO_STATS 0
+#endif
+
+/**
+ * @brief Compile-time option for the scan used by @ref m_cfifo_This_Find.
+ *
+ * When set to 0 (default), stored bytes are searched with `memchr`, which
+ * hosted C libraries implement with SSE2/AVX2 or NEON. When set to 1, a
+ * portable word-at-a-time scan is used instead, for targets whose C library
+ * only provides a byte loop (e.g. small MCU runtimes).
+ */
+#ifndef M_CFIFO_FIND_SWAR
+#define M_CFIFO_FIND_SWAR 0
+#endif
+
+/**
+ * @brief Compile-time option for mirrored (double-mapped) buffers.
+ *
+ * When set to 1, a FIFO can be configured with a buffer whose pages are
+ * mapped twice back to back (see @ref m_cfifo_ConfigMirrorBuffer and the
+ * host allocator in m_cfifo_mirror.h). Every stored or free region is then
+ * contiguous, so zero-copy spans never stop at the wrap point and bulk
+ * copies need no split.
+ */
+#ifndef M_CFIFO_MIRROR
+#define M_CFIFO_MIRROR 0
+#endif
+
+/**
+ * @brief Compile-time option for pooled cascade segments.
+ *
+ * When set to 1, a cascade descriptor can draw its segments from a shared
+ * @ref m_cfifo_tPool: cascaded pushes on the head link a free block when
+ * the last segment is full, and cascaded pops return drained segments.
+ */
+#ifndef M_CFIFO_POOL
+#define M_CFIFO_POOL 0
+#endif
+
+/**
+ * @brief Compile-time option for crash-survivable FIFO state.
+ *
+ * When set to 1, a FIFO can be configured with a @ref m_cfifo_tPersist
+ * header next to its buffer (see @ref m_cfifo_ConfigPersistBuffer), e.g.
+ * both in a retained RAM section. Every index update is mirrored into the
+ * header, so the content is recovered after a reset instead of lost.
+ */
+#ifndef M_CFIFO_PERSIST
+#define M_CFIFO_PERSIST 0
+#endif
+
+/**
+ * @brief Magic value of a persistent FIFO header ("CFPH").
+ */
+#define M_CFIFO_PERSIST_MAGIC   0x48504643u
+
+/**
+ * @brief Layout version of the persistent FIFO header.
+ *
+ * Increment when @ref m_cfifo_tPersistCopy changes, so that headers
+ * written by older firmware are rejected instead of misread.
+ */
+#define M_CFIFO_PERSIST_VERSION 1u
+
+/**
+ * @brief Compile-time option for checksums computed during bulk copies.
+ *
+ * When set to 1, @ref m_cfifo_This_PushNCrc, @ref m_cfifo_This_PopNCrc and
+ * their cascaded variants become available. They update a running
+ * @ref m_cfifo_tCrc (m_cfifo_crc.h, linked from m_cfifo_crc.c) over the
+ * bytes they copy.
+ */
+#ifndef M_CFIFO_CRC
+#define M_CFIFO_CRC 0
+#endif
+
+#if M_CFIFO_CRC
+#include "m_cfifo_crc.h"
+#endif
+
+/**
+ * @brief Compile-time option for watermark notification and blocking waits.
+ *
+ * When set to 1, every FIFO carries a signal hook, a wait hook and a pair of
+ * watermarks (see @ref m_cfifo_SetNotifyHooks and @ref m_cfifo_SetWatermarks),
+ * and @ref m_cfifo_PopWait / @ref m_cfifo_PushWait become available.
+ */
+#ifndef M_CFIFO_NOTIFY
+#define M_CFIFO_NOTIFY 0
+#endif
+
+/**
+ * @brief Timeout value of @ref m_cfifo_PopWait / @ref m_cfifo_PushWait that
+ *        waits without limit.
+ */
+#define M_CFIFO_WAIT_FOREVER UINT32_MAX
+
+/**
+ * @brief Compile-time option for per-instance lock hooks.
+ *
+ * When set to 1, every FIFO carries a lock/unlock function pair that is
+ * assigned with @ref m_cfifo_SetLockHooks and called by the default
+ * @ref M_CFIFO_LOCK / @ref M_CFIFO_UNLOCK macros.
+ */
+#ifndef M_CFIFO_INSTANCE_LOCK
+#define M_CFIFO_INSTANCE_LOCK 0
+#endif
+
+/**
+ * @brief Lock taken at the start of every public FIFO function.
+ *
+ * Defaults to a no-op, or to the per-instance hook if
+ * @ref M_CFIFO_INSTANCE_LOCK is enabled. May be predefined by the user,
+ * e.g. as an interrupt-mask critical section on bare metal:
+ * `#define M_CFIFO_LOCK(cfifo) __disable_irq()`.
+ *
+ * @param cfifo FIFO the operation starts on (first FIFO of a cascade).
+ */
+#ifndef M_CFIFO_LOCK
+#if M_CFIFO_INSTANCE_LOCK
+#define M_CFIFO_LOCK(cfifo)     do { if ((cfifo)->lock != NULL) (cfifo)->lock((cfifo)->lock_ctx); } while (0)
+#ifndef M_CFIFO_SAME_LOCK
+#define M_CFIFO_SAME_LOCK(a, b) ((a)->lock == (b)->lock && (a)->lock_ctx == (b)->lock_ctx)
+#endif
+#else
+#define M_CFIFO_LOCK(cfifo)     ((void)0)
+#endif
+#endif
+
+/**
+ * @brief Lock released at the end of every public FIFO function.
+ *
+ * Counterpart of @ref M_CFIFO_LOCK.
+ *
+ * @param cfifo FIFO the operation started on (first FIFO of a cascade).
+ */
+#ifndef M_CFIFO_UNLOCK
+#if M_CFIFO_INSTANCE_LOCK
+#define M_CFIFO_UNLOCK(cfifo)   do { if ((cfifo)->unlock != NULL) (cfifo)->unlock((cfifo)->lock_ctx); } while (0)
+#else
+#define M_CFIFO_UNLOCK(cfifo)   ((void)0)
+#endif
+#endif
+
+/**
+ * @brief Tells whether two FIFOs are guarded by the same lock.
+ *
+ * Used by functions that lock two FIFOs (@ref m_cfifo_Transfer): a common
+ * lock is taken once, distinct locks are taken in address order. With the
+ * per-instance hooks, FIFOs with the same hook and context share a lock.
+ * Otherwise @ref M_CFIFO_LOCK is assumed to be one global lock; a user
+ * macro that locks per instance must also define this one.
+ *
+ * @param a First FIFO.
+ * @param b Second FIFO.
+ */
+#ifndef M_CFIFO_SAME_LOCK
+#define M_CFIFO_SAME_LOCK(a, b) 1
+#endif
+
+/**
+ * @brief Compile-time option for binary trace events.
+ *
+ * When set to 1, the data-path functions (push, pop and their bulk, record,
+ * message and CRC variants, the commit/release of a span and
+ * @ref m_cfifo_Transfer) write one @ref m_cfifo_tTraceEvent per call into
+ * the ring attached with @ref m_cfifo_TraceAttach. When set to 2, the
+ * cascaded walks additionally write one event for every segment they visit.
+ * tools/m_cfifo_trace.py decodes a dump of the ring.
+ */
+#ifndef M_CFIFO_TRACE
+#define M_CFIFO_TRACE 0
+#endif
+
+/**
+ * @brief Lock taken around writing an event into the trace ring.
+ *
+ * Defaults to @ref M_CFIFO_LOCK of the ring. The event is written while
+ * the traced FIFO is still locked, so the ring lock is skipped when
+ * @ref M_CFIFO_SAME_LOCK reports the same lock for both, e.g. with a
+ * single global lock or critical section.
+ *
+ * @param ring Trace ring.
+ */
+#ifndef M_CFIFO_TRACE_LOCK
+#define M_CFIFO_TRACE_LOCK(ring)    M_CFIFO_LOCK(ring)
+#endif
+
+/**
+ * @brief Lock released after writing an event into the trace ring.
+ *
+ * Counterpart of @ref M_CFIFO_TRACE_LOCK.
+ *
+ * @param ring Trace ring.
+ */
+#ifndef M_CFIFO_TRACE_UNLOCK
+#define M_CFIFO_TRACE_UNLOCK(ring)  M_CFIFO_UNLOCK(ring)
+#endif
+
+/**
+ * @brief Flag of @ref m_cfifo_tTraceEvent `op` set by the cascaded
+ *        (`All_*`) functions.
+ */
+#define M_CFIFO_TRACE_CASCADED  0x80u
+
 
 //*****************************************************************************
 // Global Types
 //*****************************************************************************
 
+/**
+ * @brief Index and total types selected by @ref M_CFIFO_INDEX_WIDTH.
+ *
+ * - `m_cfifo_tIndex`: buffer sizes, read/write indices and transfer lengths.
+ * - `m_cfifo_tTotal`: cascade-wide sizes, usages and offsets.
+ * - `M_CFIFO_INDEX_MAX`: largest value of `m_cfifo_tIndex`.
+ */
+#if M_CFIFO_INDEX_WIDTH == 16
+typedef uint16_t m_cfifo_tIndex;
+typedef uint32_t m_cfifo_tTotal;
+#define M_CFIFO_INDEX_MAX   UINT16_MAX
+#elif M_CFIFO_INDEX_WIDTH == 32
+typedef uint32_t m_cfifo_tIndex;
+typedef uint64_t m_cfifo_tTotal;
+#define M_CFIFO_INDEX_MAX   UINT32_MAX
+#elif M_CFIFO_INDEX_WIDTH == 0
+typedef size_t   m_cfifo_tIndex;
+typedef uint64_t m_cfifo_tTotal;
+#define M_CFIFO_INDEX_MAX   SIZE_MAX
+#else
+#error "M_CFIFO_INDEX_WIDTH must be 16, 32 or 0 (size_t)"
+#endif
+
+/**
+ * @brief Result of @ref m_cfifo_This_Find and @ref m_cfifo_All_Find when the
+ * byte is not stored within the searched range.
+ */
+#define M_CFIFO_NOT_FOUND   M_CFIFO_INDEX_MAX
+
 /**
  * @brief Direction selector for traversing cascaded FIFO buffers.
  *
@@ -56,6 +362,231 @@ typedef enum
 }m_cfifo_tDirection;
 
 
+/**
+ * @brief Lock hook signature used with @ref M_CFIFO_INSTANCE_LOCK.
+ *
+ * @param ctx User context given to @ref m_cfifo_SetLockHooks.
+ */
+typedef void (*m_cfifo_tLockHook)(void* ctx);
+
+
+/**
+ * @brief Watermark selector used with @ref M_CFIFO_NOTIFY.
+ *
+ * - `M_CFIFO_HIGH_WATERMARK` → usage rose to the high watermark (data for consumers)
+ * - `M_CFIFO_LOW_WATERMARK`  → usage fell to the low watermark (space for producers)
+ */
+typedef enum
+{
+  M_CFIFO_HIGH_WATERMARK,
+  M_CFIFO_LOW_WATERMARK
+}m_cfifo_tWatermark;
+
+
+/**
+ * @brief Signal hook called when a watermark is crossed.
+ *
+ * Called with the FIFO lock held, once per crossing and not per byte.
+ * Typical implementations give a semaphore, set an RTOS event flag or wake a
+ * futex, and must be callable from every context that pushes or pops
+ * (e.g. ISR-safe on bare metal).
+ *
+ * @param ctx       User context given to @ref m_cfifo_SetNotifyHooks.
+ * @param watermark Watermark that was crossed.
+ */
+typedef void (*m_cfifo_tSignalHook)(void* ctx, m_cfifo_tWatermark watermark);
+
+
+/**
+ * @brief Wait hook used by @ref m_cfifo_PopWait and @ref m_cfifo_PushWait.
+ *
+ * Blocks until the signal hook was called for @p watermark or the timeout
+ * expires. A signal given before the wait starts must not be lost, so the
+ * hook should wrap a latching primitive (binary semaphore, event flag,
+ * futex sequence counter) rather than a bare condition variable.
+ *
+ * @param ctx       User context given to @ref m_cfifo_SetNotifyHooks.
+ * @param watermark Watermark to wait for.
+ * @param timeout   Timeout in hook-defined ticks, or @ref M_CFIFO_WAIT_FOREVER.
+ *
+ * @retval true  Signaled.
+ * @retval false Timed out.
+ */
+typedef bool (*m_cfifo_tWaitHook)(void* ctx, m_cfifo_tWatermark watermark, uint32_t timeout);
+
+
+struct _cfifo;
+
+#if M_CFIFO_TRACE
+/**
+ * @brief Operation codes of @ref m_cfifo_tTraceEvent.
+ *
+ * The cascaded functions add @ref M_CFIFO_TRACE_CASCADED. The segment codes
+ * are only written with @ref M_CFIFO_TRACE set to 2.
+ */
+typedef enum
+{
+  M_CFIFO_TRACE_PUSH = 0,
+  M_CFIFO_TRACE_POP,
+  M_CFIFO_TRACE_PUSH_N,
+  M_CFIFO_TRACE_POP_N,
+  M_CFIFO_TRACE_PUSH_RECORD,
+  M_CFIFO_TRACE_POP_RECORD,
+  M_CFIFO_TRACE_PUSH_MSG,
+  M_CFIFO_TRACE_POP_MSG,
+  M_CFIFO_TRACE_COMMIT_WRITE,
+  M_CFIFO_TRACE_RELEASE_READ,
+  M_CFIFO_TRACE_TRANSFER,
+  M_CFIFO_TRACE_SEGMENT_WRITE,
+  M_CFIFO_TRACE_SEGMENT_READ
+}m_cfifo_tTraceOp;
+
+/**
+ * @brief Clock of the trace events, e.g. a free-running cycle counter.
+ *
+ * @return Current time in arbitrary ticks; differences are taken modulo 2^32.
+ */
+typedef uint32_t (*m_cfifo_tTraceClock)(void);
+
+/**
+ * @brief Binary trace event, 16 bytes in the byte order of the target.
+ *
+ * - `timestamp`: clock at the start of the call, before the FIFO lock.
+ * - `duration`: ticks from `timestamp` until the event was written.
+ * - `instance`: `trace_id` of the FIFO the call was made on (see
+ *   @ref m_cfifo_SetTraceId).
+ * - `op`: @ref m_cfifo_tTraceOp, plus @ref M_CFIFO_TRACE_CASCADED.
+ * - `segment`: `segment_index` of the FIFO, or of the visited segment for
+ *   the segment codes, saturated at 255.
+ * - `bytes`: bytes moved (records and messages: payload), saturated.
+ * - `usage`: stored bytes afterwards (the total of an attached cascade for
+ *   cascaded calls, the segment's own for the segment codes), saturated.
+ */
+typedef struct
+{
+  uint32_t timestamp;
+  uint32_t duration;
+  uint16_t instance;
+  uint8_t  op;
+  uint8_t  segment;
+  uint16_t bytes;
+  uint16_t usage;
+}m_cfifo_tTraceEvent;
+#endif
+
+/**
+ * @brief Usage statistics of one FIFO, available with @ref M_CFIFO_STATS.
+ *
+ * - `peak_usage`: highest number of bytes stored at once by pushes
+ *   (@ref m_cfifo_This_SetFull and buffer configuration are not counted).
+ * - `push_fail`: pushes that could not store all bytes because the FIFO
+ *   was full (a cascaded push counts once per full segment it tried).
+ * - `pop_fail`: pops that returned nothing because the FIFO was empty
+ *   (likewise once per empty segment a cascaded pop tried).
+ * - `bytes_in` / `bytes_out`: bytes written and removed, including bytes
+ *   discarded by the overwrite policy or skipped.
+ *
+ * The counters wrap around on overflow.
+ */
+typedef struct
+{
+  m_cfifo_tIndex peak_usage;
+  uint32_t push_fail;
+  uint32_t pop_fail;
+  m_cfifo_tTotal bytes_in;
+  m_cfifo_tTotal bytes_out;
+}m_cfifo_tStats;
+
+/**
+ * @brief Pool of equal-sized segments shared by pooled cascades.
+ *
+ * Created with @ref m_cfifo_InitPool from an array of FIFO descriptors and
+ * one arena of `segment_count * block_size` bytes. Unused descriptors are
+ * linked through their `next` pointer in `free_list`.
+ *
+ * @warning The pool has no lock of its own. Cascades sharing a pool must
+ *          be used under a common lock (e.g. a global @ref M_CFIFO_LOCK).
+ */
+typedef struct _cfifo_pool
+{
+  struct _cfifo* segments;
+  struct _cfifo* free_list;
+
+  m_cfifo_tIndex block_size;
+  uint16_t segment_count;
+  uint16_t free_count;
+}m_cfifo_tPool;
+
+/**
+ * @brief One copy of the persistent FIFO state.
+ *
+ * `check` is a checksum over all preceding fields. `index_size` and
+ * `free_running` record the build options the copy was written with.
+ * `used_count` is stored in both index modes so that the layout only
+ * depends on @ref M_CFIFO_INDEX_WIDTH.
+ */
+typedef struct
+{
+  uint32_t magic;
+  uint8_t version;
+  uint8_t index_size;
+  uint8_t free_running;
+  uint8_t sequence;
+  m_cfifo_tIndex buffer_size;
+  m_cfifo_tIndex rdPtr;
+  m_cfifo_tIndex wrPtr;
+  m_cfifo_tIndex used_count;
+  uint32_t check;
+}m_cfifo_tPersistCopy;
+
+/**
+ * @brief Persistent FIFO header, kept next to the buffer in retained memory.
+ *
+ * Updates alternate between the two copies and bump `sequence`, so a reset
+ * in the middle of an update leaves the previous copy intact. Recovery
+ * takes the newer of the valid copies.
+ */
+typedef struct _cfifo_persist
+{
+  m_cfifo_tPersistCopy copy[2];
+}m_cfifo_tPersist;
+
+/**
+ * @brief Optional descriptor caching aggregate state of a cascade.
+ *
+ * Once attached with @ref m_cfifo_AttachCascade, every FIFO of the chain
+ * keeps the running totals up to date on each push, pop, clear and
+ * configuration, so @ref m_cfifo_All_GetUsage, @ref m_cfifo_All_GetSize,
+ * @ref m_cfifo_All_IsEmpty and @ref m_cfifo_All_IsFull called on `head`
+ * complete in constant time.
+ *
+ * The descriptor also tracks a write cursor (every segment before
+ * `wr_segment` is full) and a read cursor (every segment before
+ * `rd_segment` is empty). Cascaded push and pop calls on `head` start their
+ * walk at the cursor, so the steady-state cost is independent of the chain
+ * length. A NULL cursor means that all segments are full or empty.
+ *
+ * With @ref M_CFIFO_POOL, `pool` is the segment source set with
+ * @ref m_cfifo_AttachPool (NULL for a static cascade).
+ *
+ * @warning Call @ref m_cfifo_AttachCascade again after relinking FIFOs
+ *          other than appending with @ref m_cfifo_CascadeAsNextBuffer.
+ */
+typedef struct _cfifo_cascade
+{
+  struct _cfifo* head;
+  struct _cfifo* wr_segment;
+  struct _cfifo* rd_segment;
+
+  m_cfifo_tTotal size_total;
+  m_cfifo_tTotal used_total;
+
+#if M_CFIFO_POOL
+  m_cfifo_tPool* pool;
+#endif
+}m_cfifo_tCascade;
+
+
 /**
  * @brief Control structure for a circular FIFO byte buffer.
  *
@@ -66,22 +597,72 @@ typedef enum
  * Usage requirements:
  * - Must be initialized using @ref m_cfifo_InitBuffer before use.
  * - A working data buffer may be assigned with @ref m_cfifo_ConfigBuffer.
- * - If no buffer is configured, pop operations return `dummy_byte`.
+ * - Without a buffer, the FIFO is a pattern source of `dummy_byte`
+ *   (see @ref m_cfifo_ConfigSource).
  *
  * The FIFO implements circular wrapping for both read and write indices.
+ * `index_mask` is `buffer_size - 1` for power-of-two sizes and 0 otherwise.
+ * `record_size` is the element size used by the record functions (1 for
+ * plain byte FIFOs, see @ref m_cfifo_ConfigRecordBuffer).
+ * `dropped_count` counts the bytes discarded by the overwrite policy
+ * (see @ref M_CFIFO_OVERWRITE).
+ * `persist` is the header the indices are mirrored into (see
+ * @ref M_CFIFO_PERSIST), or NULL.
+ * `trace_id` identifies the FIFO in trace events (see @ref M_CFIFO_TRACE).
  */
 typedef struct _cfifo
 {
   struct _cfifo* prev;
   struct _cfifo* next;
+  struct _cfifo_cascade* cascade;
+  uint16_t segment_index;
 
   uint8_t* buffer;
-  uint16_t buffer_size;
-  uint16_t used_count;
-  uint16_t rdPtr;
-  uint16_t wrPtr;
+  m_cfifo_tIndex buffer_size;
+  m_cfifo_tIndex index_mask;
+#if !M_CFIFO_FREE_RUNNING_INDEX
+  m_cfifo_tIndex used_count;
+#endif
+  m_cfifo_tIndex rdPtr;
+  m_cfifo_tIndex wrPtr;
+  m_cfifo_tIndex record_size;
   
   uint8_t dummy_byte;
+
+#if M_CFIFO_MIRROR
+  bool mirrored;
+#endif
+
+#if M_CFIFO_OVERWRITE
+  bool overwrite;
+  m_cfifo_tTotal dropped_count;
+#endif
+
+#if M_CFIFO_STATS
+  m_cfifo_tStats stats;
+#endif
+
+#if M_CFIFO_PERSIST
+  m_cfifo_tPersist* persist;
+#endif
+
+#if M_CFIFO_TRACE
+  uint16_t trace_id;
+#endif
+
+#if M_CFIFO_NOTIFY
+  m_cfifo_tSignalHook signal;
+  m_cfifo_tWaitHook wait;
+  void* notify_ctx;
+  m_cfifo_tIndex low_watermark;
+  m_cfifo_tIndex high_watermark;
+#endif
+
+#if M_CFIFO_INSTANCE_LOCK
+  m_cfifo_tLockHook lock;
+  m_cfifo_tLockHook unlock;
+  void* lock_ctx;
+#endif
 }m_cfifo_tCFifo;
 
 
@@ -101,56 +682,433 @@ typedef struct _cfifo
  * to zero. After initialization, the FIFO is unconfigured and must be
  * assigned a valid memory buffer using @ref m_cfifo_ConfigBuffer before use.
  *
- * @param cfifo Pointer to the FIFO instance to initialize.
+ * @param cfifo Pointer to the FIFO instance to initialize.
+ */
+void m_cfifo_InitBuffer(m_cfifo_tCFifo* cfifo);
+
+
+/**
+ * @brief Links the given FIFO as the next FIFO in a cascade chain.
+ *
+ * Cascading allows operations like push, pop, clear, and state queries
+ * to propagate through multiple FIFO buffers automatically.
+ *
+ * @warning This does not configure or initialize the buffer contents.
+ *
+ * @param cfifo       Pointer to the current FIFO.
+ * @param cfifo_next  Pointer to the next FIFO to attach.
+ */
+void m_cfifo_CascadeAsNextBuffer(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* cfifo_next);
+
+
+/**
+ * @brief Attaches a cascade descriptor to a chain of FIFOs.
+ *
+ * Walks the chain starting at @p head (via @ref next), links every FIFO
+ * to @p cascade and computes the initial totals.
+ *
+ * @param cascade Pointer to the descriptor to initialize.
+ * @param head    Pointer to the first FIFO of the cascade.
+ */
+void m_cfifo_AttachCascade(m_cfifo_tCascade* cascade, m_cfifo_tCFifo* head);
+
+
+/**
+ * @brief Detaches a cascade descriptor from its chain of FIFOs.
+ *
+ * Afterwards the `All_*` queries walk the chain again.
+ *
+ * @param cascade Pointer to the attached descriptor.
+ */
+void m_cfifo_DetachCascade(m_cfifo_tCascade* cascade);
+
+
+#if M_CFIFO_POOL
+/**
+ * @brief Initializes a segment pool.
+ *
+ * Every descriptor is initialized, assigned its block of the arena and
+ * cleared, then put on the free list.
+ *
+ * @param pool          Pointer to the pool to initialize.
+ * @param segments      Array of @p segment_count FIFO descriptors.
+ * @param arena         Memory area of `segment_count * block_size` bytes.
+ * @param segment_count Number of segments.
+ * @param block_size    Size of one segment in bytes.
+ */
+void m_cfifo_InitPool(m_cfifo_tPool* pool, m_cfifo_tCFifo* segments, void* arena, uint16_t segment_count, m_cfifo_tIndex block_size);
+
+
+/**
+ * @brief Lets an attached cascade grow and shrink with pool segments.
+ *
+ * Afterwards, cascaded pushes on the cascade head take a segment from
+ * @p pool and append it when the last segment cannot take the data, and
+ * cascaded pops hand empty pool segments at the front of the chain back
+ * to the pool. The last segment is kept to avoid re-linking on every
+ * small burst. Segments not taken from @p pool (e.g. a statically
+ * configured head) are never released. A head without a buffer is a
+ * valid, empty anchor.
+ *
+ * Only the `All_*` push and pop functions called on the head and
+ * @ref m_cfifo_Transfer into the head change the chain. Size and full
+ * queries describe the segments linked at the time.
+ *
+ * @note @ref m_cfifo_AttachCascade detaches the pool; call this function
+ *       after it. Appending with @ref m_cfifo_CascadeAsNextBuffer keeps it.
+ *
+ * @param cascade Pointer to an attached cascade descriptor.
+ * @param pool    Pointer to an initialized pool, or NULL to detach.
+ */
+void m_cfifo_AttachPool(m_cfifo_tCascade* cascade, m_cfifo_tPool* pool);
+
+
+/**
+ * @brief Returns the number of unused segments in a pool.
+ *
+ * @param pool Pointer to the pool.
+ * @return Number of segments on the free list.
+ */
+uint16_t m_cfifo_GetPoolFree(m_cfifo_tPool* pool);
+#endif
+
+
+/**
+ * @brief Assigns a data buffer and size to the FIFO.
+ *
+ * This function sets the storage buffer for the FIFO. After configuration,
+ * the FIFO is set to a full state, meaning all positions are marked as used.
+ *
+ * @note Passing NULL as buffer disables storage: the FIFO becomes a pattern
+ *       source of @p buffer_size dummy bytes (see @ref m_cfifo_ConfigSource).
+ *       @ref M_CFIFO_INDEX_MAX marks the endless source, so such a size is
+ *       clamped to `M_CFIFO_INDEX_MAX - 1`.
+ * @note A power-of-two @p buffer_size enables mask-based index wrapping.
+ *
+ * @param cfifo        Pointer to the FIFO instance.
+ * @param buffer       Pointer to a memory area for FIFO data.
+ * @param buffer_size  Size of the buffer in bytes.
+ */
+void m_cfifo_ConfigBuffer(m_cfifo_tCFifo* cfifo, const void* buffer, m_cfifo_tIndex buffer_size);
+
+
+#if M_CFIFO_MIRROR
+/**
+ * @brief Assigns a mirrored data buffer to the FIFO.
+ *
+ * Like @ref m_cfifo_ConfigBuffer, but @p buffer must provide
+ * `2 * buffer_size` addressable bytes where the second half aliases the
+ * first, e.g. from @ref m_cfifo_Mirror_Alloc. Reads and writes then run
+ * past the end of the buffer instead of wrapping:
+ * @ref m_cfifo_This_AcquireRead and @ref m_cfifo_This_AcquireWrite return
+ * all stored or free bytes as one span, and bulk copies never split.
+ *
+ * A later @ref m_cfifo_ConfigBuffer drops the mirrored mode; the mapping
+ * itself is owned by the caller.
+ *
+ * @param cfifo        Pointer to the FIFO instance.
+ * @param buffer       Pointer to the start of the double mapping.
+ * @param buffer_size  Size of one mapping in bytes.
+ */
+void m_cfifo_ConfigMirrorBuffer(m_cfifo_tCFifo* cfifo, const void* buffer, m_cfifo_tIndex buffer_size);
+#endif
+
+
+/**
+ * @brief Assigns a data buffer organized as fixed-size records.
+ *
+ * Configures the FIFO to hold @p record_count elements of @p record_size
+ * bytes each. Records are moved as a whole by @ref m_cfifo_This_PushRecord
+ * and @ref m_cfifo_This_PopRecord with a single space check, copy and
+ * counter update, and no record is ever split across the wrap point.
+ * Like @ref m_cfifo_ConfigBuffer, the FIFO is set to a full state.
+ *
+ * @note The record count is reduced if the total size exceeds
+ *       @ref M_CFIFO_INDEX_MAX bytes.
+ * @note With @ref M_CFIFO_FREE_RUNNING_INDEX the total size is rounded down
+ *       to a power of two; use a power-of-two @p record_size to keep records
+ *       unsplit. Records are still copied correctly otherwise.
+ * @warning Do not mix byte and record operations on the same FIFO.
+ *
+ * @param cfifo        Pointer to the FIFO instance.
+ * @param buffer       Pointer to a memory area of `record_count * record_size` bytes.
+ * @param record_count Capacity in records.
+ * @param record_size  Size of one record in bytes (at least 1).
+ */
+void m_cfifo_ConfigRecordBuffer(m_cfifo_tCFifo* cfifo, const void* buffer, m_cfifo_tIndex record_count, m_cfifo_tIndex record_size);
+
+
+#if M_CFIFO_PERSIST
+/**
+ * @brief Assigns a data buffer with a persistent header and recovers its content.
+ *
+ * If @p persist holds a valid copy for a buffer of the same size, the
+ * indices are restored from the newest one and the stored bytes are
+ * available again. Otherwise the FIFO starts empty and the header is
+ * initialized. From then on every index update is written to the header.
+ *
+ * Call after @ref m_cfifo_InitBuffer (and before attaching a cascade
+ * descriptor, whose totals are computed from the recovered segments).
+ * Configuring the FIFO with any other `Config*` function detaches the
+ * header.
+ *
+ * @note A push stores the data before the indices, so a reset never
+ *       exposes unwritten bytes. A pop that is interrupted before its index
+ *       update returns the same bytes again after recovery.
+ *
+ * @param cfifo       Pointer to the FIFO instance.
+ * @param persist     Header in memory that survives resets.
+ * @param buffer      Pointer to the data buffer, in the same kind of memory.
+ * @param buffer_size Size of the buffer in bytes.
+ *
+ * @retval true  Content recovered from the header.
+ * @retval false No valid header; the FIFO was set empty.
+ */
+bool m_cfifo_ConfigPersistBuffer(m_cfifo_tCFifo* cfifo, m_cfifo_tPersist* persist, const void* buffer, m_cfifo_tIndex buffer_size);
+#endif
+
+
+/**
+ * @brief Sets the dummy byte served by a pattern source.
+ *
+ * Only a source set up with @ref m_cfifo_ConfigSource or
+ * @ref m_cfifo_ConfigBuffer with a NULL buffer and a size > 0 returns the
+ * dummy byte. An unconfigured FIFO (after @ref m_cfifo_InitBuffer, or
+ * `ConfigBuffer(cfifo, NULL, 0)`) stays empty and its pops fail.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Dummy byte to return on pop operations.
+ */
+void m_cfifo_SetDummyByte(m_cfifo_tCFifo* cfifo, uint8_t data);
+
+
+/**
+ * @brief Configures the FIFO as a pattern source.
+ *
+ * The FIFO has no buffer and serves @p pattern instead of stored data,
+ * e.g. idle fill bytes for an SPI TX DMA. The pop, peek, skip and
+ * transfer paths fill their output with memset, and
+ * @ref m_cfifo_This_AcquireRead returns a fixed-address region.
+ *
+ * - @p count > 0: serves @p count bytes, then reports empty. Refill it with
+ *   @ref m_cfifo_This_SetFull. @ref M_CFIFO_INDEX_MAX is reserved for the
+ *   endless source and is clamped to `M_CFIFO_INDEX_MAX - 1`.
+ * - @p count == 0: endless source. The usage stays at
+ *   @ref M_CFIFO_INDEX_MAX and reads update neither the indices nor the
+ *   cascade totals, statistics or notifications.
+ *
+ * Pushes always fail. @ref m_cfifo_This_Clear stops the stream.
+ *
+ * @param cfifo   Pointer to the FIFO instance.
+ * @param pattern Byte value to serve (stored as `dummy_byte`).
+ * @param count   Number of bytes to serve, or 0 for an endless source.
+ */
+void m_cfifo_ConfigSource(m_cfifo_tCFifo* cfifo, uint8_t pattern, m_cfifo_tIndex count);
+
+
+#if M_CFIFO_INSTANCE_LOCK
+/**
+ * @brief Assigns the lock hooks of a FIFO instance.
+ *
+ * The hooks are called by every public function operating on this FIFO.
+ * Cascaded functions only call the hooks of the first FIFO of the chain,
+ * so all segments of a cascade should be accessed through the same head.
+ *
+ * @param cfifo  Pointer to the FIFO instance.
+ * @param lock   Function taking the lock (may be NULL).
+ * @param unlock Function releasing the lock (may be NULL).
+ * @param ctx    User context passed to both hooks (e.g. a mutex handle).
+ */
+void m_cfifo_SetLockHooks(m_cfifo_tCFifo* cfifo, m_cfifo_tLockHook lock, m_cfifo_tLockHook unlock, void* ctx);
+#endif
+
+
+#if M_CFIFO_TRACE
+/**
+ * @brief Attaches the ring that receives the trace events of all FIFOs.
+ *
+ * The ring is an ordinary FIFO, preferably configured with
+ * @ref m_cfifo_ConfigRecordBuffer for `sizeof(m_cfifo_tTraceEvent)`
+ * records, and is drained with the usual pop functions while tracing.
+ * It is lossy: an event that does not fit is discarded and counted (see
+ * @ref m_cfifo_TraceGetDropped), or replaces the oldest one if the ring
+ * uses the overwrite policy. Calls on the ring itself are not traced.
+ *
+ * @warning Must not be called while any traced FIFO is in use.
+ *
+ * @param ring  Pointer to the trace ring, or NULL to stop tracing.
+ * @param clock Timestamp source (may be NULL for all-zero timestamps).
+ */
+void m_cfifo_TraceAttach(m_cfifo_tCFifo* ring, m_cfifo_tTraceClock clock);
+
+
+/**
+ * @brief Returns the number of trace events discarded because the ring
+ *        was full.
+ *
+ * @return Discarded events since @ref m_cfifo_TraceAttach.
+ */
+m_cfifo_tTotal m_cfifo_TraceGetDropped(void);
+
+
+/**
+ * @brief Assigns the instance id written into the trace events of a FIFO.
+ *
+ * The id is 0 after @ref m_cfifo_InitBuffer.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param id    Instance id.
+ */
+void m_cfifo_SetTraceId(m_cfifo_tCFifo* cfifo, uint16_t id);
+#endif
+
+
+#if M_CFIFO_OVERWRITE
+/**
+ * @brief Selects the overwrite-oldest policy of a FIFO instance.
+ *
+ * When enabled, @ref m_cfifo_This_Push, @ref m_cfifo_This_PushN and
+ * @ref m_cfifo_This_PushRecord make room by discarding the oldest bytes or
+ * records, and @ref m_cfifo_This_PushMsg discards the oldest whole messages.
+ * Pushes then only fail on an unconfigured FIFO or a message larger than
+ * the buffer. Cascaded `All_*` pushes are not affected.
+ *
+ * The dropped-bytes counter is reset by every call.
+ *
+ * @param cfifo  Pointer to the FIFO instance.
+ * @param enable true to overwrite the oldest data, false to reject pushes
+ *               on a full FIFO (default).
+ */
+void m_cfifo_SetOverwrite(m_cfifo_tCFifo* cfifo, bool enable);
+
+
+/**
+ * @brief Returns the number of bytes discarded by the overwrite policy.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ *
+ * @return Bytes dropped since @ref m_cfifo_SetOverwrite, including the
+ *         leading bytes of a bulk push larger than the buffer.
+ */
+m_cfifo_tTotal m_cfifo_This_GetDropped(m_cfifo_tCFifo* cfifo);
+#endif
+
+
+#if M_CFIFO_STATS
+/**
+ * @brief Copies the usage statistics of a FIFO instance.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param stats Output for the statistics.
+ */
+void m_cfifo_GetStats(m_cfifo_tCFifo* cfifo, m_cfifo_tStats* stats);
+
+
+/**
+ * @brief Resets the usage statistics of a FIFO instance.
+ *
+ * All counters are cleared and the peak usage restarts at the current usage.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ */
+void m_cfifo_ResetStats(m_cfifo_tCFifo* cfifo);
+
+
+/**
+ * @brief Copies the statistics of every segment of a cascade.
+ *
+ * Walks the chain via @ref next and stores one entry per segment, so
+ * `stats[i]` belongs to the i-th FIFO after @p cfifo. Segments whose
+ * `push_fail` grows are the ones that overflow.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param stats Output array.
+ * @param count Number of entries in @p stats.
+ *
+ * @return Number of entries written.
+ */
+uint16_t m_cfifo_All_GetStats(m_cfifo_tCFifo* cfifo, m_cfifo_tStats* stats, uint16_t count);
+
+
+/**
+ * @brief Resets the statistics of every segment of a cascade.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ */
+void m_cfifo_All_ResetStats(m_cfifo_tCFifo* cfifo);
+#endif
+
+
+#if M_CFIFO_NOTIFY
+/**
+ * @brief Assigns the notification hooks of a FIFO instance.
+ *
+ * @param cfifo  Pointer to the FIFO instance.
+ * @param signal Hook called on watermark crossings (may be NULL).
+ * @param wait   Hook used by the blocking functions (may be NULL to never block).
+ * @param ctx    User context passed to both hooks.
  */
-void m_cfifo_InitBuffer(m_cfifo_tCFifo* cfifo);
+void m_cfifo_SetNotifyHooks(m_cfifo_tCFifo* cfifo, m_cfifo_tSignalHook signal, m_cfifo_tWaitHook wait, void* ctx);
 
 
 /**
- * @brief Links the given FIFO as the next FIFO in a cascade chain.
+ * @brief Sets the watermarks of a FIFO instance.
  *
- * Cascading allows operations like push, pop, clear, and state queries
- * to propagate through multiple FIFO buffers automatically.
- *
- * @warning This does not configure or initialize the buffer contents.
+ * The high watermark is signaled when the usage rises from below @p high to
+ * at least @p high; the low watermark when it falls from above @p low to at
+ * most @p low. The defaults (high 1, low `buffer_size - 1`) signal the
+ * empty → non-empty and full → non-full transitions. A higher @p high or a
+ * lower @p low batches wakeups at the cost of latency.
  *
- * @param cfifo       Pointer to the current FIFO.
- * @param cfifo_next  Pointer to the next FIFO to attach.
+ * @param cfifo Pointer to the FIFO instance.
+ * @param low   Low watermark in bytes (clamped to `buffer_size - 1`).
+ * @param high  High watermark in bytes (at least 1).
  */
-void m_cfifo_CascadeAsNextBuffer(m_cfifo_tCFifo* cfifo, m_cfifo_tCFifo* cfifo_next);
+void m_cfifo_SetWatermarks(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex low, m_cfifo_tIndex high);
 
 
 /**
- * @brief Assigns a data buffer and size to the FIFO.
+ * @brief Pops a block of bytes, waiting while the FIFO is empty.
  *
- * This function sets the storage buffer for the FIFO. After configuration,
- * the FIFO is set to a full state, meaning all positions are marked as used.
+ * Behaves like @ref m_cfifo_This_PopN if data is available. Otherwise the
+ * wait hook is called for the high watermark and the pop is retried; after
+ * a timeout the pop is retried once more, so data below the high watermark
+ * is still delivered.
  *
- * @note Passing NULL as buffer disables storage and enables dummy-byte output.
+ * @param cfifo   Pointer to the FIFO instance.
+ * @param data    Output buffer for the popped bytes (may be NULL to discard).
+ * @param len     Maximum number of bytes to pop.
+ * @param timeout Timeout per wait in hook-defined ticks, 0 to not wait, or
+ *                @ref M_CFIFO_WAIT_FOREVER.
  *
- * @param cfifo        Pointer to the FIFO instance.
- * @param buffer       Pointer to a memory area for FIFO data.
- * @param buffer_size  Size of the buffer in bytes.
+ * @return Number of bytes popped (0 on timeout).
  */
-void m_cfifo_ConfigBuffer(m_cfifo_tCFifo* cfifo, const void* buffer, uint16_t buffer_size);
+m_cfifo_tIndex m_cfifo_PopWait(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len, uint32_t timeout);
 
 
 /**
- * @brief Sets the dummy byte used when no real buffer is configured.
+ * @brief Pushes a block of bytes, waiting while the FIFO is full.
  *
- * When popping from a FIFO without an assigned buffer, the dummy byte
- * will be returned instead of real data.
+ * Pushes with @ref m_cfifo_This_PushN and waits for the low watermark until
+ * all bytes are stored or a wait times out (followed by one last attempt).
  *
- * @param cfifo Pointer to the FIFO instance.
- * @param data  Dummy byte to return on pop operations.
+ * @param cfifo   Pointer to the FIFO instance.
+ * @param data    Pointer to the bytes to push.
+ * @param len     Number of bytes to push.
+ * @param timeout Timeout per wait in hook-defined ticks, 0 to not wait, or
+ *                @ref M_CFIFO_WAIT_FOREVER.
+ *
+ * @return Number of bytes pushed (less than @p len on timeout).
  */
-void m_cfifo_SetDummyByte(m_cfifo_tCFifo* cfifo, uint8_t data);
+m_cfifo_tIndex m_cfifo_PushWait(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len, uint32_t timeout);
+#endif
 
 
 /**
  * @brief Pushes a single byte into this FIFO.
  *
- * Writes the given byte to the FIFO if space is available.
+ * Writes the given byte to the FIFO if space is available. With the
+ * overwrite policy enabled, a full FIFO drops its oldest byte first.
  *
  * @param cfifo Pointer to the FIFO instance.
  * @param data  Byte value to push.
@@ -176,6 +1134,72 @@ bool m_cfifo_This_Push(m_cfifo_tCFifo* cfifo, uint8_t data);
 bool m_cfifo_All_Push(m_cfifo_tCFifo* cfifo, uint8_t data);
 
 
+/**
+ * @brief Pushes a block of bytes into this FIFO.
+ *
+ * Copies as many bytes as fit into the free space of the FIFO. The data is
+ * written with at most two memory copies (up to the wrap point and the
+ * remainder) and the usage counter is updated once per call.
+ *
+ * With the overwrite policy enabled, the oldest bytes are dropped to make
+ * room and all @p len bytes are accepted; only the last `buffer_size`
+ * bytes of a larger block are kept.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Pointer to the bytes to push.
+ * @param len   Number of bytes to push.
+ *
+ * @return Number of bytes actually pushed (0 if full or unconfigured).
+ */
+m_cfifo_tIndex m_cfifo_This_PushN(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Pushes a block of bytes into this FIFO or its cascaded successors.
+ *
+ * Behaves like repeated calls of @ref m_cfifo_All_Push: each FIFO in the
+ * chain (via @ref next) is filled with one bulk copy before the remaining
+ * bytes move on to the next FIFO.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param data  Pointer to the bytes to push.
+ * @param len   Number of bytes to push.
+ *
+ * @return Number of bytes actually pushed across all FIFOs.
+ */
+m_cfifo_tIndex m_cfifo_All_PushN(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Pushes one record into this FIFO.
+ *
+ * With the overwrite policy enabled, the oldest whole record is dropped
+ * when the FIFO is full.
+ *
+ * @param cfifo  Pointer to a FIFO configured with @ref m_cfifo_ConfigRecordBuffer.
+ * @param record Pointer to `record_size` bytes to push.
+ *
+ * @retval true  Record successfully pushed.
+ * @retval false Not enough space for a whole record, or FIFO unconfigured.
+ */
+bool m_cfifo_This_PushRecord(m_cfifo_tCFifo* cfifo, const void* record);
+
+
+/**
+ * @brief Pushes one record into this FIFO or a cascaded successor.
+ *
+ * The record is stored as a whole in the first FIFO of the chain that has
+ * space for it.
+ *
+ * @param cfifo  Pointer to the first FIFO in the cascade.
+ * @param record Pointer to `record_size` bytes to push.
+ *
+ * @retval true  Record successfully pushed.
+ * @retval false No FIFO had space for a whole record.
+ */
+bool m_cfifo_All_PushRecord(m_cfifo_tCFifo* cfifo, const void* record);
+
+
 /**
  * @brief Pops a single byte from this FIFO.
  *
@@ -190,6 +1214,21 @@ bool m_cfifo_All_Push(m_cfifo_tCFifo* cfifo, uint8_t data);
 bool m_cfifo_This_Pop(m_cfifo_tCFifo* cfifo, uint8_t* data);
 
 
+/**
+ * @brief Pops a block of bytes from this FIFO.
+ *
+ * Copies up to @p len of the oldest bytes out of the FIFO with at most two
+ * memory copies and updates the usage counter once per call.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Output buffer for the popped bytes (may be NULL to discard).
+ * @param len   Maximum number of bytes to pop.
+ *
+ * @return Number of bytes actually popped (0 if empty).
+ */
+m_cfifo_tIndex m_cfifo_This_PopN(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len);
+
+
 /**
  * @brief Pops a byte from this FIFO or any cascaded successor.
  *
@@ -205,6 +1244,379 @@ bool m_cfifo_This_Pop(m_cfifo_tCFifo* cfifo, uint8_t* data);
 bool m_cfifo_All_Pop(m_cfifo_tCFifo* cfifo, uint8_t* data);
 
 
+/**
+ * @brief Pops a block of bytes from this FIFO or its cascaded successors.
+ *
+ * Behaves like repeated calls of @ref m_cfifo_All_Pop: each FIFO in the
+ * chain is drained with one bulk copy before continuing with the next FIFO.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param data  Output buffer for the popped bytes (may be NULL to discard).
+ * @param len   Maximum number of bytes to pop.
+ *
+ * @return Number of bytes actually popped across all FIFOs.
+ */
+m_cfifo_tIndex m_cfifo_All_PopN(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len);
+
+
+#if M_CFIFO_CRC
+/**
+ * @brief Pushes a block of bytes and adds them to a running CRC.
+ *
+ * Like @ref m_cfifo_This_PushN; @p crc is updated over the bytes taken from
+ * @p data (the returned count) in the same pass that copies them.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Source bytes.
+ * @param len   Number of bytes to push.
+ * @param crc   Running CRC state.
+ *
+ * @return Number of bytes pushed.
+ */
+m_cfifo_tIndex m_cfifo_This_PushNCrc(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len, m_cfifo_tCrc* crc);
+
+
+/**
+ * @brief Pushes a block of bytes into a cascade and adds them to a running CRC.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param data  Source bytes.
+ * @param len   Number of bytes to push.
+ * @param crc   Running CRC state.
+ *
+ * @return Number of bytes pushed across all FIFOs.
+ */
+m_cfifo_tIndex m_cfifo_All_PushNCrc(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len, m_cfifo_tCrc* crc);
+
+
+/**
+ * @brief Pops a block of bytes and adds them to a running CRC.
+ *
+ * Like @ref m_cfifo_This_PopN; @p crc is updated over the popped bytes
+ * while they are copied out of the buffer. With @p data NULL the bytes are
+ * only checked and discarded.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Output buffer (may be NULL to discard).
+ * @param len   Maximum number of bytes to pop.
+ * @param crc   Running CRC state.
+ *
+ * @return Number of bytes popped.
+ */
+m_cfifo_tIndex m_cfifo_This_PopNCrc(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len, m_cfifo_tCrc* crc);
+
+
+/**
+ * @brief Pops a block of bytes from a cascade and adds them to a running CRC.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param data  Output buffer (may be NULL to discard).
+ * @param len   Maximum number of bytes to pop.
+ * @param crc   Running CRC state.
+ *
+ * @return Number of bytes popped across all FIFOs.
+ */
+m_cfifo_tIndex m_cfifo_All_PopNCrc(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex len, m_cfifo_tCrc* crc);
+#endif
+
+
+/**
+ * @brief Copies stored bytes without consuming them.
+ *
+ * Reads up to @p len bytes starting @p offset bytes after the read pointer,
+ * handling the wrap point. The FIFO state is not modified.
+ *
+ * @param cfifo  Pointer to the FIFO instance.
+ * @param offset Number of stored bytes to skip before copying.
+ * @param data   Output buffer for the copied bytes.
+ * @param len    Maximum number of bytes to copy.
+ *
+ * @return Number of bytes copied (0 if @p offset is beyond the stored data).
+ */
+m_cfifo_tIndex m_cfifo_This_Peek(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex offset, void* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Copies stored bytes of a cascade without consuming them.
+ *
+ * The stored data of all FIFOs reachable through @ref next is treated as one
+ * sequence in the order @ref m_cfifo_All_Pop would return it.
+ *
+ * @param cfifo  Pointer to the first FIFO in the cascade.
+ * @param offset Number of stored bytes to skip before copying.
+ * @param data   Output buffer for the copied bytes.
+ * @param len    Maximum number of bytes to copy.
+ *
+ * @return Number of bytes copied across all FIFOs.
+ */
+m_cfifo_tIndex m_cfifo_All_Peek(m_cfifo_tCFifo* cfifo, m_cfifo_tTotal offset, void* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Discards stored bytes from this FIFO.
+ *
+ * Advances the read pointer without copying data.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Maximum number of bytes to discard.
+ *
+ * @return Number of bytes discarded.
+ */
+m_cfifo_tIndex m_cfifo_This_Skip(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Discards stored bytes from a cascade.
+ *
+ * Equivalent to @ref m_cfifo_All_PopN with a NULL output buffer.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param len   Maximum number of bytes to discard.
+ *
+ * @return Number of bytes discarded across all FIFOs.
+ */
+m_cfifo_tIndex m_cfifo_All_Skip(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Finds the first occurrence of a byte in the stored data.
+ *
+ * Scans at most @p max stored bytes from the read pointer on, crossing the
+ * wrap point, without consuming anything. The offset of a delimiter plus
+ * one is the length to pass to @ref m_cfifo_This_PopN to pull a whole line
+ * or frame at once.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param byte  Byte value to search for.
+ * @param max   Maximum number of stored bytes to scan.
+ *
+ * @return Offset of the byte from the read pointer, or @ref M_CFIFO_NOT_FOUND.
+ */
+m_cfifo_tIndex m_cfifo_This_Find(m_cfifo_tCFifo* cfifo, uint8_t byte, m_cfifo_tIndex max);
+
+
+/**
+ * @brief Finds the first occurrence of a byte in the stored data of a cascade.
+ *
+ * Like @ref m_cfifo_This_Find, with the stored data of all FIFOs reachable
+ * through @ref next treated as one sequence in the order
+ * @ref m_cfifo_All_Pop would return it.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param byte  Byte value to search for.
+ * @param max   Maximum number of stored bytes to scan across all FIFOs.
+ *
+ * @return Offset of the byte in the cascade, or @ref M_CFIFO_NOT_FOUND.
+ */
+m_cfifo_tIndex m_cfifo_All_Find(m_cfifo_tCFifo* cfifo, uint8_t byte, m_cfifo_tIndex max);
+
+
+/**
+ * @brief Moves stored bytes from one FIFO into another FIFO or cascade.
+ *
+ * Copies directly between the two ring buffers: each step copies the
+ * largest contiguous run that fits both the source read region and the
+ * destination write region, so a transfer needs at most three copies per
+ * destination segment instead of one pop and one push per byte. When a
+ * destination segment fills up, the transfer continues with its cascaded
+ * successor, like @ref m_cfifo_All_PushN.
+ *
+ * Bytes are moved as a plain byte stream, so a transfer limited by the
+ * free space or @p max_bytes may split a record or message. The overwrite
+ * policy of the destination is not applied.
+ *
+ * @note Takes the locks of @p src and @p dst once each: a lock shared by
+ *       both (see @ref M_CFIFO_SAME_LOCK) is taken once, and distinct locks
+ *       are always taken in address order, so concurrent transfers in
+ *       opposite directions do not deadlock.
+ *
+ * @warning @p src must not be @p dst or one of its cascaded successors;
+ *          such a transfer moves nothing and returns 0.
+ *
+ * @param dst       Pointer to the destination FIFO (first FIFO of a cascade).
+ * @param src       Pointer to the source FIFO.
+ * @param max_bytes Maximum number of bytes to move.
+ *
+ * @return Number of bytes moved (0 if @p src is part of the @p dst chain).
+ */
+m_cfifo_tIndex m_cfifo_Transfer(m_cfifo_tCFifo* dst, m_cfifo_tCFifo* src, m_cfifo_tIndex max_bytes);
+
+
+/**
+ * @brief Pushes one length-framed message into this FIFO.
+ *
+ * Writes a compact length header followed by the payload using the bulk
+ * copy path. The message is stored completely or not at all, so a full
+ * FIFO never leaves a partial frame behind. With the overwrite policy
+ * enabled, the oldest whole messages are dropped until the new one fits.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param data  Pointer to the payload.
+ * @param len   Payload length in bytes.
+ *
+ * @retval true  Message stored.
+ * @retval false Not enough space for header and payload, or FIFO unconfigured.
+ */
+bool m_cfifo_This_PushMsg(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Pushes one length-framed message into this FIFO or a cascaded successor.
+ *
+ * The framed message is stored as a whole in the first FIFO of the chain
+ * that has space for it; it is never split across segments.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param data  Pointer to the payload.
+ * @param len   Payload length in bytes.
+ *
+ * @retval true  Message stored.
+ * @retval false No FIFO had space for the whole message.
+ */
+bool m_cfifo_All_PushMsg(m_cfifo_tCFifo* cfifo, const void* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Returns the payload length of the oldest message without consuming it.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Output for the payload length.
+ *
+ * @retval true  A complete message is available.
+ * @retval false FIFO holds no complete message.
+ */
+bool m_cfifo_This_PeekMsgLen(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len);
+
+
+/**
+ * @brief Returns the payload length of the oldest message in a cascade.
+ *
+ * @param cfifo Pointer to the first FIFO in the cascade.
+ * @param len   Output for the payload length.
+ *
+ * @retval true  A complete message is available.
+ * @retval false No FIFO holds a complete message.
+ */
+bool m_cfifo_All_PeekMsgLen(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len);
+
+
+/**
+ * @brief Pops one whole length-framed message from this FIFO.
+ *
+ * If the payload does not fit into @p max_len bytes, nothing is consumed,
+ * @p len receives the required size and false is returned.
+ *
+ * @param cfifo   Pointer to the FIFO instance.
+ * @param data    Output buffer for the payload (may be NULL to discard).
+ * @param max_len Size of the output buffer (ignored if @p data is NULL).
+ * @param len     Output for the payload length (may be NULL).
+ *
+ * @retval true  Message popped.
+ * @retval false No complete message, or output buffer too small.
+ */
+bool m_cfifo_This_PopMsg(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex max_len, m_cfifo_tIndex* len);
+
+
+/**
+ * @brief Pops one whole length-framed message from this FIFO or a cascaded successor.
+ *
+ * @param cfifo   Pointer to the first FIFO in the cascade.
+ * @param data    Output buffer for the payload (may be NULL to discard).
+ * @param max_len Size of the output buffer (ignored if @p data is NULL).
+ * @param len     Output for the payload length (may be NULL).
+ *
+ * @retval true  Message popped.
+ * @retval false No complete message, or output buffer too small.
+ */
+bool m_cfifo_All_PopMsg(m_cfifo_tCFifo* cfifo, void* data, m_cfifo_tIndex max_len, m_cfifo_tIndex* len);
+
+
+/**
+ * @brief Returns the largest contiguous free region at the write pointer.
+ *
+ * Allows a DMA engine or a `read()` call to fill the FIFO in place. The
+ * region ends at the free space or at the wrap point, whichever comes first.
+ * The data becomes visible only after @ref m_cfifo_This_CommitWrite.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Output for the size of the region in bytes.
+ *
+ * @return Pointer to the start of the region, or NULL if the FIFO is full
+ *         or unconfigured (then @p len is 0).
+ */
+uint8_t* m_cfifo_This_AcquireWrite(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len);
+
+
+/**
+ * @brief Publishes bytes written into the region of @ref m_cfifo_This_AcquireWrite.
+ *
+ * Advances the write pointer by the number of bytes actually transferred.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Number of bytes written (clamped to the contiguous free region).
+ *
+ * @return Number of bytes committed.
+ */
+m_cfifo_tIndex m_cfifo_This_CommitWrite(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Returns the largest contiguous stored region at the read pointer.
+ *
+ * Allows a DMA engine or a `write()` call to drain the FIFO in place. The
+ * region ends at the stored data or at the wrap point, whichever comes first.
+ * The space is given back only after @ref m_cfifo_This_ReleaseRead.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Output for the size of the region in bytes.
+ *
+ * For a pattern source (see @ref m_cfifo_ConfigSource), the region is the
+ * single `dummy_byte` and @p len is the number of bytes available: program
+ * the DMA with a fixed (non-incrementing) source address.
+ *
+ * @return Pointer to the start of the region, or NULL if the FIFO is empty
+ *         (then @p len is 0).
+ */
+const uint8_t* m_cfifo_This_AcquireRead(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex* len);
+
+
+/**
+ * @brief Releases bytes consumed from the region of @ref m_cfifo_This_AcquireRead.
+ *
+ * Advances the read pointer by the number of bytes actually transferred.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @param len   Number of bytes consumed (clamped to the contiguous stored region).
+ *
+ * @return Number of bytes released.
+ */
+m_cfifo_tIndex m_cfifo_This_ReleaseRead(m_cfifo_tCFifo* cfifo, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Pops one record from this FIFO.
+ *
+ * @param cfifo  Pointer to a FIFO configured with @ref m_cfifo_ConfigRecordBuffer.
+ * @param record Output buffer of `record_size` bytes (may be NULL to discard).
+ *
+ * @retval true  Record successfully popped.
+ * @retval false FIFO holds no whole record.
+ */
+bool m_cfifo_This_PopRecord(m_cfifo_tCFifo* cfifo, void* record);
+
+
+/**
+ * @brief Pops one record from this FIFO or a cascaded successor.
+ *
+ * @param cfifo  Pointer to the first FIFO in the cascade.
+ * @param record Output buffer of `record_size` bytes (may be NULL to discard).
+ *
+ * @retval true  Record successfully popped.
+ * @retval false No FIFO held a whole record.
+ */
+bool m_cfifo_All_PopRecord(m_cfifo_tCFifo* cfifo, void* record);
+
+
 /**
  * @brief Clears all stored data in this FIFO.
  *
@@ -255,18 +1667,28 @@ void m_cfifo_All_SetFull(m_cfifo_tCFifo* cfifo, m_cfifo_tDirection direction);
  * @param cfifo Pointer to the FIFO instance.
  * @return Buffer size in bytes.
  */
-uint16_t m_cfifo_This_GetSize(m_cfifo_tCFifo* cfifo);
+m_cfifo_tIndex m_cfifo_This_GetSize(m_cfifo_tCFifo* cfifo);
+
+
+/**
+ * @brief Returns the capacity of this FIFO in records.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @return Number of records of `record_size` bytes that fit into the buffer.
+ */
+m_cfifo_tIndex m_cfifo_This_GetRecordCapacity(m_cfifo_tCFifo* cfifo);
 
 
 /**
  * @brief Returns the total size of all cascaded FIFOs.
  *
  * Adds the configured sizes of each FIFO reachable through @ref next.
+ * Constant time when @p cfifo is the head of an attached @ref m_cfifo_tCascade.
  *
  * @param cfifo Pointer to the first FIFO in the cascade.
  * @return Total size in bytes.
  */
-uint32_t m_cfifo_All_GetSize(m_cfifo_tCFifo* cfifo);
+m_cfifo_tTotal m_cfifo_All_GetSize(m_cfifo_tCFifo* cfifo);
 
 
 /**
@@ -275,16 +1697,27 @@ uint32_t m_cfifo_All_GetSize(m_cfifo_tCFifo* cfifo);
  * @param cfifo Pointer to the FIFO instance.
  * @return Number of stored bytes.
  */
-uint16_t m_cfifo_This_GetUsage(m_cfifo_tCFifo* cfifo);
+m_cfifo_tIndex m_cfifo_This_GetUsage(m_cfifo_tCFifo* cfifo);
+
+
+/**
+ * @brief Returns the number of whole records stored in this FIFO.
+ *
+ * @param cfifo Pointer to the FIFO instance.
+ * @return Number of stored records.
+ */
+m_cfifo_tIndex m_cfifo_This_GetRecordUsage(m_cfifo_tCFifo* cfifo);
 
 
 /**
  * @brief Returns total usage across cascaded FIFOs.
  *
+ * Constant time when @p cfifo is the head of an attached @ref m_cfifo_tCascade.
+ *
  * @param cfifo Pointer to the first FIFO in the cascade.
  * @return Sum of used bytes across all buffers.
  */
-uint32_t m_cfifo_All_GetUsage(m_cfifo_tCFifo* cfifo);
+m_cfifo_tTotal m_cfifo_All_GetUsage(m_cfifo_tCFifo* cfifo);
 
 
 /**
@@ -302,7 +1735,8 @@ bool m_cfifo_This_IsEmpty(m_cfifo_tCFifo* cfifo);
  * @brief Checks whether all cascaded FIFOs are empty.
  *
  * The function returns true only if every FIFO in the traversal chain
- * contains zero stored elements.
+ * contains zero stored elements. The walk stops at the first FIFO holding
+ * data, and is skipped for the head of an attached @ref m_cfifo_tCascade.
  *
  * @param cfifo Pointer to the first FIFO in the cascade.
  *
@@ -327,6 +1761,8 @@ bool m_cfifo_This_IsFull(m_cfifo_tCFifo* cfifo);
  * @brief Checks whether all cascaded FIFOs are full.
  *
  * Returns true only if every FIFO in the chain reports full status.
+ * The walk stops at the first FIFO with free space, and is skipped for
+ * the head of an attached @ref m_cfifo_tCascade.
  *
  * @param cfifo Pointer to the first FIFO in the cascade.
  *
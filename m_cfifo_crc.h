@@ -0,0 +1,155 @@
+/**
+ * @file m_cfifo_crc.h
+ * @brief Running CRC state for checksums computed while data is copied.
+ *
+ * This header defines a small CRC engine that the bulk FIFO functions
+ * (@ref m_cfifo_This_PushNCrc, @ref m_cfifo_This_PopNCrc and their
+ * cascaded variants) update while they copy, so a frame is checked without
+ * a second pass over its bytes. It can also be used on its own.
+ *
+ * Supported algorithms:
+ * - CRC-16/CCITT-FALSE: polynomial 0x1021, init 0xFFFF, not reflected,
+ *   no final XOR (check value 0x29B1).
+ * - CRC-32 (ISO-HDLC, as used by Ethernet and zlib): polynomial 0x04C11DB7
+ *   reflected, init and final XOR 0xFFFFFFFF (check value 0xCBF43926).
+ *
+ * CRC-32 uses slice-by-8 tables by default, or the ARMv8 CRC32
+ * instructions when the target provides them.
+ *
+ * Requires the core to be built with @ref M_CFIFO_CRC set to 1 for the FIFO
+ * variants.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef M_CFIFO_CRC_H_
+#define M_CFIFO_CRC_H_
+
+
+#include <stddef.h>
+#include <inttypes.h>
+
+//*****************************************************************************
+// Global Defines
+//*****************************************************************************
+
+#ifdef M_CFIFO_USER_CONFIG
+#include M_CFIFO_USER_CONFIG
+#endif
+
+/**
+ * @brief Compile-time option for the CRC-32 table size.
+ *
+ * When set to 1 (default), CRC-32 processes eight bytes per step with eight
+ * 256-entry tables (8 KiB of constant data). When set to 0, a single table
+ * (1 KiB) is used and one byte is processed per step, for small targets.
+ */
+#ifndef M_CFIFO_CRC32_SLICE8
+#define M_CFIFO_CRC32_SLICE8 1
+#endif
+
+/**
+ * @brief Compile-time option for hardware CRC-32.
+ *
+ * When set to 1 (default) and the compiler targets ARMv8 with the CRC
+ * extension (`__ARM_FEATURE_CRC32`), CRC-32 uses the `crc32b/w/x`
+ * instructions instead of the tables. x86 SSE4.2 only implements the
+ * Castagnoli polynomial (CRC-32C) and is therefore not used.
+ */
+#ifndef M_CFIFO_CRC_HW
+#define M_CFIFO_CRC_HW 1
+#endif
+
+
+//*****************************************************************************
+// Global Types
+//*****************************************************************************
+
+/**
+ * @brief CRC algorithm selector for @ref m_cfifo_Crc_Init.
+ */
+typedef enum
+{
+  M_CFIFO_CRC16_CCITT = 0,
+  M_CFIFO_CRC32
+}m_cfifo_tCrcType;
+
+/**
+ * @brief Running CRC state.
+ *
+ * Start with @ref m_cfifo_Crc_Init, feed bytes with @ref m_cfifo_Crc_Update
+ * (or a FIFO `*Crc` function) and read the result with @ref m_cfifo_Crc_Get.
+ * `reg` is the raw shift register before the final XOR.
+ */
+typedef struct _cfifo_crc
+{
+  m_cfifo_tCrcType type;
+  uint32_t reg;
+}m_cfifo_tCrc;
+
+
+//*****************************************************************************
+// Global Variable Declarations (Extern)
+//*****************************************************************************
+
+
+//*****************************************************************************
+// Global Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Starts a new CRC computation.
+ *
+ * @param crc  Pointer to the CRC state.
+ * @param type Algorithm to compute.
+ */
+void m_cfifo_Crc_Init(m_cfifo_tCrc* crc, m_cfifo_tCrcType type);
+
+
+/**
+ * @brief Feeds bytes into a running CRC.
+ *
+ * @param crc  Pointer to an initialized CRC state.
+ * @param data Bytes to add.
+ * @param len  Number of bytes.
+ */
+void m_cfifo_Crc_Update(m_cfifo_tCrc* crc, const void* data, size_t len);
+
+
+/**
+ * @brief Returns the CRC of all bytes fed so far.
+ *
+ * The state is not modified, so the computation may continue afterwards.
+ *
+ * @param crc Pointer to the CRC state.
+ * @return CRC value (CRC-16 in the low 16 bits).
+ */
+uint32_t m_cfifo_Crc_Get(const m_cfifo_tCrc* crc);
+
+
+/**
+ * @brief Updates a raw CRC-16/CCITT register.
+ *
+ * @param reg  Register value (0xFFFF to start).
+ * @param data Bytes to add.
+ * @param len  Number of bytes.
+ * @return Updated register, which is also the CRC value.
+ */
+uint16_t m_cfifo_Crc16_Update(uint16_t reg, const void* data, size_t len);
+
+
+/**
+ * @brief Updates a raw reflected CRC-32 register.
+ *
+ * @param reg  Register value (0xFFFFFFFF to start).
+ * @param data Bytes to add.
+ * @param len  Number of bytes.
+ * @return Updated register; the CRC value is the register XOR 0xFFFFFFFF.
+ */
+uint32_t m_cfifo_Crc32_Update(uint32_t reg, const void* data, size_t len);
+
+
+#endif /* M_CFIFO_CRC_H_ */
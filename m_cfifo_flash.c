@@ -0,0 +1,462 @@
+/**
+ * @file m_cfifo_flash.c
+ * @brief Implementation of the wear-aware flash page log.
+ *
+ * Design notes:
+ * - Pages are programmed strictly in circular order and at most once per
+ *   erase. The first program into a sector erases it. As soon as the write
+ *   page reaches a sector holding the oldest pages, the tail moves on to
+ *   the next sector, so one sector is always reserved and
+ *   `tail_page == wr_page` means empty.
+ * - A page is written in one driver call with its header in front, so a
+ *   reset leaves it either valid, erased or torn; a torn page fails the
+ *   checksum and is skipped by mount and read.
+ * - A failed program also skips the page, because it may be partly
+ *   programmed; the staged bytes go to the next page.
+ * - Page checks read the flash in small chunks, so they need no buffer
+ *   besides the page buffer, which may hold staged data at that time.
+ *
+ * @see m_cfifo_flash.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+
+#include "m_cfifo_flash.h"
+#include <stddef.h>
+#include <string.h>
+
+
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#define M_CFIFO_FLASH_HEADER      ((uint16_t)sizeof(m_cfifo_tFlashPage))
+#define M_CFIFO_FLASH_CHUNK       32u
+#define M_CFIFO_FLASH_NO_SEQUENCE 0xFFFFFFFFu
+#define M_CFIFO_FLASH_HASH_INIT   2166136261u
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Feeds bytes into an FNV-1a hash.
+ *
+ * @param hash Running hash value.
+ * @param data Bytes to add.
+ * @param len  Number of bytes.
+ * @return Updated hash value.
+ */
+static uint32_t m_cfifo_Flash_Hash(uint32_t hash, const uint8_t* data, uint32_t len);
+
+
+/**
+ * @brief Returns the flash address of a page.
+ *
+ * @param log  Pointer to the log.
+ * @param page Page index.
+ * @return Absolute address.
+ */
+static uint32_t m_cfifo_Flash_PageAddr(m_cfifo_tFlashLog* log, uint32_t page);
+
+
+/**
+ * @brief Returns the page following @p page in circular order.
+ *
+ * @param log  Pointer to the log.
+ * @param page Page index.
+ * @return Next page index.
+ */
+static uint32_t m_cfifo_Flash_NextPage(m_cfifo_tFlashLog* log, uint32_t page);
+
+
+/**
+ * @brief Reads and verifies a page header and its payload checksum.
+ *
+ * @param log    Pointer to the log.
+ * @param page   Page index.
+ * @param header Output for the header.
+ *
+ * @retval true  Page holds a valid log entry.
+ * @retval false Page is erased, torn or unreadable.
+ */
+static bool m_cfifo_Flash_CheckPage(m_cfifo_tFlashLog* log, uint32_t page, m_cfifo_tFlashPage* header);
+
+
+/**
+ * @brief Checks whether every byte of a page is erased.
+ *
+ * @param log  Pointer to the log.
+ * @param page Page index.
+ *
+ * @retval true  Page can be programmed.
+ * @retval false Page holds data or is unreadable.
+ */
+static bool m_cfifo_Flash_IsErased(m_cfifo_tFlashLog* log, uint32_t page);
+
+
+/**
+ * @brief Programs the page buffer at the write page.
+ *
+ * Erases the sector first if the write page starts one.
+ *
+ * @param log Pointer to the log with staged bytes.
+ *
+ * @retval true  Page programmed, page buffer empty.
+ * @retval false Driver error, bytes still staged.
+ */
+static bool m_cfifo_Flash_ProgramPage(m_cfifo_tFlashLog* log);
+
+
+/**
+ * @brief Drops the oldest pages if they share the next sector to erase.
+ *
+ * Called whenever the write page has moved onto a sector start of a
+ * non-empty log, so that `tail_page == wr_page` only ever means empty.
+ *
+ * @param log Pointer to the log.
+ */
+static void m_cfifo_Flash_ReserveSector(m_cfifo_tFlashLog* log);
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+bool m_cfifo_Flash_Init(m_cfifo_tFlashLog* log, const m_cfifo_tFlashDevice* dev, void* page)
+{
+  if (dev->page_size < M_CFIFO_FLASH_MIN_PAGE || dev->pages_per_sector == 0 || dev->sector_count < 2)
+    return false;
+
+  log->dev         = dev;
+  log->page        = (uint8_t*)page;
+  log->staged      = 0;
+  log->page_count  = (uint32_t)dev->pages_per_sector * dev->sector_count;
+  log->tail_page   = 0;
+  log->wr_page     = 0;
+  log->sequence    = 0;
+  log->rd_page     = 0;
+  log->rd_offset   = 0;
+  log->rd_length   = 0;
+  log->erase_count = 0;
+
+  return true;
+}
+
+uint32_t m_cfifo_Flash_Mount(m_cfifo_tFlashLog* log)
+{
+  m_cfifo_tFlashPage header;
+  uint32_t found = 0;
+  uint32_t oldest = 0;
+  uint32_t newest = 0;
+  uint32_t min_sequence = 0;
+  uint32_t max_sequence = 0;
+  uint32_t page;
+
+  log->staged = 0;
+  log->erase_count = 0;
+
+  for (page = 0; page < log->page_count; page++)
+  {
+    if (!m_cfifo_Flash_CheckPage(log, page, &header))
+      continue;
+
+    if (found == 0 || header.sequence < min_sequence)
+    {
+      oldest = page;
+      min_sequence = header.sequence;
+    }
+    if (found == 0 || header.sequence > max_sequence)
+    {
+      newest = page;
+      max_sequence = header.sequence;
+    }
+    found++;
+  }
+
+  if (found == 0)
+  {
+    log->tail_page = 0;
+    log->wr_page = 0;
+    log->sequence = 0;
+  }
+  else
+  {
+    log->tail_page = oldest;
+    log->wr_page = m_cfifo_Flash_NextPage(log, newest);
+    log->sequence = max_sequence + 1u;
+
+    // Skip pages torn by a reset; a sector start is erased before use anyway
+    while (log->wr_page % log->dev->pages_per_sector != 0 && log->wr_page != log->tail_page &&
+           !m_cfifo_Flash_IsErased(log, log->wr_page))
+      log->wr_page = m_cfifo_Flash_NextPage(log, log->wr_page);
+  }
+
+  // Pages of the sector to be erased next may still look valid
+  if (found != 0)
+    m_cfifo_Flash_ReserveSector(log);
+  m_cfifo_Flash_Rewind(log);
+
+  return found;
+}
+
+uint32_t m_cfifo_Flash_Append(m_cfifo_tFlashLog* log, const void* data, uint32_t len)
+{
+  const uint8_t* src = (const uint8_t*)data;
+  uint16_t payload = m_cfifo_Flash_GetPagePayload(log);
+  uint32_t done = 0;
+  uint32_t n;
+
+  while (done < len)
+  {
+    if (log->staged == payload && !m_cfifo_Flash_ProgramPage(log))
+      break;
+
+    n = (uint32_t)(payload - log->staged);
+    if (n > len - done)
+      n = len - done;
+
+    memcpy(&log->page[M_CFIFO_FLASH_HEADER + log->staged], &src[done], n);
+    log->staged = (uint16_t)(log->staged + n);
+    done += n;
+  }
+
+  if (log->staged == payload)
+    m_cfifo_Flash_ProgramPage(log);
+
+  return done;
+}
+
+uint32_t m_cfifo_Flash_AppendFifo(m_cfifo_tFlashLog* log, m_cfifo_tCFifo* cfifo, uint32_t max)
+{
+  uint16_t payload = m_cfifo_Flash_GetPagePayload(log);
+  uint32_t done = 0;
+  uint32_t n;
+
+  while (done < max)
+  {
+    if (log->staged == payload && !m_cfifo_Flash_ProgramPage(log))
+      break;
+
+    // At most one page payload (uint16_t), which every index width holds
+    n = (uint32_t)(payload - log->staged);
+    if (n > max - done)
+      n = max - done;
+
+    n = (uint32_t)m_cfifo_All_PopN(cfifo, &log->page[M_CFIFO_FLASH_HEADER + log->staged], (m_cfifo_tIndex)n);
+    if (n == 0)
+      break;
+    log->staged = (uint16_t)(log->staged + n);
+    done += n;
+  }
+
+  if (log->staged == payload)
+    m_cfifo_Flash_ProgramPage(log);
+
+  return done;
+}
+
+bool m_cfifo_Flash_Flush(m_cfifo_tFlashLog* log)
+{
+  if (log->staged == 0)
+    return true;
+
+  return m_cfifo_Flash_ProgramPage(log);
+}
+
+uint32_t m_cfifo_Flash_Read(m_cfifo_tFlashLog* log, void* data, uint32_t len)
+{
+  uint8_t* dst = (uint8_t*)data;
+  m_cfifo_tFlashPage header;
+  uint32_t done = 0;
+  uint32_t n;
+
+  while (done < len && log->rd_page != log->wr_page)
+  {
+    if (log->rd_length == 0)
+    {
+      if (!m_cfifo_Flash_CheckPage(log, log->rd_page, &header))
+      {
+        log->rd_page = m_cfifo_Flash_NextPage(log, log->rd_page);
+        continue;
+      }
+      log->rd_length = header.length;
+      log->rd_offset = 0;
+    }
+
+    n = (uint32_t)(log->rd_length - log->rd_offset);
+    if (n > len - done)
+      n = len - done;
+
+    if (!log->dev->read(log->dev->ctx, m_cfifo_Flash_PageAddr(log, log->rd_page) + M_CFIFO_FLASH_HEADER + log->rd_offset,
+                        &dst[done], n))
+      break;
+
+    log->rd_offset = (uint16_t)(log->rd_offset + n);
+    done += n;
+
+    if (log->rd_offset == log->rd_length)
+    {
+      log->rd_page = m_cfifo_Flash_NextPage(log, log->rd_page);
+      log->rd_offset = 0;
+      log->rd_length = 0;
+    }
+  }
+
+  return done;
+}
+
+void m_cfifo_Flash_Rewind(m_cfifo_tFlashLog* log)
+{
+  log->rd_page = log->tail_page;
+  log->rd_offset = 0;
+  log->rd_length = 0;
+}
+
+uint16_t m_cfifo_Flash_GetPagePayload(m_cfifo_tFlashLog* log)
+{
+  return (uint16_t)(log->dev->page_size - M_CFIFO_FLASH_HEADER);
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static uint32_t m_cfifo_Flash_Hash(uint32_t hash, const uint8_t* data, uint32_t len)
+{
+  uint32_t i;
+
+  for (i = 0; i < len; i++)
+  {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static uint32_t m_cfifo_Flash_PageAddr(m_cfifo_tFlashLog* log, uint32_t page)
+{
+  return log->dev->base + page * log->dev->page_size;
+}
+
+static uint32_t m_cfifo_Flash_NextPage(m_cfifo_tFlashLog* log, uint32_t page)
+{
+  return (page + 1u < log->page_count) ? page + 1u : 0;
+}
+
+static bool m_cfifo_Flash_CheckPage(m_cfifo_tFlashLog* log, uint32_t page, m_cfifo_tFlashPage* header)
+{
+  uint8_t chunk[M_CFIFO_FLASH_CHUNK];
+  uint32_t addr = m_cfifo_Flash_PageAddr(log, page);
+  uint32_t hash;
+  uint32_t done;
+  uint32_t n;
+
+  if (!log->dev->read(log->dev->ctx, addr, header, M_CFIFO_FLASH_HEADER))
+    return false;
+
+  if (header->sequence == M_CFIFO_FLASH_NO_SEQUENCE || header->length == 0 ||
+      header->length > m_cfifo_Flash_GetPagePayload(log))
+    return false;
+
+  hash = m_cfifo_Flash_Hash(M_CFIFO_FLASH_HASH_INIT, (const uint8_t*)header, offsetof(m_cfifo_tFlashPage, reserved));
+  for (done = 0; done < header->length; done += n)
+  {
+    n = header->length - done;
+    if (n > sizeof(chunk))
+      n = sizeof(chunk);
+    if (!log->dev->read(log->dev->ctx, addr + M_CFIFO_FLASH_HEADER + done, chunk, n))
+      return false;
+    hash = m_cfifo_Flash_Hash(hash, chunk, n);
+  }
+
+  return hash == header->check;
+}
+
+static bool m_cfifo_Flash_IsErased(m_cfifo_tFlashLog* log, uint32_t page)
+{
+  uint8_t chunk[M_CFIFO_FLASH_CHUNK];
+  uint32_t addr = m_cfifo_Flash_PageAddr(log, page);
+  uint32_t done;
+  uint32_t n;
+  uint32_t i;
+
+  for (done = 0; done < log->dev->page_size; done += n)
+  {
+    n = log->dev->page_size - done;
+    if (n > sizeof(chunk))
+      n = sizeof(chunk);
+    if (!log->dev->read(log->dev->ctx, addr + done, chunk, n))
+      return false;
+    for (i = 0; i < n; i++)
+    {
+      if (chunk[i] != M_CFIFO_FLASH_ERASED)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+static bool m_cfifo_Flash_ProgramPage(m_cfifo_tFlashLog* log)
+{
+  const m_cfifo_tFlashDevice* dev = log->dev;
+  m_cfifo_tFlashPage header;
+  bool ok;
+
+  if (log->wr_page % dev->pages_per_sector == 0)
+  {
+    if (!dev->erase(dev->ctx, m_cfifo_Flash_PageAddr(log, log->wr_page)))
+      return false;
+    log->erase_count++;
+  }
+
+  header.sequence = log->sequence;
+  header.length   = log->staged;
+  header.reserved = (uint16_t)(M_CFIFO_FLASH_ERASED * 0x0101u);
+  header.check    = m_cfifo_Flash_Hash(M_CFIFO_FLASH_HASH_INIT, (const uint8_t*)&header, offsetof(m_cfifo_tFlashPage, reserved));
+  header.check    = m_cfifo_Flash_Hash(header.check, &log->page[M_CFIFO_FLASH_HEADER], log->staged);
+  memcpy(log->page, &header, M_CFIFO_FLASH_HEADER);
+
+  // Leave the unused tail erased
+  memset(&log->page[M_CFIFO_FLASH_HEADER + log->staged], M_CFIFO_FLASH_ERASED,
+         (size_t)(m_cfifo_Flash_GetPagePayload(log) - log->staged));
+
+  ok = dev->program(dev->ctx, m_cfifo_Flash_PageAddr(log, log->wr_page), log->page, dev->page_size);
+
+  // A failed page may be partly programmed, so it is skipped either way
+  log->wr_page = m_cfifo_Flash_NextPage(log, log->wr_page);
+  m_cfifo_Flash_ReserveSector(log);
+  if (!ok)
+    return false;
+
+  log->sequence++;
+  log->staged = 0;
+
+  return true;
+}
+
+static void m_cfifo_Flash_ReserveSector(m_cfifo_tFlashLog* log)
+{
+  uint32_t sector_first = log->wr_page;
+  uint32_t sector_end = sector_first + log->dev->pages_per_sector;
+
+  if (sector_first % log->dev->pages_per_sector != 0)
+    return;
+
+  if (log->tail_page >= sector_first && log->tail_page < sector_end)
+  {
+    log->tail_page = (sector_end < log->page_count) ? sector_end : 0;
+    if (log->rd_page != log->wr_page && log->rd_page >= sector_first && log->rd_page < sector_end)
+      m_cfifo_Flash_Rewind(log);
+  }
+}
@@ -0,0 +1,232 @@
+/**
+ * @file m_cfifo_flash.h
+ * @brief Wear-aware page log that drains FIFO data into NOR flash.
+ *
+ * This header defines an append-only log on top of a small flash driver
+ * (read, program, erase). Bytes are collected in a RAM page buffer and
+ * programmed one whole page at a time, so flash is never rewritten per
+ * byte. Sectors are used in a circle: the log erases the next sector only
+ * when it needs it, dropping the oldest data, which spreads the erase
+ * cycles evenly over the whole area.
+ *
+ * - Each page starts with a @ref m_cfifo_tFlashPage header carrying a
+ *   sequence number, the payload length and a checksum over both and the
+ *   payload. Erased, torn and foreign pages fail the check and are skipped.
+ * - @ref m_cfifo_Flash_Mount rebuilds the log state from the page headers
+ *   after a reset.
+ * - @ref m_cfifo_Flash_AppendFifo moves data straight out of a FIFO or
+ *   cascade (e.g. a RAM event log) into the page buffer.
+ *
+ * Thread safety:
+ * - A log instance has no lock; use it from one context or under a lock.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef M_CFIFO_FLASH_H_
+#define M_CFIFO_FLASH_H_
+
+
+#include "m_cfifo.h"
+
+//*****************************************************************************
+// Global Defines
+//*****************************************************************************
+
+/**
+ * @brief Value of an erased flash byte.
+ */
+#ifndef M_CFIFO_FLASH_ERASED
+#define M_CFIFO_FLASH_ERASED 0xFFu
+#endif
+
+/**
+ * @brief Smallest page size supported by the log.
+ */
+#define M_CFIFO_FLASH_MIN_PAGE 16u
+
+
+//*****************************************************************************
+// Global Types
+//*****************************************************************************
+
+/**
+ * @brief Flash driver and geometry used by a page log.
+ *
+ * Addresses passed to the driver are absolute (`base` plus offset). The
+ * driver returns false on failure. `program` is only ever called for one
+ * whole, previously erased page; `erase` for the address of a sector.
+ */
+typedef struct
+{
+  bool (*read)(void* ctx, uint32_t addr, void* data, uint32_t len);
+  bool (*program)(void* ctx, uint32_t addr, const void* data, uint32_t len);
+  bool (*erase)(void* ctx, uint32_t addr);
+  void* ctx;
+
+  uint32_t base;
+  uint16_t page_size;
+  uint16_t pages_per_sector;
+  uint16_t sector_count;
+}m_cfifo_tFlashDevice;
+
+/**
+ * @brief Header at the start of every programmed page.
+ *
+ * `check` is a checksum over `sequence`, `length` and the payload.
+ */
+typedef struct
+{
+  uint32_t sequence;
+  uint16_t length;
+  uint16_t reserved;
+  uint32_t check;
+}m_cfifo_tFlashPage;
+
+/**
+ * @brief Control structure for a flash page log.
+ *
+ * Usage requirements:
+ * - Must be set up with @ref m_cfifo_Flash_Init and @ref m_cfifo_Flash_Mount.
+ * - `page` is a RAM buffer of `page_size` bytes owned by the log.
+ *
+ * The log spans the pages from `tail_page` (oldest) up to, but excluding,
+ * `wr_page` (next to program), in circular order. `rd_page`/`rd_offset`
+ * is the read position of @ref m_cfifo_Flash_Read, and `rd_length` the
+ * payload length of `rd_page` once it has been checked (0 before).
+ * `erase_count` counts the sector erases since mount, for wear monitoring.
+ */
+typedef struct
+{
+  const m_cfifo_tFlashDevice* dev;
+  uint8_t* page;
+  uint16_t staged;
+
+  uint32_t page_count;
+  uint32_t tail_page;
+  uint32_t wr_page;
+  uint32_t sequence;
+
+  uint32_t rd_page;
+  uint16_t rd_offset;
+  uint16_t rd_length;
+
+  uint32_t erase_count;
+}m_cfifo_tFlashLog;
+
+
+//*****************************************************************************
+// Global Variable Declarations (Extern)
+//*****************************************************************************
+
+
+//*****************************************************************************
+// Global Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Initializes a page log for a flash device.
+ *
+ * @param log  Pointer to the log to initialize.
+ * @param dev  Driver and geometry (at least two sectors, pages of at least
+ *             @ref M_CFIFO_FLASH_MIN_PAGE bytes).
+ * @param page RAM page buffer of `dev->page_size` bytes.
+ *
+ * @retval true  Log initialized.
+ * @retval false Geometry not supported.
+ */
+bool m_cfifo_Flash_Init(m_cfifo_tFlashLog* log, const m_cfifo_tFlashDevice* dev, void* page);
+
+
+/**
+ * @brief Rebuilds the log state from the pages in flash.
+ *
+ * Scans every page header, takes the valid page with the lowest sequence
+ * number as the oldest and continues after the one with the highest. A
+ * torn page behind the newest one is skipped, never reprogrammed. The read
+ * position is set to the oldest page.
+ *
+ * @param log Pointer to an initialized log.
+ * @return Number of valid pages found.
+ */
+uint32_t m_cfifo_Flash_Mount(m_cfifo_tFlashLog* log);
+
+
+/**
+ * @brief Appends bytes to the log.
+ *
+ * Bytes are collected in the page buffer; every full page is programmed.
+ *
+ * @param log  Pointer to a mounted log.
+ * @param data Pointer to the bytes to append.
+ * @param len  Number of bytes.
+ *
+ * @return Number of bytes accepted (less than @p len only on a driver error).
+ */
+uint32_t m_cfifo_Flash_Append(m_cfifo_tFlashLog* log, const void* data, uint32_t len);
+
+
+/**
+ * @brief Moves bytes out of a FIFO or cascade into the log.
+ *
+ * Pops with @ref m_cfifo_All_PopN directly into the page buffer, so the
+ * data is copied once.
+ *
+ * @param log   Pointer to a mounted log.
+ * @param cfifo Pointer to the FIFO (first FIFO of a cascade).
+ * @param max   Maximum number of bytes to move.
+ *
+ * @return Number of bytes moved.
+ */
+uint32_t m_cfifo_Flash_AppendFifo(m_cfifo_tFlashLog* log, m_cfifo_tCFifo* cfifo, uint32_t max);
+
+
+/**
+ * @brief Programs the partly filled page buffer.
+ *
+ * The rest of the page stays unused until its sector is erased, so flush
+ * only when the data must be durable (e.g. on a power-fail warning).
+ *
+ * @param log Pointer to a mounted log.
+ *
+ * @retval true  Nothing staged, or page programmed.
+ * @retval false Driver error; the staged bytes are kept.
+ */
+bool m_cfifo_Flash_Flush(m_cfifo_tFlashLog* log);
+
+
+/**
+ * @brief Reads logged bytes from the read position onwards.
+ *
+ * Only programmed pages are read; staged bytes are not visible.
+ *
+ * @param log  Pointer to a mounted log.
+ * @param data Output buffer.
+ * @param len  Maximum number of bytes to read.
+ *
+ * @return Number of bytes read (0 at the end of the log).
+ */
+uint32_t m_cfifo_Flash_Read(m_cfifo_tFlashLog* log, void* data, uint32_t len);
+
+
+/**
+ * @brief Sets the read position back to the oldest logged byte.
+ *
+ * @param log Pointer to a mounted log.
+ */
+void m_cfifo_Flash_Rewind(m_cfifo_tFlashLog* log);
+
+
+/**
+ * @brief Returns the payload capacity of one page.
+ *
+ * @param log Pointer to an initialized log.
+ * @return Page size minus the page header.
+ */
+uint16_t m_cfifo_Flash_GetPagePayload(m_cfifo_tFlashLog* log);
+
+
+#endif /* M_CFIFO_FLASH_H_ */
@@ -0,0 +1,113 @@
+/**
+ * @file m_cfifo_mirror.c
+ * @brief Implementation of the mirrored buffer allocator (Linux).
+ *
+ * Design notes:
+ * - An anonymous memfd of `buffer_size` bytes provides the shared pages.
+ * - A `2 * buffer_size` PROT_NONE reservation fixes the address range, then
+ *   both halves are replaced by MAP_FIXED shared mappings of the memfd.
+ * - The descriptor is closed right away; the mappings keep the pages alive.
+ *
+ * @see m_cfifo_mirror.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+
+#define _GNU_SOURCE
+
+#include "m_cfifo_mirror.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Rounds a requested size up to a valid mirrored buffer size.
+ *
+ * @param size Requested size in bytes.
+ * @return Page multiple (power of two with free-running indices), or 0 if
+ *         out of range.
+ */
+static size_t m_cfifo_Mirror_RoundSize(size_t size);
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+void* m_cfifo_Mirror_Alloc(m_cfifo_tIndex* buffer_size)
+{
+  size_t size = m_cfifo_Mirror_RoundSize(*buffer_size);
+  uint8_t* base;
+  int fd;
+
+  if (size == 0)
+    return NULL;
+
+  fd = memfd_create("m_cfifo", MFD_CLOEXEC);
+  if (fd < 0)
+    return NULL;
+
+  base = NULL;
+  if (ftruncate(fd, (off_t)size) == 0)
+  {
+    base = (uint8_t*)mmap(NULL, 2u * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == (uint8_t*)MAP_FAILED)
+    {
+      base = NULL;
+    }
+    else if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+             mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+      munmap(base, 2u * size);
+      base = NULL;
+    }
+  }
+  close(fd);
+
+  if (base != NULL)
+    *buffer_size = (m_cfifo_tIndex)size;
+
+  return base;
+}
+
+void m_cfifo_Mirror_Free(void* buffer, m_cfifo_tIndex buffer_size)
+{
+  if (buffer != NULL)
+    munmap(buffer, 2u * (size_t)buffer_size);
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static size_t m_cfifo_Mirror_RoundSize(size_t size)
+{
+  long page = sysconf(_SC_PAGESIZE);
+  size_t rounded;
+
+  // The double mapping must stay addressable: reject sizes near SIZE_MAX
+  if (page <= 0 || size == 0 || size > SIZE_MAX / 4u)
+    return 0;
+
+  rounded = (size + (size_t)page - 1u) / (size_t)page * (size_t)page;
+#if M_CFIFO_FREE_RUNNING_INDEX
+  // Pages are a power of two, so doubling from one page stays a page multiple
+  rounded = (size_t)page;
+  while (rounded < size)
+    rounded *= 2u;
+#endif
+
+  return (rounded > M_CFIFO_INDEX_MAX) ? 0 : rounded;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file m_cfifo_mirror.h
+ * @brief Host allocator for mirrored (double-mapped) FIFO buffers.
+ *
+ * This header declares a Linux-only helper that maps the same memory twice,
+ * back to back, in the virtual address space (memfd plus two shared
+ * mappings). A FIFO configured with such a buffer through
+ * @ref m_cfifo_ConfigMirrorBuffer never has to split a region at the wrap
+ * point: a byte written at `buffer[buffer_size + i]` appears at
+ * `buffer[i]` and vice versa.
+ *
+ * - The size is a multiple of the page size (rounded up).
+ * - With @ref M_CFIFO_FREE_RUNNING_INDEX it is also a power of two.
+ * - Requires the core to be built with @ref M_CFIFO_MIRROR set to 1.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef M_CFIFO_MIRROR_H_
+#define M_CFIFO_MIRROR_H_
+
+
+#include "m_cfifo.h"
+
+//*****************************************************************************
+// Global Defines
+//*****************************************************************************
+
+
+//*****************************************************************************
+// Global Types
+//*****************************************************************************
+
+
+//*****************************************************************************
+// Global Variable Declarations (Extern)
+//*****************************************************************************
+
+
+//*****************************************************************************
+// Global Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Allocates a mirrored buffer.
+ *
+ * @param buffer_size In: requested size in bytes. Out: allocated size
+ *                    (rounded up), to be passed to
+ *                    @ref m_cfifo_ConfigMirrorBuffer and
+ *                    @ref m_cfifo_Mirror_Free.
+ *
+ * @return Start of the double mapping (`2 * buffer_size` addressable bytes),
+ *         or NULL if the rounded size exceeds @ref M_CFIFO_INDEX_MAX or a
+ *         system call failed.
+ */
+void* m_cfifo_Mirror_Alloc(m_cfifo_tIndex* buffer_size);
+
+
+/**
+ * @brief Releases a buffer from @ref m_cfifo_Mirror_Alloc.
+ *
+ * @warning Reconfigure every FIFO using the buffer first.
+ *
+ * @param buffer      Start of the double mapping (may be NULL).
+ * @param buffer_size Allocated size returned by @ref m_cfifo_Mirror_Alloc.
+ */
+void m_cfifo_Mirror_Free(void* buffer, m_cfifo_tIndex buffer_size);
+
+
+#endif /* M_CFIFO_MIRROR_H_ */
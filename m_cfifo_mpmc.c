@@ -0,0 +1,225 @@
+/**
+ * @file m_cfifo_mpmc.c
+ * @brief Implementation of the lock-free multi-producer/multi-consumer FIFO.
+ *
+ * Design notes:
+ * - Slot `i` starts with sequence number `i`. A producer owning position
+ *   `pos` waits for sequence `pos`, writes the record and publishes
+ *   `pos + 1` with release ordering.
+ * - A consumer owning position `pos` waits for sequence `pos + 1`, reads
+ *   the record and frees the slot for the next lap by publishing
+ *   `pos + record_count` with release ordering.
+ * - Positions are claimed with a weak compare-and-swap; a sequence number
+ *   behind the position means full (producer) or empty (consumer).
+ * - All position arithmetic is modulo 2^32, so the free-running positions
+ *   may wrap.
+ *
+ * @see m_cfifo_mpmc.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+
+#include "m_cfifo_mpmc.h"
+#include <stddef.h>
+#include <string.h>
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Returns the sequence number of the slot for a position.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @param pos  Enqueue or dequeue position.
+ * @return Pointer to the atomic sequence number at the start of the slot.
+ */
+static _Atomic uint32_t* m_cfifo_Mpmc_GetSequence(m_cfifo_tMpmcFifo* fifo, uint32_t pos);
+
+
+/**
+ * @brief Returns the record storage of the slot for a position.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @param pos  Enqueue or dequeue position.
+ * @return Pointer to `record_size` bytes following the sequence number.
+ */
+static uint8_t* m_cfifo_Mpmc_GetRecord(m_cfifo_tMpmcFifo* fifo, uint32_t pos);
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+void m_cfifo_Mpmc_InitBuffer(m_cfifo_tMpmcFifo* fifo)
+{
+  fifo->buffer = NULL;
+  fifo->slot_size = 0;
+  fifo->record_size = 0;
+  fifo->index_mask = 0;
+  atomic_init(&fifo->enqueue_pos, 0);
+  atomic_init(&fifo->dequeue_pos, 0);
+}
+
+bool m_cfifo_Mpmc_ConfigBuffer(m_cfifo_tMpmcFifo* fifo, void* buffer, uint16_t record_count, uint16_t record_size)
+{
+  if (record_count > M_CFIFO_MPMC_MAX_RECORDS || record_size == 0 ||
+      M_CFIFO_MPMC_SLOT_SIZE(record_size) > UINT16_MAX)
+    return false;
+
+  // Round down to a power of two so that the position maps with a mask
+  while ((record_count & (record_count - 1u)) != 0)
+    record_count &= (uint16_t)(record_count - 1u);
+
+  // With one slot the free and written sequence numbers of adjacent laps
+  // coincide, so a second producer would overwrite an unread record
+  if (record_count == 1u)
+    return false;
+
+  fifo->buffer      = (record_count == 0) ? NULL : (uint8_t*)buffer;
+  fifo->slot_size   = (uint16_t)M_CFIFO_MPMC_SLOT_SIZE(record_size);
+  fifo->record_size = record_size;
+  fifo->index_mask  = (fifo->buffer == NULL) ? 0 : record_count - 1u;
+
+  m_cfifo_Mpmc_Clear(fifo);
+
+  return true;
+}
+
+void m_cfifo_Mpmc_Clear(m_cfifo_tMpmcFifo* fifo)
+{
+  uint32_t i;
+
+  if (fifo->buffer != NULL)
+  {
+    for (i = 0; i <= fifo->index_mask; i++)
+      atomic_init(m_cfifo_Mpmc_GetSequence(fifo, i), i);
+  }
+
+  atomic_store_explicit(&fifo->enqueue_pos, 0, memory_order_relaxed);
+  atomic_store_explicit(&fifo->dequeue_pos, 0, memory_order_release);
+}
+
+bool m_cfifo_Mpmc_Push(m_cfifo_tMpmcFifo* fifo, const void* record)
+{
+  uint32_t pos;
+  uint32_t seq;
+
+  if (fifo->buffer == NULL)
+    return false;
+
+  pos = atomic_load_explicit(&fifo->enqueue_pos, memory_order_relaxed);
+  for (;;)
+  {
+    seq = atomic_load_explicit(m_cfifo_Mpmc_GetSequence(fifo, pos), memory_order_acquire);
+
+    if (seq == pos)
+    {
+      // Slot is free for this lap: try to claim the position
+      if (atomic_compare_exchange_weak_explicit(&fifo->enqueue_pos, &pos, pos + 1u,
+                                                memory_order_relaxed, memory_order_relaxed))
+        break;
+    }
+    else if ((int32_t)(seq - pos) < 0)
+    {
+      // Slot still holds the record of the previous lap
+      return false;
+    }
+    else
+    {
+      pos = atomic_load_explicit(&fifo->enqueue_pos, memory_order_relaxed);
+    }
+  }
+
+  memcpy(m_cfifo_Mpmc_GetRecord(fifo, pos), record, fifo->record_size);
+  atomic_store_explicit(m_cfifo_Mpmc_GetSequence(fifo, pos), pos + 1u, memory_order_release);
+
+  return true;
+}
+
+bool m_cfifo_Mpmc_Pop(m_cfifo_tMpmcFifo* fifo, void* record)
+{
+  uint32_t pos;
+  uint32_t seq;
+
+  if (fifo->buffer == NULL)
+    return false;
+
+  pos = atomic_load_explicit(&fifo->dequeue_pos, memory_order_relaxed);
+  for (;;)
+  {
+    seq = atomic_load_explicit(m_cfifo_Mpmc_GetSequence(fifo, pos), memory_order_acquire);
+
+    if (seq == pos + 1u)
+    {
+      // Slot holds a record of this lap: try to claim the position
+      if (atomic_compare_exchange_weak_explicit(&fifo->dequeue_pos, &pos, pos + 1u,
+                                                memory_order_relaxed, memory_order_relaxed))
+        break;
+    }
+    else if ((int32_t)(seq - (pos + 1u)) < 0)
+    {
+      // Slot has not been written for this lap yet
+      return false;
+    }
+    else
+    {
+      pos = atomic_load_explicit(&fifo->dequeue_pos, memory_order_relaxed);
+    }
+  }
+
+  if (record != NULL)
+    memcpy(record, m_cfifo_Mpmc_GetRecord(fifo, pos), fifo->record_size);
+  atomic_store_explicit(m_cfifo_Mpmc_GetSequence(fifo, pos), pos + fifo->index_mask + 1u, memory_order_release);
+
+  return true;
+}
+
+uint32_t m_cfifo_Mpmc_GetRecordCapacity(m_cfifo_tMpmcFifo* fifo)
+{
+  return (fifo->buffer == NULL) ? 0 : fifo->index_mask + 1u;
+}
+
+uint32_t m_cfifo_Mpmc_GetRecordUsage(m_cfifo_tMpmcFifo* fifo)
+{
+  uint32_t deq = atomic_load_explicit(&fifo->dequeue_pos, memory_order_acquire);
+  uint32_t enq = atomic_load_explicit(&fifo->enqueue_pos, memory_order_acquire);
+  uint32_t used = enq - deq;
+
+  // dequeue_pos is read first, so a racing snapshot can only overestimate
+  if (used > m_cfifo_Mpmc_GetRecordCapacity(fifo))
+    return m_cfifo_Mpmc_GetRecordCapacity(fifo);
+
+  return used;
+}
+
+bool m_cfifo_Mpmc_IsEmpty(m_cfifo_tMpmcFifo* fifo)
+{
+  return m_cfifo_Mpmc_GetRecordUsage(fifo) == 0;
+}
+
+bool m_cfifo_Mpmc_IsFull(m_cfifo_tMpmcFifo* fifo)
+{
+  return m_cfifo_Mpmc_GetRecordUsage(fifo) >= m_cfifo_Mpmc_GetRecordCapacity(fifo);
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static _Atomic uint32_t* m_cfifo_Mpmc_GetSequence(m_cfifo_tMpmcFifo* fifo, uint32_t pos)
+{
+  return (_Atomic uint32_t*)(void*)&fifo->buffer[(size_t)(pos & fifo->index_mask) * fifo->slot_size];
+}
+
+static uint8_t* m_cfifo_Mpmc_GetRecord(m_cfifo_tMpmcFifo* fifo, uint32_t pos)
+{
+  return &fifo->buffer[(size_t)(pos & fifo->index_mask) * fifo->slot_size + sizeof(uint32_t)];
+}
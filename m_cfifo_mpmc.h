@@ -0,0 +1,227 @@
+/**
+ * @file m_cfifo_mpmc.h
+ * @brief Lock-free multi-producer/multi-consumer record FIFO.
+ *
+ * This header defines a bounded record FIFO that any number of producers and
+ * consumers may use concurrently without a lock. It follows the ring design
+ * by Dmitry Vyukov: every slot carries a sequence number that tells whether
+ * the slot is ready for the producer or the consumer of a given lap, so
+ * producers only contend on the enqueue position and consumers only on the
+ * dequeue position.
+ *
+ * - Records have a fixed size, as with @ref m_cfifo_ConfigRecordBuffer.
+ * - The record count is a power of two of at least 2; other counts are
+ *   rounded down.
+ * - Push and pop either move a whole record or fail, they never block.
+ *
+ * Thread safety:
+ * - Push, pop and state queries may run concurrently from any thread.
+ * - Init, config and clear must not run concurrently with any other call.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef M_CFIFO_MPMC_H_
+#define M_CFIFO_MPMC_H_
+
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+
+//*****************************************************************************
+// Global Defines
+//*****************************************************************************
+
+#ifdef M_CFIFO_USER_CONFIG
+#include M_CFIFO_USER_CONFIG
+#endif
+
+/**
+ * @brief Compile-time option for cache-line-aligned positions.
+ *
+ * Shared with the SPSC module: when set to the cache line size of the
+ * target, the enqueue and dequeue positions of @ref m_cfifo_tMpmcFifo are
+ * placed on separate cache lines.
+ */
+#ifndef M_CFIFO_CACHE_LINE_SIZE
+#define M_CFIFO_CACHE_LINE_SIZE 0
+#endif
+
+#ifndef M_CFIFO_CACHE_ALIGNED
+#if M_CFIFO_CACHE_LINE_SIZE
+#define M_CFIFO_CACHE_ALIGNED   _Alignas(M_CFIFO_CACHE_LINE_SIZE)
+#else
+#define M_CFIFO_CACHE_ALIGNED
+#endif
+#endif
+
+/**
+ * @brief Largest record count supported by an MPMC FIFO.
+ */
+#define M_CFIFO_MPMC_MAX_RECORDS 32768u
+
+/**
+ * @brief Storage size of one slot: sequence number plus record, padded.
+ *
+ * @param record_size Size of one record in bytes.
+ */
+#define M_CFIFO_MPMC_SLOT_SIZE(record_size) \
+  ((sizeof(uint32_t) + (record_size) + sizeof(uint32_t) - 1u) & ~(sizeof(uint32_t) - 1u))
+
+/**
+ * @brief Buffer size in bytes needed for @p record_count records.
+ *
+ * @param record_count Number of records (power of two).
+ * @param record_size  Size of one record in bytes.
+ */
+#define M_CFIFO_MPMC_BUFFER_SIZE(record_count, record_size) \
+  ((record_count) * M_CFIFO_MPMC_SLOT_SIZE(record_size))
+
+
+//*****************************************************************************
+// Global Types
+//*****************************************************************************
+
+/**
+ * @brief Control structure for a lock-free MPMC record FIFO.
+ *
+ * Usage requirements:
+ * - Must be initialized using @ref m_cfifo_Mpmc_InitBuffer before use.
+ * - A slot buffer is assigned with @ref m_cfifo_Mpmc_ConfigBuffer.
+ * - `enqueue_pos` is shared by the producers, `dequeue_pos` by the consumers.
+ *
+ * Both positions run freely; `index_mask` maps them to a slot.
+ */
+typedef struct
+{
+  M_CFIFO_CACHE_ALIGNED uint8_t* buffer;
+  uint16_t slot_size;
+  uint16_t record_size;
+  uint32_t index_mask;
+
+  M_CFIFO_CACHE_ALIGNED _Atomic uint32_t enqueue_pos;
+  M_CFIFO_CACHE_ALIGNED _Atomic uint32_t dequeue_pos;
+}m_cfifo_tMpmcFifo;
+
+
+//*****************************************************************************
+// Global Variable Declarations (Extern)
+//*****************************************************************************
+
+
+//*****************************************************************************
+// Global Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Initializes an MPMC FIFO instance to a known default state.
+ *
+ * After initialization the FIFO has no storage; push operations fail and
+ * pop operations report empty until @ref m_cfifo_Mpmc_ConfigBuffer is called.
+ *
+ * @param fifo Pointer to the FIFO instance to initialize.
+ */
+void m_cfifo_Mpmc_InitBuffer(m_cfifo_tMpmcFifo* fifo);
+
+
+/**
+ * @brief Assigns a slot buffer to the MPMC FIFO.
+ *
+ * The FIFO holds @p record_count records of @p record_size bytes each and
+ * is left empty. Non-power-of-two counts are rounded down.
+ *
+ * @param fifo         Pointer to the FIFO instance.
+ * @param buffer       Memory area of
+ *                     `M_CFIFO_MPMC_BUFFER_SIZE(record_count, record_size)`
+ *                     bytes, aligned to `uint32_t`.
+ * @param record_count Number of records (2 to @ref M_CFIFO_MPMC_MAX_RECORDS).
+ * @param record_size  Size of one record in bytes (at least 1).
+ *
+ * @retval true  Buffer assigned.
+ * @retval false Record count or size out of range; a count of 1 is rejected.
+ */
+bool m_cfifo_Mpmc_ConfigBuffer(m_cfifo_tMpmcFifo* fifo, void* buffer, uint16_t record_count, uint16_t record_size);
+
+
+/**
+ * @brief Clears all stored records in the MPMC FIFO.
+ *
+ * @warning Must not be called while any producer or consumer is active.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ */
+void m_cfifo_Mpmc_Clear(m_cfifo_tMpmcFifo* fifo);
+
+
+/**
+ * @brief Pushes one record (any producer).
+ *
+ * @param fifo   Pointer to the FIFO instance.
+ * @param record Pointer to `record_size` bytes to push.
+ *
+ * @retval true  Record successfully pushed.
+ * @retval false FIFO is full or unconfigured.
+ */
+bool m_cfifo_Mpmc_Push(m_cfifo_tMpmcFifo* fifo, const void* record);
+
+
+/**
+ * @brief Pops one record (any consumer).
+ *
+ * @param fifo   Pointer to the FIFO instance.
+ * @param record Output buffer of `record_size` bytes (may be NULL to discard).
+ *
+ * @retval true  Record successfully popped.
+ * @retval false FIFO is empty.
+ */
+bool m_cfifo_Mpmc_Pop(m_cfifo_tMpmcFifo* fifo, void* record);
+
+
+/**
+ * @brief Returns the number of records the MPMC FIFO can hold.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @return Record capacity.
+ */
+uint32_t m_cfifo_Mpmc_GetRecordCapacity(m_cfifo_tMpmcFifo* fifo);
+
+
+/**
+ * @brief Returns the number of stored records.
+ *
+ * The value is a snapshot and includes records that are being written or
+ * read at the moment of the call.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @return Number of stored records.
+ */
+uint32_t m_cfifo_Mpmc_GetRecordUsage(m_cfifo_tMpmcFifo* fifo);
+
+
+/**
+ * @brief Checks whether the MPMC FIFO is empty.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ *
+ * @retval true  FIFO contains no record.
+ * @retval false At least one record is stored.
+ */
+bool m_cfifo_Mpmc_IsEmpty(m_cfifo_tMpmcFifo* fifo);
+
+
+/**
+ * @brief Checks whether the MPMC FIFO is full.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ *
+ * @retval true  FIFO has no free slot.
+ * @retval false At least one record can still be stored.
+ */
+bool m_cfifo_Mpmc_IsFull(m_cfifo_tMpmcFifo* fifo);
+
+
+#endif /* M_CFIFO_MPMC_H_ */
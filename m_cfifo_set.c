@@ -0,0 +1,350 @@
+/**
+ * @file m_cfifo_set.c
+ * @brief Implementation of the queue-set scheduler.
+ *
+ * Design notes:
+ * - Queue `n` owns bit `31 - n` of the ready bitmap, so the lowest ready
+ *   slot is the leading-zero count, and the ready slots after slot `c` are
+ *   the bits below bit `31 - c`.
+ * - A bit is set after data was pushed and cleared before the queue is
+ *   checked for emptiness once more, so a push racing with the clear is
+ *   never lost.
+ * - DRR state (`current`, `deficit`) is only touched by the consumer. A
+ *   queue's deficit is topped up by its quantum when its turn begins and
+ *   reset when it runs empty, so idle queues do not save up credit.
+ *
+ * @see m_cfifo_set.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+
+#include "m_cfifo_set.h"
+#include <stddef.h>
+
+
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#define M_CFIFO_SET_BIT(queue) (0x80000000u >> (queue))
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Counts the leading zero bits of a non-zero word.
+ *
+ * @param bits Bitmap (must not be 0).
+ * @return Number of leading zeros (0..31).
+ */
+static uint8_t m_cfifo_Set_Clz(uint32_t bits);
+
+
+/**
+ * @brief Returns the first ready slot after @p queue, wrapping around.
+ *
+ * @param ready Ready bitmap (must not be 0).
+ * @param queue Slot to start after.
+ * @return Next ready slot (may be @p queue itself if it is the only one).
+ */
+static uint8_t m_cfifo_Set_Following(uint32_t ready, uint8_t queue);
+
+
+/**
+ * @brief Starts the DRR turn of the ready slot following @p queue.
+ *
+ * @param set   Pointer to the set.
+ * @param ready Ready bitmap (must not be 0).
+ * @param queue Slot whose turn ends.
+ * @return Slot whose turn begins.
+ */
+static uint8_t m_cfifo_Set_NextTurn(m_cfifo_tSet* set, uint32_t ready, uint8_t queue);
+
+
+/**
+ * @brief Brings the ready bit of a queue in line with its FIFO content.
+ *
+ * @param set   Pointer to the set.
+ * @param queue Slot number.
+ *
+ * @retval true  Queue holds data, bit set.
+ * @retval false Queue is empty, bit cleared.
+ */
+static bool m_cfifo_Set_Refresh(m_cfifo_tSet* set, uint8_t queue);
+
+
+/**
+ * @brief Checks that a slot number refers to a registered queue.
+ *
+ * @param set   Pointer to the set.
+ * @param queue Slot number.
+ *
+ * @retval true  Slot is registered.
+ * @retval false Slot out of range or unused.
+ */
+static bool m_cfifo_Set_IsValid(m_cfifo_tSet* set, uint8_t queue);
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+void m_cfifo_Set_Init(m_cfifo_tSet* set, m_cfifo_tSetQueue* queues, uint8_t queue_count, m_cfifo_tSetPolicy policy)
+{
+  uint8_t i;
+
+  if (queue_count > M_CFIFO_SET_MAX_QUEUES)
+    queue_count = M_CFIFO_SET_MAX_QUEUES;
+
+  for (i = 0; i < queue_count; i++)
+  {
+    queues[i].fifo = NULL;
+    queues[i].quantum = 0;
+    queues[i].deficit = 0;
+  }
+
+  set->queues      = queues;
+  set->queue_count = queue_count;
+  set->current     = M_CFIFO_SET_MAX_QUEUES - 1u;
+  set->policy      = policy;
+  atomic_init(&set->ready, 0);
+}
+
+bool m_cfifo_Set_AddQueue(m_cfifo_tSet* set, uint8_t queue, m_cfifo_tCFifo* fifo, m_cfifo_tIndex quantum)
+{
+  if (queue >= set->queue_count || set->queues[queue].fifo != NULL || fifo == NULL)
+    return false;
+
+  set->queues[queue].fifo    = fifo;
+  set->queues[queue].quantum = (quantum == 0) ? 1 : quantum;
+  set->queues[queue].deficit = 0;
+  m_cfifo_Set_Refresh(set, queue);
+
+  return true;
+}
+
+m_cfifo_tIndex m_cfifo_Set_Push(m_cfifo_tSet* set, uint8_t queue, const void* data, m_cfifo_tIndex len)
+{
+  m_cfifo_tIndex pushed;
+
+  if (!m_cfifo_Set_IsValid(set, queue))
+    return 0;
+
+  pushed = m_cfifo_All_PushN(set->queues[queue].fifo, data, len);
+  if (pushed != 0)
+    atomic_fetch_or_explicit(&set->ready, M_CFIFO_SET_BIT(queue), memory_order_release);
+
+  return pushed;
+}
+
+bool m_cfifo_Set_PushMsg(m_cfifo_tSet* set, uint8_t queue, const void* data, m_cfifo_tIndex len)
+{
+  if (!m_cfifo_Set_IsValid(set, queue))
+    return false;
+
+  if (!m_cfifo_All_PushMsg(set->queues[queue].fifo, data, len))
+    return false;
+
+  atomic_fetch_or_explicit(&set->ready, M_CFIFO_SET_BIT(queue), memory_order_release);
+
+  return true;
+}
+
+void m_cfifo_Set_Update(m_cfifo_tSet* set, uint8_t queue)
+{
+  if (m_cfifo_Set_IsValid(set, queue))
+    m_cfifo_Set_Refresh(set, queue);
+}
+
+m_cfifo_tIndex m_cfifo_Set_PopNext(m_cfifo_tSet* set, void* data, m_cfifo_tIndex len, uint8_t* queue)
+{
+  m_cfifo_tSetQueue* slot;
+  m_cfifo_tIndex popped;
+  m_cfifo_tIndex take;
+  uint32_t ready;
+  uint8_t q;
+
+  if (queue != NULL)
+    *queue = M_CFIFO_SET_NO_QUEUE;
+
+  if (len == 0)
+    return 0;
+
+  // A set bit whose queue turns out empty is cleared, so the loop ends
+  while ((ready = atomic_load_explicit(&set->ready, memory_order_acquire)) != 0)
+  {
+    if (set->policy == M_CFIFO_SET_STRICT)
+    {
+      q = m_cfifo_Set_Clz(ready);
+      slot = &set->queues[q];
+      popped = m_cfifo_All_PopN(slot->fifo, data, len);
+      m_cfifo_Set_Refresh(set, q);
+    }
+    else
+    {
+      q = set->current;
+      slot = &set->queues[q];
+      if ((ready & M_CFIFO_SET_BIT(q)) == 0 || slot->deficit == 0)
+      {
+        q = m_cfifo_Set_NextTurn(set, ready, q);
+        slot = &set->queues[q];
+      }
+
+      // Clamp per attempt: a stale ready bit must not cap the next queue
+      take = (len > slot->deficit) ? (m_cfifo_tIndex)slot->deficit : len;
+
+      popped = m_cfifo_All_PopN(slot->fifo, data, take);
+      slot->deficit -= popped;
+      if (!m_cfifo_Set_Refresh(set, q))
+        slot->deficit = 0;
+    }
+
+    if (popped != 0)
+    {
+      if (queue != NULL)
+        *queue = q;
+      return popped;
+    }
+  }
+
+  return 0;
+}
+
+bool m_cfifo_Set_PopNextMsg(m_cfifo_tSet* set, void* data, m_cfifo_tIndex max_len, m_cfifo_tIndex* len, uint8_t* queue)
+{
+  m_cfifo_tSetQueue* slot;
+  m_cfifo_tIndex msg_len;
+  uint32_t skip = 0;
+  uint32_t ready;
+  uint8_t q;
+
+  if (queue != NULL)
+    *queue = M_CFIFO_SET_NO_QUEUE;
+
+  for (;;)
+  {
+    // Queues holding data but no whole message are left out of this call
+    ready = atomic_load_explicit(&set->ready, memory_order_acquire) & ~skip;
+    if (ready == 0)
+      return false;
+
+    if (set->policy == M_CFIFO_SET_STRICT)
+    {
+      q = m_cfifo_Set_Clz(ready);
+    }
+    else
+    {
+      q = set->current;
+      if ((ready & M_CFIFO_SET_BIT(q)) == 0)
+        q = m_cfifo_Set_NextTurn(set, ready, q);
+    }
+    slot = &set->queues[q];
+
+    if (!m_cfifo_All_PeekMsgLen(slot->fifo, &msg_len))
+    {
+      if (!m_cfifo_Set_Refresh(set, q))
+        slot->deficit = 0;
+      skip |= M_CFIFO_SET_BIT(q);
+      continue;
+    }
+
+    if (set->policy == M_CFIFO_SET_DRR && msg_len > slot->deficit)
+    {
+      m_cfifo_Set_NextTurn(set, ready, q);
+      continue;
+    }
+
+    if (queue != NULL)
+      *queue = q;
+
+    if (!m_cfifo_All_PopMsg(slot->fifo, data, max_len, len))
+      return false;
+
+    if (set->policy == M_CFIFO_SET_DRR)
+      slot->deficit -= msg_len;
+    if (!m_cfifo_Set_Refresh(set, q))
+      slot->deficit = 0;
+
+    return true;
+  }
+}
+
+uint32_t m_cfifo_Set_GetReady(m_cfifo_tSet* set)
+{
+  return atomic_load_explicit(&set->ready, memory_order_acquire);
+}
+
+bool m_cfifo_Set_IsEmpty(m_cfifo_tSet* set)
+{
+  return m_cfifo_Set_GetReady(set) == 0;
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static uint8_t m_cfifo_Set_Clz(uint32_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return (uint8_t)__builtin_clz(bits);
+#else
+  uint8_t n = 0;
+
+  if ((bits & 0xFFFF0000u) == 0) { n += 16; bits <<= 16; }
+  if ((bits & 0xFF000000u) == 0) { n += 8;  bits <<= 8; }
+  if ((bits & 0xF0000000u) == 0) { n += 4;  bits <<= 4; }
+  if ((bits & 0xC0000000u) == 0) { n += 2;  bits <<= 2; }
+  if ((bits & 0x80000000u) == 0) { n += 1; }
+
+  return n;
+#endif
+}
+
+static uint8_t m_cfifo_Set_Following(uint32_t ready, uint8_t queue)
+{
+  uint32_t later = ready & (M_CFIFO_SET_BIT(queue) - 1u);
+
+  return m_cfifo_Set_Clz((later != 0) ? later : ready);
+}
+
+static uint8_t m_cfifo_Set_NextTurn(m_cfifo_tSet* set, uint32_t ready, uint8_t queue)
+{
+  uint8_t next = m_cfifo_Set_Following(ready, queue);
+
+  set->current = next;
+  set->queues[next].deficit += set->queues[next].quantum;
+
+  return next;
+}
+
+static bool m_cfifo_Set_Refresh(m_cfifo_tSet* set, uint8_t queue)
+{
+  m_cfifo_tCFifo* fifo = set->queues[queue].fifo;
+
+  if (m_cfifo_All_IsEmpty(fifo))
+  {
+    atomic_fetch_and_explicit(&set->ready, ~M_CFIFO_SET_BIT(queue), memory_order_acq_rel);
+
+    // A producer may have pushed between the check and the clear
+    if (m_cfifo_All_IsEmpty(fifo))
+      return false;
+  }
+
+  atomic_fetch_or_explicit(&set->ready, M_CFIFO_SET_BIT(queue), memory_order_release);
+
+  return true;
+}
+
+static bool m_cfifo_Set_IsValid(m_cfifo_tSet* set, uint8_t queue)
+{
+  return queue < set->queue_count && set->queues[queue].fifo != NULL;
+}
@@ -0,0 +1,239 @@
+/**
+ * @file m_cfifo_set.h
+ * @brief Queue set that schedules the next ready FIFO in O(1).
+ *
+ * This header defines a scheduler object over several FIFO instances (e.g.
+ * one for control and one for bulk traffic). It keeps a bitmap of the
+ * non-empty queues, so a consumer finds the next queue to serve with one
+ * count-leading-zeros instruction instead of polling every FIFO.
+ *
+ * - Queues are identified by their slot number; in strict-priority mode a
+ *   lower slot is served first.
+ * - In deficit-round-robin mode the ready queues are served in turn, each
+ *   up to its quantum of bytes per round.
+ * - Producers push through @ref m_cfifo_Set_Push / @ref m_cfifo_Set_PushMsg,
+ *   which mark the queue ready. Data pushed directly into a member FIFO is
+ *   picked up after @ref m_cfifo_Set_Update.
+ *
+ * Thread safety:
+ * - The bitmap is updated atomically, so producers may push while the
+ *   consumer pops. The member FIFOs themselves need the usual
+ *   @ref M_CFIFO_LOCK protection for concurrent access.
+ * - The `PopNext` functions must be called by a single consumer.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef M_CFIFO_SET_H_
+#define M_CFIFO_SET_H_
+
+
+#include "m_cfifo.h"
+#include <stdatomic.h>
+
+//*****************************************************************************
+// Global Defines
+//*****************************************************************************
+
+/**
+ * @brief Largest number of queues in a set (one bitmap word).
+ */
+#define M_CFIFO_SET_MAX_QUEUES 32u
+
+/**
+ * @brief Queue number reported when no queue was served.
+ */
+#define M_CFIFO_SET_NO_QUEUE 0xFFu
+
+
+//*****************************************************************************
+// Global Types
+//*****************************************************************************
+
+/**
+ * @brief Scheduling policy of a queue set.
+ *
+ * - `M_CFIFO_SET_STRICT` → always serve the lowest ready slot
+ * - `M_CFIFO_SET_DRR`    → deficit round robin, weighted by the quantum
+ */
+typedef enum
+{
+  M_CFIFO_SET_STRICT,
+  M_CFIFO_SET_DRR
+}m_cfifo_tSetPolicy;
+
+/**
+ * @brief One queue slot of a set.
+ *
+ * `quantum` is the number of bytes the queue may send per round in DRR
+ * mode, `deficit` the unused part of its current allowance.
+ */
+typedef struct
+{
+  m_cfifo_tCFifo* fifo;
+  m_cfifo_tIndex quantum;
+  m_cfifo_tTotal deficit;
+}m_cfifo_tSetQueue;
+
+/**
+ * @brief Control structure for a queue set.
+ *
+ * Usage requirements:
+ * - Must be initialized using @ref m_cfifo_Set_Init before use.
+ * - Queues are registered with @ref m_cfifo_Set_AddQueue.
+ *
+ * Bit `31 - n` of `ready` is set while queue `n` holds data, so the
+ * leading-zero count of the bitmap is the lowest ready slot.
+ */
+typedef struct
+{
+  m_cfifo_tSetQueue* queues;
+  uint8_t queue_count;
+  uint8_t current;
+  m_cfifo_tSetPolicy policy;
+  _Atomic uint32_t ready;
+}m_cfifo_tSet;
+
+
+//*****************************************************************************
+// Global Variable Declarations (Extern)
+//*****************************************************************************
+
+
+//*****************************************************************************
+// Global Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Initializes a queue set with no registered queue.
+ *
+ * @param set         Pointer to the set to initialize.
+ * @param queues      Array of @p queue_count slots, owned by the set.
+ * @param queue_count Number of slots (at most @ref M_CFIFO_SET_MAX_QUEUES,
+ *                    larger values are clamped).
+ * @param policy      Scheduling policy.
+ */
+void m_cfifo_Set_Init(m_cfifo_tSet* set, m_cfifo_tSetQueue* queues, uint8_t queue_count, m_cfifo_tSetPolicy policy);
+
+
+/**
+ * @brief Registers a FIFO (or the first FIFO of a cascade) in a slot.
+ *
+ * The ready bit is initialized from the current FIFO content.
+ *
+ * @param set     Pointer to the set.
+ * @param queue   Slot number (priority in strict mode, 0 is highest).
+ * @param fifo    FIFO to register.
+ * @param quantum Bytes per round in DRR mode (at least 1).
+ *
+ * @retval true  Queue registered.
+ * @retval false Slot out of range or already in use.
+ */
+bool m_cfifo_Set_AddQueue(m_cfifo_tSet* set, uint8_t queue, m_cfifo_tCFifo* fifo, m_cfifo_tIndex quantum);
+
+
+/**
+ * @brief Pushes a block of bytes into a queue and marks it ready.
+ *
+ * Uses @ref m_cfifo_All_PushN, so a cascaded queue spills into its
+ * successors.
+ *
+ * @param set   Pointer to the set.
+ * @param queue Slot number.
+ * @param data  Pointer to the bytes to push.
+ * @param len   Number of bytes to push.
+ *
+ * @return Number of bytes pushed.
+ */
+m_cfifo_tIndex m_cfifo_Set_Push(m_cfifo_tSet* set, uint8_t queue, const void* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Pushes one length-framed message into a queue and marks it ready.
+ *
+ * @param set   Pointer to the set.
+ * @param queue Slot number.
+ * @param data  Pointer to the payload.
+ * @param len   Payload length in bytes.
+ *
+ * @retval true  Message stored.
+ * @retval false Unknown queue or not enough space.
+ */
+bool m_cfifo_Set_PushMsg(m_cfifo_tSet* set, uint8_t queue, const void* data, m_cfifo_tIndex len);
+
+
+/**
+ * @brief Re-reads the ready state of a queue.
+ *
+ * Call after pushing into a member FIFO with the core functions, e.g. from
+ * an interrupt handler that does not know about the set.
+ *
+ * @param set   Pointer to the set.
+ * @param queue Slot number.
+ */
+void m_cfifo_Set_Update(m_cfifo_tSet* set, uint8_t queue);
+
+
+/**
+ * @brief Pops bytes from the next queue chosen by the policy.
+ *
+ * All bytes returned by one call come from the same queue. In DRR mode a
+ * call returns at most the remaining deficit of the served queue, so large
+ * transfers are interleaved at quantum granularity.
+ *
+ * @param set   Pointer to the set.
+ * @param data  Output buffer (may be NULL to discard).
+ * @param len   Maximum number of bytes to pop.
+ * @param queue Output for the served slot, or @ref M_CFIFO_SET_NO_QUEUE
+ *              (may be NULL).
+ *
+ * @return Number of bytes popped (0 if all queues are empty).
+ */
+m_cfifo_tIndex m_cfifo_Set_PopNext(m_cfifo_tSet* set, void* data, m_cfifo_tIndex len, uint8_t* queue);
+
+
+/**
+ * @brief Pops one whole message from the next queue chosen by the policy.
+ *
+ * In DRR mode a queue sends its head message only once its deficit covers
+ * the payload length, which is the classic packet DRR. If the payload does
+ * not fit into @p max_len, nothing is consumed and @p len receives the
+ * required size, as with @ref m_cfifo_All_PopMsg.
+ *
+ * @param set     Pointer to the set.
+ * @param data    Output buffer for the payload (may be NULL to discard).
+ * @param max_len Size of the output buffer (ignored if @p data is NULL).
+ * @param len     Output for the payload length (may be NULL).
+ * @param queue   Output for the served slot, or @ref M_CFIFO_SET_NO_QUEUE
+ *                (may be NULL).
+ *
+ * @retval true  Message popped.
+ * @retval false All queues empty, or output buffer too small.
+ */
+bool m_cfifo_Set_PopNextMsg(m_cfifo_tSet* set, void* data, m_cfifo_tIndex max_len, m_cfifo_tIndex* len, uint8_t* queue);
+
+
+/**
+ * @brief Returns the ready bitmap of a set.
+ *
+ * @param set Pointer to the set.
+ * @return Bitmap with bit `31 - n` set for every non-empty queue `n`.
+ */
+uint32_t m_cfifo_Set_GetReady(m_cfifo_tSet* set);
+
+
+/**
+ * @brief Checks whether every queue of a set is empty.
+ *
+ * @param set Pointer to the set.
+ *
+ * @retval true  No queue is marked ready.
+ * @retval false At least one queue holds data.
+ */
+bool m_cfifo_Set_IsEmpty(m_cfifo_tSet* set);
+
+
+#endif /* M_CFIFO_SET_H_ */
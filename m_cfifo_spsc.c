@@ -0,0 +1,537 @@
+/**
+ * @file m_cfifo_spsc.c
+ * @brief Implementation of the lock-free single-producer/single-consumer FIFO.
+ *
+ * Design notes:
+ * - `wrPtr` and `rdPtr` run modulo `2 * buffer_size`; the storage position
+ *   is the index reduced by `buffer_size` once.
+ * - The producer loads `rdPtr` with acquire ordering before writing data and
+ *   publishes `wrPtr` with release ordering after writing data.
+ * - The consumer loads `wrPtr` with acquire ordering before reading data and
+ *   publishes `rdPtr` with release ordering after reading data.
+ * - Each side reads its own index with relaxed ordering.
+ * - Batch handles keep their own index privately and publish it with the
+ *   same release store, so the ordering guarantees are unchanged; the other
+ *   side simply sees the data (or space) later, in bigger steps.
+ *
+ * @see m_cfifo_spsc.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+
+#include "m_cfifo_spsc.h"
+#include <stddef.h>
+#include <string.h>
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Returns the number of stored bytes for a pair of indices.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @param wr   Write index snapshot.
+ * @param rd   Read index snapshot.
+ * @return Number of bytes between @p rd and @p wr.
+ */
+static uint16_t m_cfifo_Spsc_Distance(const m_cfifo_tSpscFifo* fifo, uint16_t wr, uint16_t rd);
+
+
+/**
+ * @brief Maps an index to its storage position in the buffer.
+ *
+ * @param fifo  Pointer to the FIFO instance.
+ * @param index Index in the range `[0, 2 * buffer_size)`.
+ * @return Position in the range `[0, buffer_size)`.
+ */
+static uint16_t m_cfifo_Spsc_Position(const m_cfifo_tSpscFifo* fifo, uint16_t index);
+
+
+/**
+ * @brief Advances an index by a count with wrap at `2 * buffer_size`.
+ *
+ * @param fifo  Pointer to the FIFO instance.
+ * @param index Current index.
+ * @param count Number of positions to advance (at most `buffer_size`).
+ * @return Advanced index.
+ */
+static uint16_t m_cfifo_Spsc_Advance(const m_cfifo_tSpscFifo* fifo, uint16_t index, uint16_t count);
+
+
+/**
+ * @brief Returns the read index as seen by the producer.
+ *
+ * With @ref M_CFIFO_CACHE_LINE_SIZE the cached copy is used as long as it
+ * shows at least @p need free bytes; only otherwise the consumer's line is
+ * read again.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @param wr   Current write index.
+ * @param need Number of free bytes the caller wants.
+ * @return Read index snapshot.
+ */
+static uint16_t m_cfifo_Spsc_LoadRdPtr(m_cfifo_tSpscFifo* fifo, uint16_t wr, uint16_t need);
+
+
+/**
+ * @brief Returns the write index as seen by the consumer.
+ *
+ * Counterpart of @ref m_cfifo_Spsc_LoadRdPtr using `wr_cache`.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @param rd   Current read index.
+ * @param need Number of stored bytes the caller wants.
+ * @return Write index snapshot.
+ */
+static uint16_t m_cfifo_Spsc_LoadWrPtr(m_cfifo_tSpscFifo* fifo, uint16_t rd, uint16_t need);
+
+
+/**
+ * @brief Returns the free space seen by a producer handle.
+ *
+ * Reloads the read index only if the cached one shows less than @p need
+ * free bytes. If the ring still looks too full, pending bytes are
+ * published so that the consumer can start draining them.
+ *
+ * @param writer Pointer to the handle.
+ * @param need   Number of free bytes the caller wants.
+ * @return Free bytes.
+ */
+static uint16_t m_cfifo_Spsc_WriterSpace(m_cfifo_tSpscWriter* writer, uint16_t need);
+
+
+/**
+ * @brief Returns the stored bytes seen by a consumer handle.
+ *
+ * Counterpart of @ref m_cfifo_Spsc_WriterSpace: reloads the write index
+ * only when needed and releases consumed bytes when the ring looks empty.
+ *
+ * @param reader Pointer to the handle.
+ * @param need   Number of stored bytes the caller wants.
+ * @return Stored bytes.
+ */
+static uint16_t m_cfifo_Spsc_ReaderData(m_cfifo_tSpscReader* reader, uint16_t need);
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+void m_cfifo_Spsc_InitBuffer(m_cfifo_tSpscFifo* fifo)
+{
+  fifo->buffer = NULL;
+  fifo->buffer_size = 0;
+  atomic_init(&fifo->rdPtr, 0);
+  atomic_init(&fifo->wrPtr, 0);
+#if M_CFIFO_CACHE_LINE_SIZE
+  fifo->rd_cache = 0;
+  fifo->wr_cache = 0;
+#endif
+}
+
+bool m_cfifo_Spsc_ConfigBuffer(m_cfifo_tSpscFifo* fifo, void* buffer, uint16_t buffer_size)
+{
+  if (buffer_size > M_CFIFO_SPSC_MAX_SIZE)
+    return false;
+
+  fifo->buffer      = (uint8_t*)buffer;
+  fifo->buffer_size = (buffer == NULL) ? 0 : buffer_size;
+  m_cfifo_Spsc_Clear(fifo);
+
+  return true;
+}
+
+void m_cfifo_Spsc_Clear(m_cfifo_tSpscFifo* fifo)
+{
+  atomic_store_explicit(&fifo->rdPtr, 0, memory_order_relaxed);
+  atomic_store_explicit(&fifo->wrPtr, 0, memory_order_release);
+#if M_CFIFO_CACHE_LINE_SIZE
+  fifo->rd_cache = 0;
+  fifo->wr_cache = 0;
+#endif
+}
+
+bool m_cfifo_Spsc_Push(m_cfifo_tSpscFifo* fifo, uint8_t data)
+{
+  uint16_t wr = atomic_load_explicit(&fifo->wrPtr, memory_order_relaxed);
+  uint16_t rd = m_cfifo_Spsc_LoadRdPtr(fifo, wr, 1);
+
+  if (m_cfifo_Spsc_Distance(fifo, wr, rd) >= fifo->buffer_size)
+    return false;
+
+  fifo->buffer[m_cfifo_Spsc_Position(fifo, wr)] = data;
+  atomic_store_explicit(&fifo->wrPtr, m_cfifo_Spsc_Advance(fifo, wr, 1), memory_order_release);
+
+  return true;
+}
+
+uint16_t m_cfifo_Spsc_PushN(m_cfifo_tSpscFifo* fifo, const void* data, uint16_t len)
+{
+  const uint8_t* src = (const uint8_t*)data;
+  uint16_t wr = atomic_load_explicit(&fifo->wrPtr, memory_order_relaxed);
+  uint16_t rd = m_cfifo_Spsc_LoadRdPtr(fifo, wr, len);
+  uint16_t space = fifo->buffer_size - m_cfifo_Spsc_Distance(fifo, wr, rd);
+  uint16_t pos;
+  uint16_t first;
+
+  if (len > space)
+    len = space;
+
+  if (len == 0)
+    return 0;
+
+  pos = m_cfifo_Spsc_Position(fifo, wr);
+  first = fifo->buffer_size - pos;
+  if (first > len)
+    first = len;
+
+  memcpy(&fifo->buffer[pos], src, first);
+  if (len > first)
+    memcpy(fifo->buffer, &src[first], len - first);
+
+  atomic_store_explicit(&fifo->wrPtr, m_cfifo_Spsc_Advance(fifo, wr, len), memory_order_release);
+
+  return len;
+}
+
+bool m_cfifo_Spsc_Pop(m_cfifo_tSpscFifo* fifo, uint8_t* data)
+{
+  uint16_t rd = atomic_load_explicit(&fifo->rdPtr, memory_order_relaxed);
+  uint16_t wr = m_cfifo_Spsc_LoadWrPtr(fifo, rd, 1);
+
+  if (wr == rd)
+    return false;
+
+  if (data != NULL)
+    *data = fifo->buffer[m_cfifo_Spsc_Position(fifo, rd)];
+  atomic_store_explicit(&fifo->rdPtr, m_cfifo_Spsc_Advance(fifo, rd, 1), memory_order_release);
+
+  return true;
+}
+
+uint16_t m_cfifo_Spsc_PopN(m_cfifo_tSpscFifo* fifo, void* data, uint16_t len)
+{
+  uint8_t* dst = (uint8_t*)data;
+  uint16_t rd = atomic_load_explicit(&fifo->rdPtr, memory_order_relaxed);
+  uint16_t wr = m_cfifo_Spsc_LoadWrPtr(fifo, rd, len);
+  uint16_t used = m_cfifo_Spsc_Distance(fifo, wr, rd);
+  uint16_t pos;
+  uint16_t first;
+
+  if (len > used)
+    len = used;
+
+  if (len == 0)
+    return 0;
+
+  if (dst != NULL)
+  {
+    pos = m_cfifo_Spsc_Position(fifo, rd);
+    first = fifo->buffer_size - pos;
+    if (first > len)
+      first = len;
+
+    memcpy(dst, &fifo->buffer[pos], first);
+    if (len > first)
+      memcpy(&dst[first], fifo->buffer, len - first);
+  }
+
+  atomic_store_explicit(&fifo->rdPtr, m_cfifo_Spsc_Advance(fifo, rd, len), memory_order_release);
+
+  return len;
+}
+
+uint16_t m_cfifo_Spsc_GetSize(m_cfifo_tSpscFifo* fifo)
+{
+  return fifo->buffer_size;
+}
+
+uint16_t m_cfifo_Spsc_GetUsage(m_cfifo_tSpscFifo* fifo)
+{
+  uint16_t rd = atomic_load_explicit(&fifo->rdPtr, memory_order_acquire);
+  uint16_t wr = atomic_load_explicit(&fifo->wrPtr, memory_order_acquire);
+
+  return m_cfifo_Spsc_Distance(fifo, wr, rd);
+}
+
+bool m_cfifo_Spsc_IsEmpty(m_cfifo_tSpscFifo* fifo)
+{
+  return m_cfifo_Spsc_GetUsage(fifo) == 0;
+}
+
+bool m_cfifo_Spsc_IsFull(m_cfifo_tSpscFifo* fifo)
+{
+  return m_cfifo_Spsc_GetUsage(fifo) >= fifo->buffer_size;
+}
+
+void m_cfifo_Spsc_WriterInit(m_cfifo_tSpscWriter* writer, m_cfifo_tSpscFifo* fifo, uint16_t batch_size)
+{
+  writer->fifo       = fifo;
+  writer->wrPtr      = atomic_load_explicit(&fifo->wrPtr, memory_order_relaxed);
+  writer->rd_cache   = atomic_load_explicit(&fifo->rdPtr, memory_order_acquire);
+  writer->pending    = 0;
+  writer->batch_size = batch_size;
+  writer->signal     = NULL;
+  writer->ctx        = NULL;
+}
+
+void m_cfifo_Spsc_WriterSetSignal(m_cfifo_tSpscWriter* writer, m_cfifo_tSpscSignal signal, void* ctx)
+{
+  writer->signal = signal;
+  writer->ctx    = ctx;
+}
+
+bool m_cfifo_Spsc_WriterPush(m_cfifo_tSpscWriter* writer, uint8_t data)
+{
+  m_cfifo_tSpscFifo* fifo = writer->fifo;
+
+  if (m_cfifo_Spsc_WriterSpace(writer, 1) == 0)
+    return false;
+
+  fifo->buffer[m_cfifo_Spsc_Position(fifo, writer->wrPtr)] = data;
+  writer->wrPtr = m_cfifo_Spsc_Advance(fifo, writer->wrPtr, 1);
+  writer->pending++;
+
+  if (writer->batch_size != 0 && writer->pending >= writer->batch_size)
+    m_cfifo_Spsc_WriterFlush(writer);
+
+  return true;
+}
+
+uint16_t m_cfifo_Spsc_WriterPushN(m_cfifo_tSpscWriter* writer, const void* data, uint16_t len)
+{
+  m_cfifo_tSpscFifo* fifo = writer->fifo;
+  const uint8_t* src = (const uint8_t*)data;
+  uint16_t space = m_cfifo_Spsc_WriterSpace(writer, len);
+  uint16_t pos;
+  uint16_t first;
+
+  if (len > space)
+    len = space;
+
+  if (len == 0)
+    return 0;
+
+  pos = m_cfifo_Spsc_Position(fifo, writer->wrPtr);
+  first = fifo->buffer_size - pos;
+  if (first > len)
+    first = len;
+
+  memcpy(&fifo->buffer[pos], src, first);
+  if (len > first)
+    memcpy(fifo->buffer, &src[first], len - first);
+
+  writer->wrPtr = m_cfifo_Spsc_Advance(fifo, writer->wrPtr, len);
+  writer->pending += len;
+
+  if (writer->batch_size != 0 && writer->pending >= writer->batch_size)
+    m_cfifo_Spsc_WriterFlush(writer);
+
+  return len;
+}
+
+uint16_t m_cfifo_Spsc_WriterFlush(m_cfifo_tSpscWriter* writer)
+{
+  uint16_t published = writer->pending;
+
+  if (published == 0)
+    return 0;
+
+  atomic_store_explicit(&writer->fifo->wrPtr, writer->wrPtr, memory_order_release);
+  writer->pending = 0;
+  if (writer->signal != NULL)
+    writer->signal(writer->ctx);
+
+  return published;
+}
+
+void m_cfifo_Spsc_ReaderInit(m_cfifo_tSpscReader* reader, m_cfifo_tSpscFifo* fifo, uint16_t batch_size)
+{
+  reader->fifo       = fifo;
+  reader->rdPtr      = atomic_load_explicit(&fifo->rdPtr, memory_order_relaxed);
+  reader->wr_cache   = atomic_load_explicit(&fifo->wrPtr, memory_order_acquire);
+  reader->pending    = 0;
+  reader->batch_size = batch_size;
+  reader->signal     = NULL;
+  reader->ctx        = NULL;
+}
+
+void m_cfifo_Spsc_ReaderSetSignal(m_cfifo_tSpscReader* reader, m_cfifo_tSpscSignal signal, void* ctx)
+{
+  reader->signal = signal;
+  reader->ctx    = ctx;
+}
+
+bool m_cfifo_Spsc_ReaderPop(m_cfifo_tSpscReader* reader, uint8_t* data)
+{
+  m_cfifo_tSpscFifo* fifo = reader->fifo;
+
+  if (m_cfifo_Spsc_ReaderData(reader, 1) == 0)
+    return false;
+
+  if (data != NULL)
+    *data = fifo->buffer[m_cfifo_Spsc_Position(fifo, reader->rdPtr)];
+  reader->rdPtr = m_cfifo_Spsc_Advance(fifo, reader->rdPtr, 1);
+  reader->pending++;
+
+  if (reader->batch_size != 0 && reader->pending >= reader->batch_size)
+    m_cfifo_Spsc_ReaderFlush(reader);
+
+  return true;
+}
+
+uint16_t m_cfifo_Spsc_ReaderPopN(m_cfifo_tSpscReader* reader, void* data, uint16_t len)
+{
+  m_cfifo_tSpscFifo* fifo = reader->fifo;
+  uint8_t* dst = (uint8_t*)data;
+  uint16_t used = m_cfifo_Spsc_ReaderData(reader, len);
+  uint16_t pos;
+  uint16_t first;
+
+  if (len > used)
+    len = used;
+
+  if (len == 0)
+    return 0;
+
+  if (dst != NULL)
+  {
+    pos = m_cfifo_Spsc_Position(fifo, reader->rdPtr);
+    first = fifo->buffer_size - pos;
+    if (first > len)
+      first = len;
+
+    memcpy(dst, &fifo->buffer[pos], first);
+    if (len > first)
+      memcpy(&dst[first], fifo->buffer, len - first);
+  }
+
+  reader->rdPtr = m_cfifo_Spsc_Advance(fifo, reader->rdPtr, len);
+  reader->pending += len;
+
+  if (reader->batch_size != 0 && reader->pending >= reader->batch_size)
+    m_cfifo_Spsc_ReaderFlush(reader);
+
+  return len;
+}
+
+uint16_t m_cfifo_Spsc_ReaderFlush(m_cfifo_tSpscReader* reader)
+{
+  uint16_t released = reader->pending;
+
+  if (released == 0)
+    return 0;
+
+  atomic_store_explicit(&reader->fifo->rdPtr, reader->rdPtr, memory_order_release);
+  reader->pending = 0;
+  if (reader->signal != NULL)
+    reader->signal(reader->ctx);
+
+  return released;
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static uint16_t m_cfifo_Spsc_Distance(const m_cfifo_tSpscFifo* fifo, uint16_t wr, uint16_t rd)
+{
+  if (wr >= rd)
+    return wr - rd;
+  else
+    return (uint16_t)(2u * fifo->buffer_size - rd + wr);
+}
+
+static uint16_t m_cfifo_Spsc_Position(const m_cfifo_tSpscFifo* fifo, uint16_t index)
+{
+  if (index >= fifo->buffer_size)
+    return index - fifo->buffer_size;
+  else
+    return index;
+}
+
+static uint16_t m_cfifo_Spsc_Advance(const m_cfifo_tSpscFifo* fifo, uint16_t index, uint16_t count)
+{
+  uint32_t next = (uint32_t)index + count;
+
+  if (next >= 2u * fifo->buffer_size)
+    next -= 2u * fifo->buffer_size;
+
+  return (uint16_t)next;
+}
+
+static uint16_t m_cfifo_Spsc_LoadRdPtr(m_cfifo_tSpscFifo* fifo, uint16_t wr, uint16_t need)
+{
+#if M_CFIFO_CACHE_LINE_SIZE
+  // A stale read index only underestimates the free space
+  if (fifo->buffer_size - m_cfifo_Spsc_Distance(fifo, wr, fifo->rd_cache) >= need)
+    return fifo->rd_cache;
+
+  fifo->rd_cache = atomic_load_explicit(&fifo->rdPtr, memory_order_acquire);
+  return fifo->rd_cache;
+#else
+  (void)wr;
+  (void)need;
+  return atomic_load_explicit(&fifo->rdPtr, memory_order_acquire);
+#endif
+}
+
+static uint16_t m_cfifo_Spsc_LoadWrPtr(m_cfifo_tSpscFifo* fifo, uint16_t rd, uint16_t need)
+{
+#if M_CFIFO_CACHE_LINE_SIZE
+  // A stale write index only underestimates the stored data
+  if (m_cfifo_Spsc_Distance(fifo, fifo->wr_cache, rd) >= need)
+    return fifo->wr_cache;
+
+  fifo->wr_cache = atomic_load_explicit(&fifo->wrPtr, memory_order_acquire);
+  return fifo->wr_cache;
+#else
+  (void)rd;
+  (void)need;
+  return atomic_load_explicit(&fifo->wrPtr, memory_order_acquire);
+#endif
+}
+
+static uint16_t m_cfifo_Spsc_WriterSpace(m_cfifo_tSpscWriter* writer, uint16_t need)
+{
+  m_cfifo_tSpscFifo* fifo = writer->fifo;
+  uint16_t space = fifo->buffer_size - m_cfifo_Spsc_Distance(fifo, writer->wrPtr, writer->rd_cache);
+
+  if (space < need)
+  {
+    writer->rd_cache = atomic_load_explicit(&fifo->rdPtr, memory_order_acquire);
+    space = fifo->buffer_size - m_cfifo_Spsc_Distance(fifo, writer->wrPtr, writer->rd_cache);
+
+    // Hand over what is already written instead of sitting on a full ring
+    if (space < need)
+      m_cfifo_Spsc_WriterFlush(writer);
+  }
+
+  return space;
+}
+
+static uint16_t m_cfifo_Spsc_ReaderData(m_cfifo_tSpscReader* reader, uint16_t need)
+{
+  m_cfifo_tSpscFifo* fifo = reader->fifo;
+  uint16_t used = m_cfifo_Spsc_Distance(fifo, reader->wr_cache, reader->rdPtr);
+
+  if (used < need)
+  {
+    reader->wr_cache = atomic_load_explicit(&fifo->wrPtr, memory_order_acquire);
+    used = m_cfifo_Spsc_Distance(fifo, reader->wr_cache, reader->rdPtr);
+
+    // Give the space back before the caller goes idle on an empty ring
+    if (used < need)
+      m_cfifo_Spsc_ReaderFlush(reader);
+  }
+
+  return used;
+}
@@ -0,0 +1,428 @@
+/**
+ * @file m_cfifo_spsc.h
+ * @brief Lock-free single-producer/single-consumer circular FIFO.
+ *
+ * This header defines a variant of the circular byte FIFO that can be shared
+ * between exactly one producer and one consumer (e.g. an ISR and a task, or
+ * two threads) without any lock. It uses C11 atomics with acquire/release
+ * ordering:
+ * - the producer is the only writer of `wrPtr`
+ * - the consumer is the only writer of `rdPtr`
+ * - occupancy is derived from both indices, there is no shared usage counter
+ *
+ * Both indices run modulo twice the buffer size, so a full FIFO can be told
+ * apart from an empty one without sacrificing a storage byte.
+ *
+ * With @ref M_CFIFO_CACHE_LINE_SIZE set, producer and consumer state live on
+ * separate cache lines and each side keeps a private copy of the other
+ * side's index, so the shared line is only read when the cached value shows
+ * too little space or data.
+ *
+ * A producer (or consumer) that moves data in bursts can go through a
+ * batch handle (@ref m_cfifo_tSpscWriter, @ref m_cfifo_tSpscReader): it
+ * keeps its own index private and publishes it, together with an optional
+ * signal hook, only once per batch or on an explicit flush.
+ *
+ * Thread safety:
+ * - Producer functions (`Push`, `PushN`, `Writer*`) may run concurrently
+ *   with consumer functions (`Pop`, `PopN`, `Reader*`).
+ * - Any number of state queries may run concurrently with both sides.
+ * - Init, config and clear must not run concurrently with any other call.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef M_CFIFO_SPSC_H_
+#define M_CFIFO_SPSC_H_
+
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+
+//*****************************************************************************
+// Global Defines
+//*****************************************************************************
+
+#ifdef M_CFIFO_USER_CONFIG
+#include M_CFIFO_USER_CONFIG
+#endif
+
+/**
+ * @brief Compile-time option for a cache-line-aligned SPSC layout.
+ *
+ * When set to the cache line size of the target (e.g. 64), the read-only
+ * configuration, the producer state (`wrPtr`, `rd_cache`) and the consumer
+ * state (`rdPtr`, `wr_cache`) of @ref m_cfifo_tSpscFifo are placed on
+ * three separate cache lines. When set to 0 (default), the compact layout
+ * without cached indices is used.
+ *
+ * @note An aligned FIFO allocated on the heap needs `aligned_alloc`.
+ */
+#ifndef M_CFIFO_CACHE_LINE_SIZE
+#define M_CFIFO_CACHE_LINE_SIZE 0
+#endif
+
+#ifndef M_CFIFO_CACHE_ALIGNED
+#if M_CFIFO_CACHE_LINE_SIZE
+#define M_CFIFO_CACHE_ALIGNED   _Alignas(M_CFIFO_CACHE_LINE_SIZE)
+#else
+#define M_CFIFO_CACHE_ALIGNED
+#endif
+#endif
+
+/**
+ * @brief Largest buffer size supported by an SPSC FIFO.
+ *
+ * The indices run modulo `2 * buffer_size` and are stored as `uint16_t`.
+ */
+#define M_CFIFO_SPSC_MAX_SIZE 32768u
+
+
+//*****************************************************************************
+// Global Types
+//*****************************************************************************
+
+/**
+ * @brief Control structure for a lock-free SPSC circular byte buffer.
+ *
+ * Usage requirements:
+ * - Must be initialized using @ref m_cfifo_Spsc_InitBuffer before use.
+ * - A working data buffer is assigned with @ref m_cfifo_Spsc_ConfigBuffer.
+ * - `rdPtr` and `wr_cache` are owned by the consumer, `wrPtr` and
+ *   `rd_cache` by the producer (caches only with @ref M_CFIFO_CACHE_LINE_SIZE).
+ */
+typedef struct
+{
+  M_CFIFO_CACHE_ALIGNED uint8_t* buffer;
+  uint16_t buffer_size;
+
+  M_CFIFO_CACHE_ALIGNED _Atomic uint16_t wrPtr;
+#if M_CFIFO_CACHE_LINE_SIZE
+  uint16_t rd_cache;
+#endif
+
+  M_CFIFO_CACHE_ALIGNED _Atomic uint16_t rdPtr;
+#if M_CFIFO_CACHE_LINE_SIZE
+  uint16_t wr_cache;
+#endif
+}m_cfifo_tSpscFifo;
+
+/**
+ * @brief Signal hook of a batch handle, called after each publish.
+ *
+ * @param ctx User context given to @ref m_cfifo_Spsc_WriterSetSignal or
+ *            @ref m_cfifo_Spsc_ReaderSetSignal.
+ */
+typedef void (*m_cfifo_tSpscSignal)(void* ctx);
+
+/**
+ * @brief Producer-side batch handle with deferred publishing.
+ *
+ * Bytes pushed through the handle are written into the ring at the private
+ * index `wrPtr`; the FIFO's write index is only updated (one release store)
+ * and `signal` only called when `pending` reaches `batch_size`, when the
+ * ring runs full, or on @ref m_cfifo_Spsc_WriterFlush. `rd_cache` is the
+ * last read index seen and is only reloaded when it shows too little space.
+ *
+ * @warning While bytes are pending, the producer must not use
+ *          @ref m_cfifo_Spsc_Push / @ref m_cfifo_Spsc_PushN on the same
+ *          FIFO; flush first.
+ */
+typedef struct
+{
+  m_cfifo_tSpscFifo* fifo;
+  uint16_t wrPtr;
+  uint16_t rd_cache;
+  uint16_t pending;
+  uint16_t batch_size;
+  m_cfifo_tSpscSignal signal;
+  void* ctx;
+}m_cfifo_tSpscWriter;
+
+/**
+ * @brief Consumer-side batch handle with deferred release.
+ *
+ * Mirror of @ref m_cfifo_tSpscWriter: bytes are read at the private index
+ * `rdPtr`, and the space is released to the producer in batches of
+ * `batch_size`, when the cached write index `wr_cache` shows an empty
+ * ring, or on @ref m_cfifo_Spsc_ReaderFlush.
+ */
+typedef struct
+{
+  m_cfifo_tSpscFifo* fifo;
+  uint16_t rdPtr;
+  uint16_t wr_cache;
+  uint16_t pending;
+  uint16_t batch_size;
+  m_cfifo_tSpscSignal signal;
+  void* ctx;
+}m_cfifo_tSpscReader;
+
+
+//*****************************************************************************
+// Global Variable Declarations (Extern)
+//*****************************************************************************
+
+
+//*****************************************************************************
+// Global Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Initializes an SPSC FIFO instance to a known default state.
+ *
+ * After initialization the FIFO has no storage; push operations fail and
+ * pop operations report empty until @ref m_cfifo_Spsc_ConfigBuffer is called.
+ *
+ * @param fifo Pointer to the FIFO instance to initialize.
+ */
+void m_cfifo_Spsc_InitBuffer(m_cfifo_tSpscFifo* fifo);
+
+
+/**
+ * @brief Assigns a data buffer and size to the SPSC FIFO.
+ *
+ * Unlike @ref m_cfifo_ConfigBuffer, the FIFO is left empty after
+ * configuration, since a prefilled lock-free queue has no common use.
+ *
+ * @param fifo         Pointer to the FIFO instance.
+ * @param buffer       Pointer to a memory area for FIFO data.
+ * @param buffer_size  Size of the buffer in bytes
+ *                     (at most @ref M_CFIFO_SPSC_MAX_SIZE).
+ *
+ * @retval true  Buffer assigned.
+ * @retval false Buffer size exceeds @ref M_CFIFO_SPSC_MAX_SIZE.
+ */
+bool m_cfifo_Spsc_ConfigBuffer(m_cfifo_tSpscFifo* fifo, void* buffer, uint16_t buffer_size);
+
+
+/**
+ * @brief Clears all stored data in the SPSC FIFO.
+ *
+ * @warning Must not be called while the producer or consumer is active.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ */
+void m_cfifo_Spsc_Clear(m_cfifo_tSpscFifo* fifo);
+
+
+/**
+ * @brief Pushes a single byte (producer side).
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @param data Byte value to push.
+ *
+ * @retval true  Data successfully pushed.
+ * @retval false FIFO is full or unconfigured.
+ */
+bool m_cfifo_Spsc_Push(m_cfifo_tSpscFifo* fifo, uint8_t data);
+
+
+/**
+ * @brief Pushes a block of bytes (producer side).
+ *
+ * Copies as many bytes as fit with at most two memory copies and publishes
+ * them with a single release store of the write index.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @param data Pointer to the bytes to push.
+ * @param len  Number of bytes to push.
+ *
+ * @return Number of bytes actually pushed.
+ */
+uint16_t m_cfifo_Spsc_PushN(m_cfifo_tSpscFifo* fifo, const void* data, uint16_t len);
+
+
+/**
+ * @brief Pops a single byte (consumer side).
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @param data Output pointer to receive the popped byte (may be NULL).
+ *
+ * @retval true  Data successfully popped.
+ * @retval false FIFO is empty.
+ */
+bool m_cfifo_Spsc_Pop(m_cfifo_tSpscFifo* fifo, uint8_t* data);
+
+
+/**
+ * @brief Pops a block of bytes (consumer side).
+ *
+ * Copies up to @p len bytes with at most two memory copies and releases
+ * the space with a single release store of the read index.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @param data Output buffer for the popped bytes (may be NULL to discard).
+ * @param len  Maximum number of bytes to pop.
+ *
+ * @return Number of bytes actually popped.
+ */
+uint16_t m_cfifo_Spsc_PopN(m_cfifo_tSpscFifo* fifo, void* data, uint16_t len);
+
+
+/**
+ * @brief Returns the configured size of the SPSC FIFO.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @return Buffer size in bytes.
+ */
+uint16_t m_cfifo_Spsc_GetSize(m_cfifo_tSpscFifo* fifo);
+
+
+/**
+ * @brief Returns the number of stored bytes.
+ *
+ * The value is a snapshot; it may change immediately if the other side
+ * is active.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ * @return Number of stored bytes.
+ */
+uint16_t m_cfifo_Spsc_GetUsage(m_cfifo_tSpscFifo* fifo);
+
+
+/**
+ * @brief Checks whether the SPSC FIFO is empty.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ *
+ * @retval true  FIFO contains no data.
+ * @retval false FIFO has at least one byte stored.
+ */
+bool m_cfifo_Spsc_IsEmpty(m_cfifo_tSpscFifo* fifo);
+
+
+/**
+ * @brief Checks whether the SPSC FIFO is full.
+ *
+ * @param fifo Pointer to the FIFO instance.
+ *
+ * @retval true  FIFO has no remaining space.
+ * @retval false At least one byte can still be stored.
+ */
+bool m_cfifo_Spsc_IsFull(m_cfifo_tSpscFifo* fifo);
+
+
+/**
+ * @brief Attaches a producer batch handle to an SPSC FIFO.
+ *
+ * Must be called from the producer side, after the last direct push has
+ * completed. No signal hook is set.
+ *
+ * @param writer     Pointer to the handle to initialize.
+ * @param fifo       Pointer to a configured FIFO.
+ * @param batch_size Pending bytes that trigger a publish (0: only on flush
+ *                   or when the ring runs full).
+ */
+void m_cfifo_Spsc_WriterInit(m_cfifo_tSpscWriter* writer, m_cfifo_tSpscFifo* fifo, uint16_t batch_size);
+
+
+/**
+ * @brief Sets the hook called after each publish of a producer handle.
+ *
+ * Typical use is waking the consumer once per burst.
+ *
+ * @param writer Pointer to the handle.
+ * @param signal Hook, or NULL to disable.
+ * @param ctx    Context passed to @p signal.
+ */
+void m_cfifo_Spsc_WriterSetSignal(m_cfifo_tSpscWriter* writer, m_cfifo_tSpscSignal signal, void* ctx);
+
+
+/**
+ * @brief Writes a single byte through a producer handle.
+ *
+ * @param writer Pointer to the handle.
+ * @param data   Byte value to push.
+ *
+ * @retval true  Byte written (published with the batch).
+ * @retval false FIFO is full; pending bytes have been published.
+ */
+bool m_cfifo_Spsc_WriterPush(m_cfifo_tSpscWriter* writer, uint8_t data);
+
+
+/**
+ * @brief Writes a block of bytes through a producer handle.
+ *
+ * @param writer Pointer to the handle.
+ * @param data   Pointer to the bytes to push.
+ * @param len    Number of bytes to push.
+ *
+ * @return Number of bytes written (published with the batch).
+ */
+uint16_t m_cfifo_Spsc_WriterPushN(m_cfifo_tSpscWriter* writer, const void* data, uint16_t len);
+
+
+/**
+ * @brief Publishes all pending bytes of a producer handle.
+ *
+ * Does nothing (and does not signal) if no byte is pending.
+ *
+ * @param writer Pointer to the handle.
+ * @return Number of bytes published.
+ */
+uint16_t m_cfifo_Spsc_WriterFlush(m_cfifo_tSpscWriter* writer);
+
+
+/**
+ * @brief Attaches a consumer batch handle to an SPSC FIFO.
+ *
+ * Must be called from the consumer side, after the last direct pop has
+ * completed. No signal hook is set.
+ *
+ * @param reader     Pointer to the handle to initialize.
+ * @param fifo       Pointer to a configured FIFO.
+ * @param batch_size Consumed bytes that trigger a release (0: only on
+ *                   flush or when the ring runs empty).
+ */
+void m_cfifo_Spsc_ReaderInit(m_cfifo_tSpscReader* reader, m_cfifo_tSpscFifo* fifo, uint16_t batch_size);
+
+
+/**
+ * @brief Sets the hook called after each release of a consumer handle.
+ *
+ * @param reader Pointer to the handle.
+ * @param signal Hook, or NULL to disable.
+ * @param ctx    Context passed to @p signal.
+ */
+void m_cfifo_Spsc_ReaderSetSignal(m_cfifo_tSpscReader* reader, m_cfifo_tSpscSignal signal, void* ctx);
+
+
+/**
+ * @brief Reads a single byte through a consumer handle.
+ *
+ * @param reader Pointer to the handle.
+ * @param data   Output pointer for the byte (may be NULL).
+ *
+ * @retval true  Byte read (released with the batch).
+ * @retval false FIFO is empty; consumed bytes have been released.
+ */
+bool m_cfifo_Spsc_ReaderPop(m_cfifo_tSpscReader* reader, uint8_t* data);
+
+
+/**
+ * @brief Reads a block of bytes through a consumer handle.
+ *
+ * @param reader Pointer to the handle.
+ * @param data   Output buffer (may be NULL to discard).
+ * @param len    Maximum number of bytes to read.
+ *
+ * @return Number of bytes read (released with the batch).
+ */
+uint16_t m_cfifo_Spsc_ReaderPopN(m_cfifo_tSpscReader* reader, void* data, uint16_t len);
+
+
+/**
+ * @brief Releases the space of all consumed bytes of a consumer handle.
+ *
+ * @param reader Pointer to the handle.
+ * @return Number of bytes released.
+ */
+uint16_t m_cfifo_Spsc_ReaderFlush(m_cfifo_tSpscReader* reader);
+
+
+#endif /* M_CFIFO_SPSC_H_ */
@@ -0,0 +1,287 @@
+/**
+ * @file m_cfifo_static.h
+ * @brief Header-only circular byte FIFO with a compile-time capacity.
+ *
+ * This header provides a stripped-down variant of the circular byte FIFO
+ * whose whole implementation is `static inline`, so push and pop inline into
+ * the caller:
+ * - the capacity is a compile-time constant (a power of two), so the wrap
+ *   mask folds into the instructions
+ * - the storage is part of the FIFO object, so there is no `buffer == NULL`
+ *   check and no dummy-byte mode
+ * - indices run freely and the usage is `wrPtr - rdPtr`, as with
+ *   @ref M_CFIFO_FREE_RUNNING_INDEX
+ *
+ * A C FIFO type and its functions are generated with
+ * @ref M_CFIFO_STATIC_DEFINE; C++ code can use the `m_cfifo::StaticFifo<N>`
+ * template instead. Both share the helpers below.
+ *
+ * There are no cascades, statistics, hooks or locks. The FIFO is meant for a
+ * single context (or an external lock); use @ref m_cfifo_spsc.h to share a
+ * FIFO between a producer and a consumer without a lock. Nothing in this
+ * header needs `m_cfifo.c` at link time.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef M_CFIFO_STATIC_H_
+#define M_CFIFO_STATIC_H_
+
+
+#include "m_cfifo.h"
+#include <string.h>
+
+//*****************************************************************************
+// Global Defines
+//*****************************************************************************
+
+/**
+ * @brief Checks whether @p capacity is a valid static FIFO capacity.
+ *
+ * The capacity must be a power of two and at most half of
+ * @ref M_CFIFO_INDEX_MAX + 1, so that a full FIFO is still told apart from
+ * an empty one by the free-running indices.
+ *
+ * @param capacity Number of bytes the FIFO can hold.
+ */
+#define M_CFIFO_STATIC_IS_VALID(capacity) \
+  ((capacity) > 0u && ((capacity) & ((capacity) - 1u)) == 0u && \
+   (capacity) <= (M_CFIFO_INDEX_MAX / 2u) + 1u)
+
+#ifdef __cplusplus
+#define M_CFIFO_STATIC_ASSERT(cond, msg)  static_assert(cond, msg)
+#else
+#define M_CFIFO_STATIC_ASSERT(cond, msg)  _Static_assert(cond, msg)
+#endif
+
+/**
+ * @brief Initializer for a FIFO declared with @ref M_CFIFO_STATIC_DEFINE.
+ *
+ * A zero-initialized (e.g. static) FIFO is empty as well, so this is only
+ * needed for automatic variables.
+ */
+#define M_CFIFO_STATIC_INIT   { 0, 0, { 0 } }
+
+/**
+ * @brief Defines a static FIFO type and its inline functions.
+ *
+ * For `M_CFIFO_STATIC_DEFINE(uart_rx, 64);` this defines:
+ * - `uart_rx_tFifo`: FIFO type with 64 bytes of storage
+ * - `uart_rx_Clear`, `uart_rx_Push`, `uart_rx_Pop`, `uart_rx_PushN`,
+ *   `uart_rx_PopN`, `uart_rx_GetSize`, `uart_rx_GetUsage`, `uart_rx_GetFree`,
+ *   `uart_rx_IsEmpty` and `uart_rx_IsFull`, with the semantics of the
+ *   corresponding `m_cfifo_This_*` functions
+ *
+ * Use it at file scope, in a header or in the translation unit that owns
+ * the FIFO; every function is `static inline`.
+ *
+ * @param name     Prefix of the generated type and functions.
+ * @param capacity Number of bytes, see @ref M_CFIFO_STATIC_IS_VALID.
+ */
+#define M_CFIFO_STATIC_DEFINE(name, capacity)                                              \
+  typedef struct { m_cfifo_tIndex rdPtr; m_cfifo_tIndex wrPtr; uint8_t buffer[capacity]; } name##_tFifo; \
+  static inline void name##_Clear(name##_tFifo* fifo)                                      \
+  { fifo->rdPtr = fifo->wrPtr; }                                                           \
+  static inline bool name##_Push(name##_tFifo* fifo, uint8_t data)                         \
+  { return m_cfifo_Static_Push(fifo->buffer, (capacity) - 1u, fifo->rdPtr, &fifo->wrPtr, data); } \
+  static inline bool name##_Pop(name##_tFifo* fifo, uint8_t* data)                         \
+  { return m_cfifo_Static_Pop(fifo->buffer, (capacity) - 1u, &fifo->rdPtr, fifo->wrPtr, data); } \
+  static inline m_cfifo_tIndex name##_PushN(name##_tFifo* fifo, const void* data, m_cfifo_tIndex len) \
+  { return m_cfifo_Static_PushN(fifo->buffer, (capacity) - 1u, fifo->rdPtr, &fifo->wrPtr, data, len); } \
+  static inline m_cfifo_tIndex name##_PopN(name##_tFifo* fifo, void* data, m_cfifo_tIndex len) \
+  { return m_cfifo_Static_PopN(fifo->buffer, (capacity) - 1u, &fifo->rdPtr, fifo->wrPtr, data, len); } \
+  static inline m_cfifo_tIndex name##_GetSize(void)                                        \
+  { return (m_cfifo_tIndex)(capacity); }                                                   \
+  static inline m_cfifo_tIndex name##_GetUsage(const name##_tFifo* fifo)                   \
+  { return (m_cfifo_tIndex)(fifo->wrPtr - fifo->rdPtr); }                                  \
+  static inline m_cfifo_tIndex name##_GetFree(const name##_tFifo* fifo)                    \
+  { return (m_cfifo_tIndex)((capacity) - name##_GetUsage(fifo)); }                         \
+  static inline bool name##_IsEmpty(const name##_tFifo* fifo)                              \
+  { return fifo->wrPtr == fifo->rdPtr; }                                                   \
+  static inline bool name##_IsFull(const name##_tFifo* fifo)                               \
+  { return name##_GetUsage(fifo) == (capacity); }                                         \
+  M_CFIFO_STATIC_ASSERT(M_CFIFO_STATIC_IS_VALID(capacity),                                 \
+                        "static FIFO capacity must be a power of two within the index range")
+
+
+//*****************************************************************************
+// Global Inline Functions
+//*****************************************************************************
+
+/**
+ * @brief Pushes one byte into a static FIFO.
+ *
+ * @param buffer Storage of `mask + 1` bytes.
+ * @param mask   Capacity minus one (a compile-time constant at the call site).
+ * @param rdPtr  Free-running read index.
+ * @param wrPtr  Free-running write index, advanced on success.
+ * @param data   Byte to push.
+ *
+ * @retval true  Byte pushed.
+ * @retval false FIFO is full.
+ */
+static inline bool m_cfifo_Static_Push(uint8_t* buffer, m_cfifo_tIndex mask, m_cfifo_tIndex rdPtr, m_cfifo_tIndex* wrPtr, uint8_t data)
+{
+  m_cfifo_tIndex wr = *wrPtr;
+
+  if ((m_cfifo_tIndex)(wr - rdPtr) > mask)
+    return false;
+
+  buffer[wr & mask] = data;
+  *wrPtr = (m_cfifo_tIndex)(wr + 1u);
+
+  return true;
+}
+
+/**
+ * @brief Pops one byte from a static FIFO.
+ *
+ * @param buffer Storage of `mask + 1` bytes.
+ * @param mask   Capacity minus one.
+ * @param rdPtr  Free-running read index, advanced on success.
+ * @param wrPtr  Free-running write index.
+ * @param data   Output byte (may be NULL to discard).
+ *
+ * @retval true  Byte popped.
+ * @retval false FIFO is empty.
+ */
+static inline bool m_cfifo_Static_Pop(const uint8_t* buffer, m_cfifo_tIndex mask, m_cfifo_tIndex* rdPtr, m_cfifo_tIndex wrPtr, uint8_t* data)
+{
+  m_cfifo_tIndex rd = *rdPtr;
+
+  if (rd == wrPtr)
+    return false;
+
+  if (data != NULL)
+    *data = buffer[rd & mask];
+  *rdPtr = (m_cfifo_tIndex)(rd + 1u);
+
+  return true;
+}
+
+/**
+ * @brief Pushes up to @p len bytes into a static FIFO.
+ *
+ * The copy is split at the wrap point into at most two `memcpy` calls.
+ *
+ * @param buffer Storage of `mask + 1` bytes.
+ * @param mask   Capacity minus one.
+ * @param rdPtr  Free-running read index.
+ * @param wrPtr  Free-running write index, advanced by the pushed count.
+ * @param data   Source bytes.
+ * @param len    Number of bytes to push.
+ * @return Number of bytes pushed (less than @p len if the FIFO fills).
+ */
+static inline m_cfifo_tIndex m_cfifo_Static_PushN(uint8_t* buffer, m_cfifo_tIndex mask, m_cfifo_tIndex rdPtr, m_cfifo_tIndex* wrPtr,
+                                                  const void* data, m_cfifo_tIndex len)
+{
+  const uint8_t* src = (const uint8_t*)data;
+  m_cfifo_tIndex wr = *wrPtr;
+  m_cfifo_tIndex room = (m_cfifo_tIndex)(mask + 1u - (m_cfifo_tIndex)(wr - rdPtr));
+  m_cfifo_tIndex pos = (m_cfifo_tIndex)(wr & mask);
+  m_cfifo_tIndex first = (m_cfifo_tIndex)(mask + 1u - pos);
+
+  if (len > room)
+    len = room;
+  if (first > len)
+    first = len;
+
+  memcpy(&buffer[pos], src, first);
+  if (len > first)
+    memcpy(buffer, &src[first], (size_t)(len - first));
+  *wrPtr = (m_cfifo_tIndex)(wr + len);
+
+  return len;
+}
+
+/**
+ * @brief Pops up to @p len bytes from a static FIFO.
+ *
+ * @param buffer Storage of `mask + 1` bytes.
+ * @param mask   Capacity minus one.
+ * @param rdPtr  Free-running read index, advanced by the popped count.
+ * @param wrPtr  Free-running write index.
+ * @param data   Destination (may be NULL to discard).
+ * @param len    Maximum number of bytes to pop.
+ * @return Number of bytes popped (less than @p len if the FIFO empties).
+ */
+static inline m_cfifo_tIndex m_cfifo_Static_PopN(const uint8_t* buffer, m_cfifo_tIndex mask, m_cfifo_tIndex* rdPtr, m_cfifo_tIndex wrPtr,
+                                                 void* data, m_cfifo_tIndex len)
+{
+  uint8_t* dst = (uint8_t*)data;
+  m_cfifo_tIndex rd = *rdPtr;
+  m_cfifo_tIndex used = (m_cfifo_tIndex)(wrPtr - rd);
+  m_cfifo_tIndex pos = (m_cfifo_tIndex)(rd & mask);
+  m_cfifo_tIndex first = (m_cfifo_tIndex)(mask + 1u - pos);
+
+  if (len > used)
+    len = used;
+  if (first > len)
+    first = len;
+
+  if (dst != NULL)
+  {
+    memcpy(dst, &buffer[pos], first);
+    if (len > first)
+      memcpy(&dst[first], buffer, (size_t)(len - first));
+  }
+  *rdPtr = (m_cfifo_tIndex)(rd + len);
+
+  return len;
+}
+
+
+//*****************************************************************************
+// C++ Wrapper
+//*****************************************************************************
+
+#ifdef __cplusplus
+namespace m_cfifo
+{
+
+/**
+ * @brief Static FIFO with a capacity of @p N bytes.
+ *
+ * Same layout and semantics as a type defined with
+ * @ref M_CFIFO_STATIC_DEFINE; a default-constructed FIFO is empty.
+ *
+ * @tparam N Number of bytes, see @ref M_CFIFO_STATIC_IS_VALID.
+ */
+template<size_t N>
+class StaticFifo
+{
+  static_assert(M_CFIFO_STATIC_IS_VALID(N), "static FIFO capacity must be a power of two within the index range");
+
+public:
+  static constexpr m_cfifo_tIndex Capacity = static_cast<m_cfifo_tIndex>(N);
+
+  void Clear() { rdPtr = wrPtr; }
+
+  bool Push(uint8_t data) { return m_cfifo_Static_Push(buffer, Mask, rdPtr, &wrPtr, data); }
+  bool Pop(uint8_t* data) { return m_cfifo_Static_Pop(buffer, Mask, &rdPtr, wrPtr, data); }
+  bool Pop(uint8_t& data) { return m_cfifo_Static_Pop(buffer, Mask, &rdPtr, wrPtr, &data); }
+
+  m_cfifo_tIndex PushN(const void* data, m_cfifo_tIndex len) { return m_cfifo_Static_PushN(buffer, Mask, rdPtr, &wrPtr, data, len); }
+  m_cfifo_tIndex PopN(void* data, m_cfifo_tIndex len) { return m_cfifo_Static_PopN(buffer, Mask, &rdPtr, wrPtr, data, len); }
+
+  m_cfifo_tIndex GetUsage() const { return static_cast<m_cfifo_tIndex>(wrPtr - rdPtr); }
+  m_cfifo_tIndex GetFree() const { return static_cast<m_cfifo_tIndex>(Capacity - GetUsage()); }
+  bool IsEmpty() const { return wrPtr == rdPtr; }
+  bool IsFull() const { return GetUsage() == Capacity; }
+
+private:
+  static constexpr m_cfifo_tIndex Mask = static_cast<m_cfifo_tIndex>(N - 1u);
+
+  m_cfifo_tIndex rdPtr = 0;
+  m_cfifo_tIndex wrPtr = 0;
+  uint8_t buffer[N];
+};
+
+} // namespace m_cfifo
+#endif
+
+
+#endif /* M_CFIFO_STATIC_H_ */
@@ -0,0 +1,446 @@
+/**
+ * @file m_cfifo_flash_test.c
+ * @brief Page log test against a RAM-simulated NOR flash.
+ *
+ * The simulated device behaves like NOR flash: erase sets a sector to
+ * @ref M_CFIFO_FLASH_ERASED, programming can only clear bits, and it can
+ * be told to fail or tear (program half a page and lose power) the n-th
+ * program call. Programming a byte that is not erased is recorded as an
+ * error, since the log must never reprogram a page.
+ *
+ * The logged stream is a sequence pattern, so the read back data can be
+ * checked to be exactly the newest part of everything appended:
+ * - `remount_wrap`: appends several times the flash size with a remount
+ *   after every round, checks that the oldest data is dropped a sector at
+ *   a time and that the erases are spread evenly.
+ * - `torn_page`: a reset while a page is programmed; the torn page is
+ *   skipped after the remount and the log continues behind it.
+ * - `failed_program`: a failing and a partly programming driver call; the
+ *   page is skipped and no staged byte is lost.
+ *
+ * Exit status: 0 passed, 1 failed.
+ *
+ * @see m_cfifo_flash.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#include "m_cfifo.h"
+#include "m_cfifo_flash.h"
+#include <stdio.h>
+#include <string.h>
+
+
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#define TEST_BASE             0x08000000u
+#define TEST_PAGE_SIZE        64u
+#define TEST_PAGES_PER_SECTOR 4u
+#define TEST_SECTOR_COUNT     4u
+#define TEST_SECTOR_SIZE      (TEST_PAGE_SIZE * TEST_PAGES_PER_SECTOR)
+#define TEST_FLASH_SIZE       (TEST_SECTOR_SIZE * TEST_SECTOR_COUNT)
+#define TEST_PAYLOAD          (TEST_PAGE_SIZE - sizeof(m_cfifo_tFlashPage))
+#define TEST_PATTERN_PERIOD   251u
+#define TEST_ROUNDS           24u
+
+#define TEST_CHECK(cond) \
+  do { if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); return false; } } while (0)
+
+
+
+//*****************************************************************************
+// Local Types
+//*****************************************************************************
+
+/**
+ * @brief RAM-simulated NOR flash.
+ *
+ * `fail_at`/`tear_at` make the program call with that number (counted
+ * from 1 in `program_count`) fail without writing, or write half of the
+ * page and leave the device powered off. A powered off device fails every
+ * call until `powered` is set again.
+ */
+typedef struct
+{
+  uint8_t mem[TEST_FLASH_SIZE];
+  uint32_t sector_erases[TEST_SECTOR_COUNT];
+  uint32_t program_count;
+  uint32_t fail_at;
+  uint32_t tear_at;
+  bool tear_partial_only;
+  bool powered;
+  bool overwritten;
+}test_tFlash;
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Erases the simulated flash and resets its fault injection.
+ */
+static void test_FlashReset(test_tFlash* flash);
+
+/**
+ * @brief Driver read callback of the simulated flash.
+ */
+static bool test_FlashRead(void* ctx, uint32_t addr, void* data, uint32_t len);
+
+/**
+ * @brief Driver program callback of the simulated flash.
+ */
+static bool test_FlashProgram(void* ctx, uint32_t addr, const void* data, uint32_t len);
+
+/**
+ * @brief Driver erase callback of the simulated flash.
+ */
+static bool test_FlashErase(void* ctx, uint32_t addr);
+
+/**
+ * @brief Returns byte @p k of the test stream.
+ */
+static uint8_t test_Pattern(uint32_t k);
+
+/**
+ * @brief Simulates a reset: initializes and mounts @p log from flash.
+ *
+ * @return Number of valid pages found.
+ */
+static uint32_t test_Remount(m_cfifo_tFlashLog* log, test_tFlash* flash);
+
+/**
+ * @brief Appends stream bytes [@p from, @p to) in chunks of varying size.
+ *
+ * Retries short appends, as an application would after a driver error.
+ */
+static bool test_AppendStream(m_cfifo_tFlashLog* log, uint32_t from, uint32_t to);
+
+/**
+ * @brief Reads the whole log and checks that it ends at stream byte @p total.
+ *
+ * @return Number of bytes read.
+ */
+static uint32_t test_ReadSuffix(m_cfifo_tFlashLog* log, uint32_t total, bool* ok);
+
+static bool test_RemountWrap(void);
+static bool test_TornPage(void);
+static bool test_FailedProgram(void);
+
+
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static test_tFlash test_flash;
+static uint8_t test_page[TEST_PAGE_SIZE];
+static uint8_t test_read_buffer[TEST_FLASH_SIZE];
+
+static const m_cfifo_tFlashDevice test_device =
+{
+  test_FlashRead, test_FlashProgram, test_FlashErase, &test_flash,
+  TEST_BASE, TEST_PAGE_SIZE, TEST_PAGES_PER_SECTOR, TEST_SECTOR_COUNT
+};
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+int main(void)
+{
+  int failed = 0;
+
+  struct
+  {
+    const char* name;
+    bool (*run)(void);
+  }tests[] =
+  {
+    { "remount_wrap", test_RemountWrap },
+    { "torn_page", test_TornPage },
+    { "failed_program", test_FailedProgram },
+  };
+  size_t i;
+
+  for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+  {
+    bool ok = tests[i].run();
+
+    printf("%s %s\n", ok ? "PASS" : "FAIL", tests[i].name);
+    if (!ok)
+      failed = 1;
+  }
+
+  return failed;
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static void test_FlashReset(test_tFlash* flash)
+{
+  memset(flash, 0, sizeof(*flash));
+  memset(flash->mem, M_CFIFO_FLASH_ERASED, sizeof(flash->mem));
+  flash->powered = true;
+}
+
+static bool test_FlashRead(void* ctx, uint32_t addr, void* data, uint32_t len)
+{
+  test_tFlash* flash = (test_tFlash*)ctx;
+
+  if (!flash->powered || addr < TEST_BASE || addr - TEST_BASE + len > TEST_FLASH_SIZE)
+    return false;
+
+  memcpy(data, &flash->mem[addr - TEST_BASE], len);
+  return true;
+}
+
+static bool test_FlashProgram(void* ctx, uint32_t addr, const void* data, uint32_t len)
+{
+  test_tFlash* flash = (test_tFlash*)ctx;
+  const uint8_t* src = (const uint8_t*)data;
+  uint32_t offset = addr - TEST_BASE;
+  uint32_t i;
+
+  if (!flash->powered || addr < TEST_BASE || offset + len > TEST_FLASH_SIZE)
+    return false;
+
+  flash->program_count++;
+  if (flash->program_count == flash->fail_at)
+    return false;
+
+  if (flash->program_count == flash->tear_at)
+  {
+    // Half a page made it before the power was gone
+    len /= 2u;
+    if (!flash->tear_partial_only)
+      flash->powered = false;
+  }
+
+  for (i = 0; i < len; i++)
+  {
+    if (flash->mem[offset + i] != M_CFIFO_FLASH_ERASED)
+      flash->overwritten = true;
+    flash->mem[offset + i] &= src[i];
+  }
+
+  return flash->program_count != flash->tear_at;
+}
+
+static bool test_FlashErase(void* ctx, uint32_t addr)
+{
+  test_tFlash* flash = (test_tFlash*)ctx;
+  uint32_t offset = addr - TEST_BASE;
+
+  if (!flash->powered || addr < TEST_BASE || offset >= TEST_FLASH_SIZE || offset % TEST_SECTOR_SIZE != 0)
+    return false;
+
+  memset(&flash->mem[offset], M_CFIFO_FLASH_ERASED, TEST_SECTOR_SIZE);
+  flash->sector_erases[offset / TEST_SECTOR_SIZE]++;
+  return true;
+}
+
+static uint8_t test_Pattern(uint32_t k)
+{
+  return (uint8_t)(k % TEST_PATTERN_PERIOD);
+}
+
+static uint32_t test_Remount(m_cfifo_tFlashLog* log, test_tFlash* flash)
+{
+  flash->powered = true;
+  memset(log, 0, sizeof(*log));
+  if (!m_cfifo_Flash_Init(log, &test_device, test_page))
+    return 0;
+
+  return m_cfifo_Flash_Mount(log);
+}
+
+static bool test_AppendStream(m_cfifo_tFlashLog* log, uint32_t from, uint32_t to)
+{
+  uint8_t chunk[97];
+  uint32_t len = 1;
+  uint32_t retries = 0;
+  uint32_t i;
+
+  while (from < to)
+  {
+    uint32_t n = (to - from < len) ? to - from : len;
+    uint32_t done;
+
+    for (i = 0; i < n; i++)
+      chunk[i] = test_Pattern(from + i);
+
+    done = m_cfifo_Flash_Append(log, chunk, n);
+    if (done < n && ++retries > TEST_PAGES_PER_SECTOR)
+      return false;
+
+    from += done;
+    len = len % sizeof(chunk) + 13u;
+  }
+
+  return true;
+}
+
+static uint32_t test_ReadSuffix(m_cfifo_tFlashLog* log, uint32_t total, bool* ok)
+{
+  uint32_t n;
+  uint32_t i;
+
+  m_cfifo_Flash_Rewind(log);
+  n = m_cfifo_Flash_Read(log, test_read_buffer, sizeof(test_read_buffer));
+
+  *ok = n <= total && m_cfifo_Flash_Read(log, test_read_buffer, 1) == 0;
+  for (i = 0; *ok && i < n; i++)
+  {
+    if (test_read_buffer[i] != test_Pattern(total - n + i))
+    {
+      printf("byte %u of %u is 0x%02x, expected 0x%02x\n", (unsigned)i, (unsigned)n,
+             (unsigned)test_read_buffer[i], (unsigned)test_Pattern(total - n + i));
+      *ok = false;
+    }
+  }
+
+  return n;
+}
+
+static bool test_RemountWrap(void)
+{
+  m_cfifo_tFlashLog log;
+  m_cfifo_tCFifo cfifo;
+  uint8_t fifo_buffer[64];
+  uint8_t chunk[40];
+  uint32_t total = 0;
+  uint32_t round;
+  uint32_t retained;
+  uint32_t erases = 0;
+  uint32_t min_erases;
+  uint32_t max_erases;
+  uint32_t i;
+  bool ok;
+
+  test_FlashReset(&test_flash);
+  TEST_CHECK(test_Remount(&log, &test_flash) == 0);
+  TEST_CHECK(m_cfifo_Flash_GetPagePayload(&log) == TEST_PAYLOAD);
+  TEST_CHECK(test_ReadSuffix(&log, 0, &ok) == 0 && ok);
+
+  m_cfifo_InitBuffer(&cfifo);
+  m_cfifo_ConfigBuffer(&cfifo, fifo_buffer, sizeof(fifo_buffer));
+  m_cfifo_This_Clear(&cfifo);
+
+  for (round = 0; round < TEST_ROUNDS; round++)
+  {
+    TEST_CHECK(test_AppendStream(&log, total, total + 150u));
+    total += 150u;
+
+    // Drain a part of the stream through a FIFO
+    for (i = 0; i < sizeof(chunk); i++)
+      chunk[i] = test_Pattern(total + i);
+    TEST_CHECK(m_cfifo_This_PushN(&cfifo, chunk, sizeof(chunk)) == sizeof(chunk));
+    TEST_CHECK(m_cfifo_Flash_AppendFifo(&log, &cfifo, sizeof(chunk) / 2u) == sizeof(chunk) / 2u);
+    TEST_CHECK(m_cfifo_Flash_AppendFifo(&log, &cfifo, 1000u) == sizeof(chunk) / 2u);
+    TEST_CHECK(m_cfifo_This_GetUsage(&cfifo) == 0);
+    total += sizeof(chunk);
+
+    TEST_CHECK(m_cfifo_Flash_Flush(&log));
+    erases += log.erase_count;
+
+    TEST_CHECK(test_Remount(&log, &test_flash) != 0);
+    retained = test_ReadSuffix(&log, total, &ok);
+    TEST_CHECK(ok);
+
+    // At least all sectors but the reserved one and the one being filled,
+    // whose pages are at least half full with this flush pattern
+    if (total >= TEST_FLASH_SIZE)
+      TEST_CHECK(retained >= (TEST_SECTOR_COUNT - 2u) * TEST_PAGES_PER_SECTOR * (TEST_PAYLOAD / 2u));
+    else
+      TEST_CHECK(retained <= total);
+  }
+
+  TEST_CHECK(total > 3u * TEST_FLASH_SIZE);
+  TEST_CHECK(!test_flash.overwritten);
+
+  // Sectors are erased in a circle, and the log counted every erase
+  min_erases = max_erases = test_flash.sector_erases[0];
+  for (i = 0; i < TEST_SECTOR_COUNT; i++)
+  {
+    if (test_flash.sector_erases[i] < min_erases)
+      min_erases = test_flash.sector_erases[i];
+    if (test_flash.sector_erases[i] > max_erases)
+      max_erases = test_flash.sector_erases[i];
+    erases -= test_flash.sector_erases[i];
+  }
+  TEST_CHECK(erases == 0);
+  TEST_CHECK(min_erases > 1u && max_erases - min_erases <= 1u);
+
+  return true;
+}
+
+static bool test_TornPage(void)
+{
+  m_cfifo_tFlashLog log;
+  uint32_t payload = TEST_PAYLOAD;
+  bool ok;
+
+  test_FlashReset(&test_flash);
+  TEST_CHECK(test_Remount(&log, &test_flash) == 0);
+
+  // Two full pages, then the power fails while the third is programmed
+  TEST_CHECK(m_cfifo_Flash_Append(&log, test_read_buffer, 0) == 0);
+  TEST_CHECK(test_AppendStream(&log, 0, 2u * payload));
+  test_flash.tear_at = test_flash.program_count + 1u;
+  TEST_CHECK(!test_AppendStream(&log, 2u * payload, 3u * payload + 10u));
+  TEST_CHECK(!test_flash.powered);
+
+  // The torn page is neither valid nor erased and must be skipped
+  TEST_CHECK(test_Remount(&log, &test_flash) == 2u);
+  TEST_CHECK(log.tail_page == 0 && log.wr_page == 3u);
+  TEST_CHECK(test_ReadSuffix(&log, 2u * payload, &ok) == 2u * payload && ok);
+
+  // The staged bytes were lost with the power; the stream continues after the last page
+  TEST_CHECK(test_AppendStream(&log, 2u * payload, 5u * payload));
+  TEST_CHECK(test_Remount(&log, &test_flash) == 5u);
+  TEST_CHECK(test_ReadSuffix(&log, 5u * payload, &ok) == 5u * payload && ok);
+  TEST_CHECK(!test_flash.overwritten);
+
+  return true;
+}
+
+static bool test_FailedProgram(void)
+{
+  m_cfifo_tFlashLog log;
+  uint32_t payload = TEST_PAYLOAD;
+  bool ok;
+
+  test_FlashReset(&test_flash);
+  TEST_CHECK(test_Remount(&log, &test_flash) == 0);
+
+  // The second page fails without writing, the fourth writes half a page
+  test_flash.fail_at = 2u;
+  test_flash.tear_at = 4u;
+  test_flash.tear_partial_only = true;
+  TEST_CHECK(test_AppendStream(&log, 0, 4u * payload + 7u));
+  TEST_CHECK(m_cfifo_Flash_Flush(&log));
+  TEST_CHECK(test_flash.program_count == 7u);
+
+  // Nothing is lost while the log is mounted ...
+  TEST_CHECK(test_ReadSuffix(&log, 4u * payload + 7u, &ok) == 4u * payload + 7u && ok);
+
+  // ... nor after a remount, which skips both failed pages
+  TEST_CHECK(test_Remount(&log, &test_flash) == 5u);
+  TEST_CHECK(log.wr_page == 7u);
+  TEST_CHECK(test_ReadSuffix(&log, 4u * payload + 7u, &ok) == 4u * payload + 7u && ok);
+  TEST_CHECK(!test_flash.overwritten);
+
+  return true;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file m_cfifo_persist_test.c
+ * @brief Recovery test for the persistent FIFO header.
+ *
+ * The header and the buffer live in a "retained" block that survives a
+ * simulated reset, while the FIFO structure is wiped and set up again with
+ * @ref m_cfifo_ConfigPersistBuffer:
+ * - `cold_start`: a garbage header is rejected and the FIFO starts empty.
+ * - `recover`: content and indices come back after a reset, also with the
+ *   stored bytes wrapped around the end of the buffer.
+ * - `torn_update`: a reset in the middle of a header update falls back to
+ *   the previous copy, and the next update repairs the header.
+ * - `invalid`: two bad copies or a different buffer size are rejected.
+ *
+ * Needs `M_CFIFO_PERSIST=1`. Exit status: 0 passed, 1 failed.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#include "m_cfifo.h"
+#include <stdio.h>
+#include <string.h>
+
+#if !M_CFIFO_PERSIST
+#error "m_cfifo_persist_test needs M_CFIFO_PERSIST=1"
+#endif
+
+
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#define TEST_BUFFER_SIZE    64u
+#define TEST_PATTERN_PERIOD 251u
+
+#define TEST_CHECK(cond) \
+  do { if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); return false; } } while (0)
+
+
+
+//*****************************************************************************
+// Local Types
+//*****************************************************************************
+
+/**
+ * @brief Memory that survives a reset.
+ */
+typedef struct
+{
+  m_cfifo_tPersist persist;
+  uint8_t buffer[TEST_BUFFER_SIZE];
+}test_tRetained;
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Simulates a reset: wipes the FIFO and recovers it from the header.
+ *
+ * @return Result of @ref m_cfifo_ConfigPersistBuffer.
+ */
+static bool test_Reset(m_cfifo_tIndex buffer_size);
+
+/**
+ * @brief Pushes stream bytes [@p from, @p from + @p len).
+ */
+static bool test_Push(uint32_t from, uint32_t len);
+
+/**
+ * @brief Pops @p len bytes and checks that they are stream bytes from @p from on.
+ */
+static bool test_Pop(uint32_t from, uint32_t len);
+
+/**
+ * @brief Returns the header copy written last.
+ */
+static m_cfifo_tPersistCopy* test_NewestCopy(void);
+
+static bool test_ColdStart(void);
+static bool test_Recover(void);
+static bool test_TornUpdate(void);
+static bool test_Invalid(void);
+
+
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static test_tRetained test_retained;
+static m_cfifo_tCFifo test_cfifo;
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+int main(void)
+{
+  int failed = 0;
+
+  struct
+  {
+    const char* name;
+    bool (*run)(void);
+  }tests[] =
+  {
+    { "cold_start", test_ColdStart },
+    { "recover", test_Recover },
+    { "torn_update", test_TornUpdate },
+    { "invalid", test_Invalid },
+  };
+  size_t i;
+
+  for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+  {
+    bool ok = tests[i].run();
+
+    printf("%s %s\n", ok ? "PASS" : "FAIL", tests[i].name);
+    if (!ok)
+      failed = 1;
+  }
+
+  return failed;
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static bool test_Reset(m_cfifo_tIndex buffer_size)
+{
+  memset(&test_cfifo, 0xA5, sizeof(test_cfifo));
+  m_cfifo_InitBuffer(&test_cfifo);
+
+  return m_cfifo_ConfigPersistBuffer(&test_cfifo, &test_retained.persist, test_retained.buffer, buffer_size);
+}
+
+static bool test_Push(uint32_t from, uint32_t len)
+{
+  uint8_t data[TEST_BUFFER_SIZE];
+  uint32_t i;
+
+  for (i = 0; i < len; i++)
+    data[i] = (uint8_t)((from + i) % TEST_PATTERN_PERIOD);
+
+  return m_cfifo_This_PushN(&test_cfifo, data, (m_cfifo_tIndex)len) == len;
+}
+
+static bool test_Pop(uint32_t from, uint32_t len)
+{
+  uint8_t data[TEST_BUFFER_SIZE];
+  uint32_t i;
+
+  if (m_cfifo_This_PopN(&test_cfifo, data, (m_cfifo_tIndex)len) != len)
+    return false;
+
+  for (i = 0; i < len; i++)
+  {
+    if (data[i] != (uint8_t)((from + i) % TEST_PATTERN_PERIOD))
+      return false;
+  }
+
+  return true;
+}
+
+static m_cfifo_tPersistCopy* test_NewestCopy(void)
+{
+  m_cfifo_tPersist* persist = &test_retained.persist;
+
+  if ((int8_t)(uint8_t)(persist->copy[1].sequence - persist->copy[0].sequence) > 0)
+    return &persist->copy[1];
+  return &persist->copy[0];
+}
+
+static bool test_ColdStart(void)
+{
+  memset(&test_retained, 0x5A, sizeof(test_retained));
+
+  TEST_CHECK(!test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 0);
+  TEST_CHECK(m_cfifo_This_GetSize(&test_cfifo) == TEST_BUFFER_SIZE);
+
+  // The fresh header is valid right away
+  TEST_CHECK(test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 0);
+
+  return true;
+}
+
+static bool test_Recover(void)
+{
+  memset(&test_retained, 0, sizeof(test_retained));
+  TEST_CHECK(!test_Reset(TEST_BUFFER_SIZE));
+
+  TEST_CHECK(test_Push(0, 40u));
+  TEST_CHECK(test_Pop(0, 15u));
+  TEST_CHECK(test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 25u);
+
+  // Wrap the stored bytes around the end of the buffer
+  TEST_CHECK(test_Pop(15u, 20u));
+  TEST_CHECK(test_Push(40u, 50u));
+  TEST_CHECK(test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 55u);
+  TEST_CHECK(test_Pop(35u, 55u));
+
+  TEST_CHECK(test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 0);
+
+  return true;
+}
+
+static bool test_TornUpdate(void)
+{
+  memset(&test_retained, 0, sizeof(test_retained));
+  TEST_CHECK(!test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(test_Push(0, 30u));
+  TEST_CHECK(test_Pop(0, 10u));
+
+  // The reset hits the header update of the next push after it was invalidated
+  TEST_CHECK(test_Push(30u, 5u));
+  test_NewestCopy()->magic = 0;
+
+  TEST_CHECK(test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 20u);
+
+  // Same, with the checksum not yet written
+  TEST_CHECK(test_Push(30u, 5u));
+  test_NewestCopy()->check ^= 1u;
+
+  TEST_CHECK(test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 20u);
+
+  // The next update completes and is the one recovered
+  TEST_CHECK(test_Push(30u, 5u));
+  TEST_CHECK(test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 25u);
+  TEST_CHECK(test_Pop(10u, 25u));
+
+  return true;
+}
+
+static bool test_Invalid(void)
+{
+  memset(&test_retained, 0, sizeof(test_retained));
+  TEST_CHECK(!test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(test_Push(0, 12u));
+
+  // Both copies damaged
+  test_retained.persist.copy[0].check ^= 1u;
+  test_retained.persist.copy[1].check ^= 1u;
+  TEST_CHECK(!test_Reset(TEST_BUFFER_SIZE));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 0);
+
+  // A header written for another buffer size
+  TEST_CHECK(test_Push(0, 12u));
+  TEST_CHECK(!test_Reset(TEST_BUFFER_SIZE / 2u));
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_cfifo) == 0);
+
+  return true;
+}
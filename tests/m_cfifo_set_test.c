@@ -0,0 +1,324 @@
+/**
+ * @file m_cfifo_set_test.c
+ * @brief Scheduling test for the queue set.
+ *
+ * Each queue holds bytes tagged with its slot number, so every pop can be
+ * checked against the slot the set reports:
+ * - `strict_order`: the lowest ready slot is always served first, also when
+ *   a higher priority queue becomes ready in between.
+ * - `drr_shares`: backlogged queues get byte shares in the ratio of their
+ *   quanta, at most one deficit per call.
+ * - `drr_stale_ready`: a queue emptied behind the set's back leaves a stale
+ *   ready bit with a remaining deficit; the next queue must still get its
+ *   full quantum in the same call.
+ * - `drr_msg_deficit`: a message larger than the deficit waits until enough
+ *   rounds have passed, while a queue with small messages keeps being
+ *   served.
+ * - `msg_partial`: a queue holding only part of a message is skipped and
+ *   served once the message is complete.
+ *
+ * Exit status: 0 passed, 1 failed.
+ *
+ * @see m_cfifo_set.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#include "m_cfifo.h"
+#include "m_cfifo_set.h"
+#include <stdio.h>
+#include <string.h>
+
+
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#define TEST_QUEUES      3u
+#define TEST_BUFFER_SIZE 4096u
+#define TEST_CHUNK       1000u
+
+#define TEST_CHECK(cond) \
+  do { if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); return false; } } while (0)
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Sets up an empty FIFO for every queue and a set over them.
+ */
+static void test_SetUp(m_cfifo_tSetPolicy policy, const m_cfifo_tIndex* quanta);
+
+/**
+ * @brief Pushes @p len bytes tagged with @p queue through the set.
+ */
+static bool test_Fill(uint8_t queue, m_cfifo_tIndex len);
+
+/**
+ * @brief Pops up to @p len bytes and checks that they carry the tag of the
+ *        reported slot.
+ *
+ * @return Number of bytes popped; @p queue receives the served slot.
+ */
+static m_cfifo_tIndex test_PopNext(m_cfifo_tIndex len, uint8_t* queue, bool* ok);
+
+/**
+ * @brief Pops one message and checks its length, tag and slot.
+ */
+static bool test_ExpectMsg(uint8_t queue, m_cfifo_tIndex len);
+
+static bool test_StrictOrder(void);
+static bool test_DrrShares(void);
+static bool test_DrrStaleReady(void);
+static bool test_DrrMsgDeficit(void);
+static bool test_MsgPartial(void);
+
+
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static m_cfifo_tSet test_set;
+static m_cfifo_tSetQueue test_slots[TEST_QUEUES];
+static m_cfifo_tCFifo test_fifo[TEST_QUEUES];
+static uint8_t test_buffer[TEST_QUEUES][TEST_BUFFER_SIZE];
+static uint8_t test_data[TEST_BUFFER_SIZE];
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+int main(void)
+{
+  int failed = 0;
+
+  struct
+  {
+    const char* name;
+    bool (*run)(void);
+  }tests[] =
+  {
+    { "strict_order", test_StrictOrder },
+    { "drr_shares", test_DrrShares },
+    { "drr_stale_ready", test_DrrStaleReady },
+    { "drr_msg_deficit", test_DrrMsgDeficit },
+    { "msg_partial", test_MsgPartial },
+  };
+  size_t i;
+
+  for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+  {
+    bool ok = tests[i].run();
+
+    printf("%s %s\n", ok ? "PASS" : "FAIL", tests[i].name);
+    if (!ok)
+      failed = 1;
+  }
+
+  return failed;
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static void test_SetUp(m_cfifo_tSetPolicy policy, const m_cfifo_tIndex* quanta)
+{
+  uint8_t i;
+
+  m_cfifo_Set_Init(&test_set, test_slots, TEST_QUEUES, policy);
+  for (i = 0; i < TEST_QUEUES; i++)
+  {
+    m_cfifo_InitBuffer(&test_fifo[i]);
+    m_cfifo_ConfigBuffer(&test_fifo[i], test_buffer[i], TEST_BUFFER_SIZE);
+    m_cfifo_This_Clear(&test_fifo[i]);
+    m_cfifo_Set_AddQueue(&test_set, i, &test_fifo[i], (quanta != NULL) ? quanta[i] : 1);
+  }
+}
+
+static bool test_Fill(uint8_t queue, m_cfifo_tIndex len)
+{
+  memset(test_data, 'A' + queue, len);
+
+  return m_cfifo_Set_Push(&test_set, queue, test_data, len) == len;
+}
+
+static m_cfifo_tIndex test_PopNext(m_cfifo_tIndex len, uint8_t* queue, bool* ok)
+{
+  m_cfifo_tIndex popped = m_cfifo_Set_PopNext(&test_set, test_data, len, queue);
+  m_cfifo_tIndex i;
+
+  *ok = (popped == 0) == (*queue == M_CFIFO_SET_NO_QUEUE);
+  for (i = 0; *ok && i < popped; i++)
+    *ok = test_data[i] == 'A' + *queue;
+
+  return popped;
+}
+
+static bool test_ExpectMsg(uint8_t queue, m_cfifo_tIndex len)
+{
+  m_cfifo_tIndex msg_len = 0;
+  m_cfifo_tIndex i;
+  uint8_t q;
+
+  TEST_CHECK(m_cfifo_Set_PopNextMsg(&test_set, test_data, sizeof(test_data), &msg_len, &q));
+  TEST_CHECK(q == queue);
+  TEST_CHECK(msg_len == len);
+  for (i = 0; i < len; i++)
+    TEST_CHECK(test_data[i] == 'A' + queue);
+
+  return true;
+}
+
+static bool test_StrictOrder(void)
+{
+  uint8_t q;
+  bool ok;
+
+  test_SetUp(M_CFIFO_SET_STRICT, NULL);
+  TEST_CHECK(m_cfifo_Set_IsEmpty(&test_set));
+  TEST_CHECK(test_PopNext(10, &q, &ok) == 0 && ok);
+
+  TEST_CHECK(test_Fill(2, 30));
+  TEST_CHECK(test_Fill(1, 20));
+  TEST_CHECK(test_Fill(0, 10));
+  TEST_CHECK(m_cfifo_Set_GetReady(&test_set) == 0xE0000000u);
+
+  TEST_CHECK(test_PopNext(100, &q, &ok) == 10 && ok && q == 0);
+  TEST_CHECK(test_PopNext(15, &q, &ok) == 15 && ok && q == 1);
+
+  // A higher priority queue overtakes the one being served
+  TEST_CHECK(test_Fill(0, 4));
+  TEST_CHECK(test_PopNext(100, &q, &ok) == 4 && ok && q == 0);
+  TEST_CHECK(test_PopNext(100, &q, &ok) == 5 && ok && q == 1);
+  TEST_CHECK(test_PopNext(100, &q, &ok) == 30 && ok && q == 2);
+
+  TEST_CHECK(test_PopNext(100, &q, &ok) == 0 && ok);
+  TEST_CHECK(m_cfifo_Set_IsEmpty(&test_set));
+
+  return true;
+}
+
+static bool test_DrrShares(void)
+{
+  const m_cfifo_tIndex quanta[TEST_QUEUES] = { 100, 300, 50 };
+  m_cfifo_tIndex served[TEST_QUEUES] = { 0, 0, 0 };
+  m_cfifo_tIndex popped;
+  uint32_t call;
+  uint8_t q;
+  bool ok;
+
+  test_SetUp(M_CFIFO_SET_DRR, quanta);
+  TEST_CHECK(test_Fill(0, 2000));
+  TEST_CHECK(test_Fill(1, 4000));
+  TEST_CHECK(test_Fill(2, 1000));
+
+  // Ten rounds while every queue stays backlogged
+  for (call = 0; call < 30u; call++)
+  {
+    popped = test_PopNext(TEST_CHUNK, &q, &ok);
+    TEST_CHECK(ok && q < TEST_QUEUES);
+    TEST_CHECK(popped == quanta[q]);
+    served[q] += popped;
+  }
+  TEST_CHECK(served[0] == 1000u && served[1] == 3000u && served[2] == 500u);
+
+  // A small buffer splits a turn without losing the rest of the deficit
+  TEST_CHECK(test_PopNext(30, &q, &ok) == 30 && ok && q == 0);
+  TEST_CHECK(test_PopNext(TEST_CHUNK, &q, &ok) == 70 && ok && q == 0);
+  TEST_CHECK(test_PopNext(TEST_CHUNK, &q, &ok) == 300 && ok && q == 1);
+
+  return true;
+}
+
+static bool test_DrrStaleReady(void)
+{
+  const m_cfifo_tIndex quanta[TEST_QUEUES] = { 4, 64, 64 };
+  uint8_t q;
+  bool ok;
+
+  test_SetUp(M_CFIFO_SET_DRR, quanta);
+  TEST_CHECK(test_Fill(0, 10));
+  TEST_CHECK(test_PopNext(1, &q, &ok) == 1 && ok && q == 0);
+
+  // Queue 0 is emptied directly; its ready bit and 3 bytes of deficit remain
+  m_cfifo_This_Clear(&test_fifo[0]);
+  TEST_CHECK((m_cfifo_Set_GetReady(&test_set) & 0x80000000u) != 0);
+  TEST_CHECK(test_Fill(1, 40));
+
+  TEST_CHECK(test_PopNext(100, &q, &ok) == 40 && ok && q == 1);
+  TEST_CHECK(m_cfifo_Set_IsEmpty(&test_set));
+
+  return true;
+}
+
+static bool test_DrrMsgDeficit(void)
+{
+  const m_cfifo_tIndex quanta[TEST_QUEUES] = { 10, 10, 10 };
+  const uint8_t expected[] = { 1, 1, 1, 1, 0, 1, 1 };
+  m_cfifo_tIndex msg_len = 0;
+  size_t i;
+
+  test_SetUp(M_CFIFO_SET_DRR, quanta);
+  memset(test_data, 'A', 25);
+  TEST_CHECK(m_cfifo_Set_PushMsg(&test_set, 0, test_data, 25));
+  memset(test_data, 'B', 5);
+  for (i = 0; i < 6u; i++)
+    TEST_CHECK(m_cfifo_Set_PushMsg(&test_set, 1, test_data, 5));
+
+  // Queue 0 collects 10 bytes per round and sends its message in the third
+  for (i = 0; i < sizeof(expected); i++)
+    TEST_CHECK(test_ExpectMsg(expected[i], (expected[i] == 0) ? 25 : 5));
+
+  TEST_CHECK(!m_cfifo_Set_PopNextMsg(&test_set, test_data, sizeof(test_data), &msg_len, NULL));
+  TEST_CHECK(m_cfifo_Set_IsEmpty(&test_set));
+
+  return true;
+}
+
+static bool test_MsgPartial(void)
+{
+  m_cfifo_tCFifo scratch;
+  uint8_t scratch_buffer[64];
+  uint8_t frame[64];
+  m_cfifo_tIndex frame_len;
+  m_cfifo_tIndex msg_len = 0;
+  uint8_t q;
+
+  // Frame a message for queue 0 and split it
+  m_cfifo_InitBuffer(&scratch);
+  m_cfifo_ConfigBuffer(&scratch, scratch_buffer, sizeof(scratch_buffer));
+  m_cfifo_This_Clear(&scratch);
+  memset(test_data, 'A', 12);
+  TEST_CHECK(m_cfifo_This_PushMsg(&scratch, test_data, 12));
+  frame_len = m_cfifo_This_PopN(&scratch, frame, sizeof(frame));
+  TEST_CHECK(frame_len > 12u);
+
+  test_SetUp(M_CFIFO_SET_STRICT, NULL);
+  TEST_CHECK(m_cfifo_Set_Push(&test_set, 0, frame, (m_cfifo_tIndex)(frame_len - 3u)) == frame_len - 3u);
+  memset(test_data, 'B', 7);
+  TEST_CHECK(m_cfifo_Set_PushMsg(&test_set, 1, test_data, 7));
+
+  // The higher priority queue has no whole message yet
+  TEST_CHECK(test_ExpectMsg(1, 7));
+  TEST_CHECK(!m_cfifo_Set_PopNextMsg(&test_set, test_data, sizeof(test_data), &msg_len, &q));
+  TEST_CHECK(q == M_CFIFO_SET_NO_QUEUE);
+  TEST_CHECK(m_cfifo_Set_GetReady(&test_set) == 0x80000000u);
+  TEST_CHECK(m_cfifo_This_GetUsage(&test_fifo[0]) == frame_len - 3u);
+
+  TEST_CHECK(m_cfifo_Set_Push(&test_set, 0, &frame[frame_len - 3u], 3) == 3);
+  TEST_CHECK(test_ExpectMsg(0, 12));
+  TEST_CHECK(m_cfifo_Set_IsEmpty(&test_set));
+
+  return true;
+}
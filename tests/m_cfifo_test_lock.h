@@ -0,0 +1,57 @@
+/**
+ * @file m_cfifo_test_lock.h
+ * @brief User configuration with one global lock, for the lock tests.
+ *
+ * Passed as `M_CFIFO_USER_CONFIG`. `M_CFIFO_LOCK` takes a single
+ * error-checking mutex for every FIFO, so a function that takes it twice
+ * (or releases it without holding it) is counted instead of hanging.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef M_CFIFO_TEST_LOCK_H_
+#define M_CFIFO_TEST_LOCK_H_
+
+
+//*****************************************************************************
+// Global Defines
+//*****************************************************************************
+
+#define M_CFIFO_LOCK(cfifo)     test_GlobalLock()
+#define M_CFIFO_UNLOCK(cfifo)   test_GlobalUnlock()
+
+
+//*****************************************************************************
+// Global Variable Declarations (Extern)
+//*****************************************************************************
+
+/**
+ * @brief Number of failed lock and unlock calls (e.g. EDEADLK).
+ */
+extern unsigned test_lock_errors;
+
+/**
+ * @brief Number of successful lock calls.
+ */
+extern unsigned test_lock_count;
+
+
+//*****************************************************************************
+// Global Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Takes the global lock, counting a failure in @ref test_lock_errors.
+ */
+void test_GlobalLock(void);
+
+/**
+ * @brief Releases the global lock, counting a failure in @ref test_lock_errors.
+ */
+void test_GlobalUnlock(void);
+
+
+#endif /* M_CFIFO_TEST_LOCK_H_ */
@@ -0,0 +1,223 @@
+/**
+ * @file m_cfifo_trace_test.c
+ * @brief Trace events with one global lock.
+ *
+ * Built with `M_CFIFO_TRACE=1` and @ref m_cfifo_test_lock.h as user
+ * configuration, so `M_CFIFO_LOCK` is a single error-checking mutex for
+ * the traced FIFOs and the trace ring alike. Events are written while the
+ * traced FIFO is locked; taking the ring lock there as well would fail
+ * with EDEADLK.
+ * - `global_lock`: single, bulk, cascaded and transfer calls each write one
+ *   event, and the global lock is neither taken twice nor left held.
+ *
+ * Exit status: 0 passed, 1 failed.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "m_cfifo.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#if !M_CFIFO_TRACE
+#error "m_cfifo_trace_test needs M_CFIFO_TRACE=1"
+#endif
+
+
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#define TEST_RING_EVENTS 16u
+#define TEST_BUFFER_SIZE 64u
+
+#define TEST_CHECK(cond) \
+  do { if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); return false; } } while (0)
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Trace clock counting up by one per call.
+ */
+static uint32_t test_Clock(void);
+
+/**
+ * @brief Pops the next event and checks its operation, instance and size.
+ */
+static bool test_ExpectEvent(unsigned op, uint16_t instance, uint16_t bytes);
+
+static bool test_GlobalLockTrace(void);
+
+
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+
+unsigned test_lock_errors;
+unsigned test_lock_count;
+
+
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static pthread_mutex_t test_mutex;
+static uint32_t test_ticks;
+
+static m_cfifo_tCFifo test_ring;
+static m_cfifo_tTraceEvent test_ring_buffer[TEST_RING_EVENTS];
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+int main(void)
+{
+  pthread_mutexattr_t attr;
+  int failed = 0;
+
+  struct
+  {
+    const char* name;
+    bool (*run)(void);
+  }tests[] =
+  {
+    { "global_lock", test_GlobalLockTrace },
+  };
+  size_t i;
+
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
+  pthread_mutex_init(&test_mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+
+  for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+  {
+    bool ok = tests[i].run();
+
+    printf("%s %s\n", ok ? "PASS" : "FAIL", tests[i].name);
+    if (!ok)
+      failed = 1;
+  }
+
+  pthread_mutex_destroy(&test_mutex);
+
+  return failed;
+}
+
+void test_GlobalLock(void)
+{
+  if (pthread_mutex_lock(&test_mutex) != 0)
+    test_lock_errors++;
+  else
+    test_lock_count++;
+}
+
+void test_GlobalUnlock(void)
+{
+  if (pthread_mutex_unlock(&test_mutex) != 0)
+    test_lock_errors++;
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static uint32_t test_Clock(void)
+{
+  return test_ticks++;
+}
+
+static bool test_ExpectEvent(unsigned op, uint16_t instance, uint16_t bytes)
+{
+  m_cfifo_tTraceEvent event;
+
+  TEST_CHECK(m_cfifo_This_PopRecord(&test_ring, &event));
+  TEST_CHECK(event.op == op);
+  TEST_CHECK(event.instance == instance);
+  TEST_CHECK(event.bytes == bytes);
+
+  return true;
+}
+
+static bool test_GlobalLockTrace(void)
+{
+  m_cfifo_tCFifo single;
+  m_cfifo_tCFifo head;
+  m_cfifo_tCFifo tail;
+  m_cfifo_tCascade cascade;
+  uint8_t single_buffer[TEST_BUFFER_SIZE];
+  uint8_t head_buffer[TEST_BUFFER_SIZE / 4u];
+  uint8_t tail_buffer[TEST_BUFFER_SIZE];
+  uint8_t data[TEST_BUFFER_SIZE];
+  uint8_t byte;
+
+  memset(data, 0x3C, sizeof(data));
+
+  m_cfifo_InitBuffer(&test_ring);
+  m_cfifo_ConfigRecordBuffer(&test_ring, test_ring_buffer, TEST_RING_EVENTS, sizeof(m_cfifo_tTraceEvent));
+  m_cfifo_This_Clear(&test_ring);
+  m_cfifo_TraceAttach(&test_ring, test_Clock);
+
+  m_cfifo_InitBuffer(&single);
+  m_cfifo_ConfigBuffer(&single, single_buffer, sizeof(single_buffer));
+  m_cfifo_This_Clear(&single);
+  m_cfifo_SetTraceId(&single, 1);
+
+  m_cfifo_InitBuffer(&head);
+  m_cfifo_InitBuffer(&tail);
+  m_cfifo_ConfigBuffer(&head, head_buffer, sizeof(head_buffer));
+  m_cfifo_ConfigBuffer(&tail, tail_buffer, sizeof(tail_buffer));
+  m_cfifo_This_Clear(&head);
+  m_cfifo_This_Clear(&tail);
+  m_cfifo_CascadeAsNextBuffer(&head, &tail);
+  m_cfifo_AttachCascade(&cascade, &head);
+  m_cfifo_SetTraceId(&head, 2);
+
+  test_lock_errors = 0;
+  test_lock_count = 0;
+
+  TEST_CHECK(m_cfifo_This_Push(&single, 0x5A));
+  TEST_CHECK(m_cfifo_This_PushN(&single, data, 10u) == 10u);
+  TEST_CHECK(m_cfifo_This_Pop(&single, &byte) && byte == 0x5A);
+  TEST_CHECK(m_cfifo_All_PushN(&head, data, 20u) == 20u);
+  TEST_CHECK(m_cfifo_Transfer(&head, &single, TEST_BUFFER_SIZE) == 10u);
+
+  // Every call took the global lock exactly once, the ring lock was skipped
+  TEST_CHECK(test_lock_errors == 0);
+  TEST_CHECK(test_lock_count == 5u);
+  TEST_CHECK(pthread_mutex_trylock(&test_mutex) == 0);
+  pthread_mutex_unlock(&test_mutex);
+
+  TEST_CHECK(m_cfifo_This_GetRecordUsage(&test_ring) == 5u);
+  TEST_CHECK(test_ExpectEvent(M_CFIFO_TRACE_PUSH, 1, 1));
+  TEST_CHECK(test_ExpectEvent(M_CFIFO_TRACE_PUSH_N, 1, 10));
+  TEST_CHECK(test_ExpectEvent(M_CFIFO_TRACE_POP, 1, 1));
+  TEST_CHECK(test_ExpectEvent(M_CFIFO_TRACE_PUSH_N | M_CFIFO_TRACE_CASCADED, 2, 20));
+  TEST_CHECK(test_ExpectEvent(M_CFIFO_TRACE_TRANSFER | M_CFIFO_TRACE_CASCADED, 2, 10));
+  TEST_CHECK(m_cfifo_TraceGetDropped() == 0);
+  TEST_CHECK(test_lock_errors == 0);
+
+  m_cfifo_TraceAttach(NULL, NULL);
+
+  return true;
+}
@@ -0,0 +1,327 @@
+/**
+ * @file m_cfifo_transfer_test.c
+ * @brief Test of m_cfifo_Transfer between FIFOs and into cascades.
+ *
+ * The moved bytes are a sequence pattern and are checked in order after
+ * every transfer:
+ * - `chain_rejected`: a source that is the destination or one of its
+ *   cascaded successors moves nothing and returns 0.
+ * - `cascaded_dst`: with both ring buffers wrapped, the transfer fills the
+ *   destination segments in turn and stops at `max_bytes`, at the end of
+ *   the source or when the whole cascade is full.
+ * - `lock_order` (with `M_CFIFO_INSTANCE_LOCK=1`): a lock shared by both
+ *   FIFOs is taken once, distinct locks in address order whichever FIFO is
+ *   the source.
+ *
+ * Exit status: 0 passed, 1 failed.
+ *
+ * @see m_cfifo.h
+ * @author Martin Langbein
+ * @date 2025-11-23
+ * @copyright GPLv2
+ */
+
+#include "m_cfifo.h"
+#include <stdio.h>
+#include <string.h>
+
+
+
+//*****************************************************************************
+// Local Defines
+//*****************************************************************************
+
+#define TEST_PATTERN_PERIOD 251u
+#define TEST_MAX_LOCKS      8u
+
+#define TEST_CHECK(cond) \
+  do { if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); return false; } } while (0)
+
+
+
+//*****************************************************************************
+// Local Types
+//*****************************************************************************
+
+/**
+ * @brief Order in which the lock hooks were called.
+ */
+typedef struct
+{
+  void* taken[TEST_MAX_LOCKS];
+  unsigned count;
+  unsigned held;
+  bool error;
+}test_tLockLog;
+
+
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+/**
+ * @brief Sets up an empty FIFO on @p buffer.
+ */
+static void test_Fifo(m_cfifo_tCFifo* cfifo, uint8_t* buffer, m_cfifo_tIndex size);
+
+/**
+ * @brief Pushes stream bytes [@p from, @p from + @p len) into a FIFO or cascade.
+ */
+static bool test_Push(m_cfifo_tCFifo* cfifo, uint32_t from, uint32_t len);
+
+/**
+ * @brief Pops @p len bytes from a FIFO or cascade and checks that they are
+ *        stream bytes from @p from on.
+ */
+static bool test_Pop(m_cfifo_tCFifo* cfifo, uint32_t from, uint32_t len);
+
+static bool test_ChainRejected(void);
+static bool test_CascadedDst(void);
+
+#if M_CFIFO_INSTANCE_LOCK
+/**
+ * @brief Lock hook; @p ctx is the lock, recorded in @ref test_locks.
+ */
+static void test_Lock(void* ctx);
+
+/**
+ * @brief Unlock hook, counterpart of @ref test_Lock.
+ */
+static void test_Unlock(void* ctx);
+
+static bool test_LockOrder(void);
+#endif
+
+
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+#if M_CFIFO_INSTANCE_LOCK
+static test_tLockLog test_locks;
+#endif
+
+
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+int main(void)
+{
+  int failed = 0;
+
+  struct
+  {
+    const char* name;
+    bool (*run)(void);
+  }tests[] =
+  {
+    { "chain_rejected", test_ChainRejected },
+    { "cascaded_dst", test_CascadedDst },
+#if M_CFIFO_INSTANCE_LOCK
+    { "lock_order", test_LockOrder },
+#endif
+  };
+  size_t i;
+
+  for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+  {
+    bool ok = tests[i].run();
+
+    printf("%s %s\n", ok ? "PASS" : "FAIL", tests[i].name);
+    if (!ok)
+      failed = 1;
+  }
+
+  return failed;
+}
+
+
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static void test_Fifo(m_cfifo_tCFifo* cfifo, uint8_t* buffer, m_cfifo_tIndex size)
+{
+  m_cfifo_InitBuffer(cfifo);
+  m_cfifo_ConfigBuffer(cfifo, buffer, size);
+  m_cfifo_This_Clear(cfifo);
+}
+
+static bool test_Push(m_cfifo_tCFifo* cfifo, uint32_t from, uint32_t len)
+{
+  uint8_t data[256];
+  uint32_t i;
+
+  for (i = 0; i < len; i++)
+    data[i] = (uint8_t)((from + i) % TEST_PATTERN_PERIOD);
+
+  return m_cfifo_All_PushN(cfifo, data, (m_cfifo_tIndex)len) == len;
+}
+
+static bool test_Pop(m_cfifo_tCFifo* cfifo, uint32_t from, uint32_t len)
+{
+  uint8_t data[256];
+  uint32_t i;
+
+  if (m_cfifo_All_PopN(cfifo, data, (m_cfifo_tIndex)len) != len)
+    return false;
+
+  for (i = 0; i < len; i++)
+  {
+    if (data[i] != (uint8_t)((from + i) % TEST_PATTERN_PERIOD))
+      return false;
+  }
+
+  return true;
+}
+
+static bool test_ChainRejected(void)
+{
+  m_cfifo_tCFifo head;
+  m_cfifo_tCFifo middle;
+  m_cfifo_tCFifo tail;
+  m_cfifo_tCascade cascade;
+  uint8_t head_buffer[16];
+  uint8_t middle_buffer[16];
+  uint8_t tail_buffer[16];
+
+  test_Fifo(&head, head_buffer, sizeof(head_buffer));
+  test_Fifo(&middle, middle_buffer, sizeof(middle_buffer));
+  test_Fifo(&tail, tail_buffer, sizeof(tail_buffer));
+  m_cfifo_CascadeAsNextBuffer(&head, &middle);
+  m_cfifo_CascadeAsNextBuffer(&middle, &tail);
+
+  // Data in every segment, room left in every segment
+  TEST_CHECK(m_cfifo_This_PushN(&head, "abcd", 4) == 4);
+  TEST_CHECK(m_cfifo_This_PushN(&middle, "efgh", 4) == 4);
+  TEST_CHECK(m_cfifo_This_PushN(&tail, "ijkl", 4) == 4);
+
+  TEST_CHECK(m_cfifo_Transfer(&head, &head, 100) == 0);
+  TEST_CHECK(m_cfifo_Transfer(&head, &middle, 100) == 0);
+  TEST_CHECK(m_cfifo_Transfer(&head, &tail, 100) == 0);
+  TEST_CHECK(m_cfifo_Transfer(&middle, &tail, 100) == 0);
+  TEST_CHECK(m_cfifo_This_GetUsage(&head) == 4u);
+  TEST_CHECK(m_cfifo_This_GetUsage(&middle) == 4u);
+  TEST_CHECK(m_cfifo_This_GetUsage(&tail) == 4u);
+
+  // A predecessor is not part of the chain and may be the source
+  TEST_CHECK(m_cfifo_Transfer(&tail, &head, 2) == 2u);
+  TEST_CHECK(m_cfifo_This_GetUsage(&tail) == 6u);
+
+  // Same with a cascade descriptor
+  m_cfifo_AttachCascade(&cascade, &head);
+  TEST_CHECK(m_cfifo_Transfer(&head, &head, 100) == 0);
+  TEST_CHECK(m_cfifo_Transfer(&head, &tail, 100) == 0);
+  TEST_CHECK(m_cfifo_All_GetUsage(&head) == 12u);
+  TEST_CHECK(m_cfifo_This_GetUsage(&tail) == 6u);
+
+  return true;
+}
+
+static bool test_CascadedDst(void)
+{
+  m_cfifo_tCFifo src;
+  m_cfifo_tCFifo head;
+  m_cfifo_tCFifo tail;
+  m_cfifo_tCascade cascade;
+  uint8_t src_buffer[64];
+  uint8_t head_buffer[16];
+  uint8_t tail_buffer[32];
+
+  test_Fifo(&src, src_buffer, sizeof(src_buffer));
+  test_Fifo(&head, head_buffer, sizeof(head_buffer));
+  test_Fifo(&tail, tail_buffer, sizeof(tail_buffer));
+  m_cfifo_CascadeAsNextBuffer(&head, &tail);
+  m_cfifo_AttachCascade(&cascade, &head);
+
+  // Move both read positions near the end of their buffers
+  TEST_CHECK(test_Push(&src, 0, 50));
+  TEST_CHECK(test_Pop(&src, 0, 50));
+  TEST_CHECK(test_Push(&head, 1000, 12));
+  TEST_CHECK(test_Pop(&head, 1000, 10));
+
+  // Stream bytes 0..45 in the source, wrapped; 2 older bytes in the head
+  TEST_CHECK(test_Push(&src, 0, 46));
+  TEST_CHECK(m_cfifo_Transfer(&head, &src, 5) == 5u);
+  TEST_CHECK(m_cfifo_This_GetUsage(&head) == 7u);
+
+  // Fills the rest of the head, then continues in the tail
+  TEST_CHECK(m_cfifo_Transfer(&head, &src, 100) == 41u);
+  TEST_CHECK(m_cfifo_This_GetUsage(&src) == 0);
+  TEST_CHECK(m_cfifo_This_GetUsage(&head) == 16u);
+  TEST_CHECK(m_cfifo_This_GetUsage(&tail) == 32u);
+  TEST_CHECK(m_cfifo_All_GetUsage(&head) == 48u);
+  TEST_CHECK(m_cfifo_Transfer(&head, &src, 100) == 0);
+
+  // Nothing fits into a full cascade
+  TEST_CHECK(test_Push(&src, 46, 10));
+  TEST_CHECK(m_cfifo_Transfer(&head, &src, 100) == 0);
+  TEST_CHECK(m_cfifo_This_GetUsage(&src) == 10u);
+
+  TEST_CHECK(test_Pop(&head, 1010, 2));
+  TEST_CHECK(test_Pop(&head, 0, 46));
+  TEST_CHECK(m_cfifo_All_GetUsage(&head) == 0);
+
+  // With room again, the remaining bytes follow in order
+  TEST_CHECK(m_cfifo_Transfer(&head, &src, 100) == 10u);
+  TEST_CHECK(test_Pop(&head, 46, 10));
+  TEST_CHECK(m_cfifo_All_GetUsage(&head) == 0);
+
+  return true;
+}
+
+#if M_CFIFO_INSTANCE_LOCK
+static void test_Lock(void* ctx)
+{
+  if (test_locks.held != 0 && test_locks.taken[test_locks.count - 1u] == ctx)
+    test_locks.error = true;
+  if (test_locks.count < TEST_MAX_LOCKS)
+    test_locks.taken[test_locks.count++] = ctx;
+  test_locks.held++;
+}
+
+static void test_Unlock(void* ctx)
+{
+  (void)ctx;
+  if (test_locks.held == 0)
+    test_locks.error = true;
+  else
+    test_locks.held--;
+}
+
+static bool test_LockOrder(void)
+{
+  m_cfifo_tCFifo fifo[2];
+  uint8_t buffer[2][16];
+  int lock_a;
+  int lock_b;
+
+  test_Fifo(&fifo[0], buffer[0], sizeof(buffer[0]));
+  test_Fifo(&fifo[1], buffer[1], sizeof(buffer[1]));
+
+  // One lock for both FIFOs
+  m_cfifo_SetLockHooks(&fifo[0], test_Lock, test_Unlock, &lock_a);
+  m_cfifo_SetLockHooks(&fifo[1], test_Lock, test_Unlock, &lock_a);
+  memset(&test_locks, 0, sizeof(test_locks));
+  TEST_CHECK(test_Push(&fifo[0], 0, 8));
+  TEST_CHECK(m_cfifo_Transfer(&fifo[1], &fifo[0], 4) == 4u);
+  TEST_CHECK(!test_locks.error && test_locks.held == 0 && test_locks.count == 2u);
+
+  // Distinct locks: the lower address first, in both directions
+  m_cfifo_SetLockHooks(&fifo[1], test_Lock, test_Unlock, &lock_b);
+  memset(&test_locks, 0, sizeof(test_locks));
+  TEST_CHECK(m_cfifo_Transfer(&fifo[1], &fifo[0], 4) == 4u);
+  TEST_CHECK(m_cfifo_Transfer(&fifo[0], &fifo[1], 8) == 8u);
+  TEST_CHECK(!test_locks.error && test_locks.held == 0 && test_locks.count == 4u);
+  TEST_CHECK(test_locks.taken[0] == &lock_a && test_locks.taken[1] == &lock_b);
+  TEST_CHECK(test_locks.taken[2] == &lock_a && test_locks.taken[3] == &lock_b);
+  TEST_CHECK(test_Pop(&fifo[0], 0, 8));
+
+  return true;
+}
+#endif
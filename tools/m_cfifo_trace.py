@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""
+@file m_cfifo_trace.py
+@brief Host-side decoder for m_cfifo trace rings.
+
+Reads a raw dump of m_cfifo_tTraceEvent records (16 bytes each, as popped
+from the ring attached with m_cfifo_TraceAttach) and prints
+
+- a latency histogram (power-of-two buckets of `duration`) per instance and
+  operation, and
+- the occupancy over time per instance (and per segment for events written
+  with M_CFIFO_TRACE set to 2).
+
+The occupancy can also be written as CSV, or plotted with matplotlib if it
+is installed.
+
+Usage:
+    m_cfifo_trace.py dump.bin [--big-endian] [--tick-ns N] [--csv FILE] [--plot FILE]
+
+@see m_cfifo.h
+@author Martin Langbein
+@date 2025-11-23
+@copyright GPLv2
+"""
+
+import argparse
+import struct
+import sys
+from collections import defaultdict
+
+# m_cfifo_tTraceEvent: timestamp, duration, instance, op, segment, bytes, usage
+EVENT_FORMAT = "IIHBBHH"
+EVENT_SIZE = struct.calcsize("<" + EVENT_FORMAT)
+
+# m_cfifo_tTraceOp
+OP_NAMES = [
+    "Push", "Pop", "PushN", "PopN", "PushRecord", "PopRecord", "PushMsg",
+    "PopMsg", "CommitWrite", "ReleaseRead", "Transfer", "SegmentWrite",
+    "SegmentRead",
+]
+OP_SEGMENT_WRITE = 11
+OP_SEGMENT_READ = 12
+OP_CASCADED = 0x80
+
+TIMELINE_COLUMNS = 64
+SPARK = " .:-=+*#%@"
+
+
+def op_name(op):
+    code = op & ~OP_CASCADED
+    name = OP_NAMES[code] if code < len(OP_NAMES) else "Op%d" % code
+    if op & OP_CASCADED:
+        return "All_" + name
+    return name
+
+
+def read_events(path, endian):
+    """Returns the events of a dump with timestamps unwrapped to 64 bits."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) % EVENT_SIZE:
+        sys.stderr.write("warning: ignoring %d trailing bytes\n" % (len(data) % EVENT_SIZE))
+
+    events = []
+    epoch = 0
+    last = None
+    for fields in struct.iter_unpack(endian + EVENT_FORMAT, data[:len(data) - len(data) % EVENT_SIZE]):
+        timestamp, duration, instance, op, segment, nbytes, usage = fields
+        # The clock wraps modulo 2^32; events are written in call order
+        if last is not None and timestamp < last and last - timestamp > 0x80000000:
+            epoch += 1 << 32
+        last = timestamp
+        events.append((epoch + timestamp, duration, instance, op, segment, nbytes, usage))
+    return events
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def print_histograms(events, tick_ns):
+    groups = defaultdict(list)
+    for _, duration, instance, op, _, _, _ in events:
+        if (op & ~OP_CASCADED) in (OP_SEGMENT_WRITE, OP_SEGMENT_READ):
+            continue
+        groups[(instance, op)].append(duration)
+
+    unit = "ns" if tick_ns else "ticks"
+    scale = tick_ns or 1.0
+    for (instance, op), durations in sorted(groups.items()):
+        durations.sort()
+        print("instance %d %s: %d calls, min %g, p50 %g, p99 %g, max %g %s" % (
+            instance, op_name(op), len(durations), durations[0] * scale,
+            percentile(durations, 50) * scale, percentile(durations, 99) * scale,
+            durations[-1] * scale, unit))
+
+        buckets = defaultdict(int)
+        for d in durations:
+            buckets[d.bit_length()] += 1
+        peak = max(buckets.values())
+        for b in range(min(buckets), max(buckets) + 1):
+            low = 0 if b == 0 else 1 << (b - 1)
+            high = (1 << b) - 1
+            count = buckets.get(b, 0)
+            bar = "#" * ((count * 40 + peak - 1) // peak)
+            print("  %10g..%-10g %8d %s" % (low * scale, high * scale, count, bar))
+        print()
+
+
+def occupancy_series(events):
+    """Maps (instance, segment or None) to a list of (time, usage)."""
+    series = defaultdict(list)
+    for timestamp, duration, instance, op, segment, _, usage in events:
+        if (op & ~OP_CASCADED) in (OP_SEGMENT_WRITE, OP_SEGMENT_READ):
+            key = (instance, segment)
+        else:
+            key = (instance, None)
+        series[key].append((timestamp + duration, usage))
+    return series
+
+
+def series_label(key):
+    instance, segment = key
+    if segment is None:
+        return "instance %d" % instance
+    return "instance %d segment %d" % (instance, segment)
+
+
+def print_timeline(series, start, end):
+    span = max(1, end - start)
+    print("occupancy over %d ticks (%d columns, peak usage per column):" % (span, TIMELINE_COLUMNS))
+    for key, points in sorted(series.items(), key=lambda kv: (kv[0][0], -1 if kv[0][1] is None else kv[0][1])):
+        peak = max(usage for _, usage in points) or 1
+        columns = [None] * TIMELINE_COLUMNS
+        for t, usage in points:
+            c = min(TIMELINE_COLUMNS - 1, (t - start) * TIMELINE_COLUMNS // span)
+            columns[c] = usage if columns[c] is None else max(columns[c], usage)
+        # Columns without an event keep the last known usage
+        line = []
+        level = 0
+        for value in columns:
+            if value is not None:
+                level = value
+            line.append(SPARK[(level * (len(SPARK) - 1) + peak - 1) // peak])
+        print("  %-26s |%s| peak %d" % (series_label(key), "".join(line), peak))
+
+
+def write_csv(path, events):
+    with open(path, "w") as f:
+        f.write("timestamp,duration,instance,op,segment,bytes,usage\n")
+        for timestamp, duration, instance, op, segment, nbytes, usage in events:
+            f.write("%d,%d,%d,%s,%d,%d,%d\n" % (timestamp, duration, instance, op_name(op), segment, nbytes, usage))
+
+
+def write_plot(path, series, tick_ns):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        sys.stderr.write("error: --plot needs matplotlib\n")
+        return False
+
+    fig, ax = plt.subplots(figsize=(10, 4))
+    scale = tick_ns or 1.0
+    for key, points in sorted(series.items(), key=lambda kv: (kv[0][0], -1 if kv[0][1] is None else kv[0][1])):
+        ax.step([t * scale for t, _ in points], [u for _, u in points], where="post", label=series_label(key))
+    ax.set_xlabel("time [ns]" if tick_ns else "time [ticks]")
+    ax.set_ylabel("stored bytes")
+    ax.legend(fontsize="small")
+    fig.tight_layout()
+    fig.savefig(path)
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode an m_cfifo trace ring dump.")
+    parser.add_argument("dump", help="raw m_cfifo_tTraceEvent records")
+    parser.add_argument("--big-endian", action="store_true", help="dump was written by a big-endian target")
+    parser.add_argument("--tick-ns", type=float, default=0.0, help="clock period in ns (default: print ticks)")
+    parser.add_argument("--instance", type=int, action="append", help="only decode this instance id (repeatable)")
+    parser.add_argument("--csv", help="write all events as CSV to this file")
+    parser.add_argument("--plot", help="plot the occupancy to this image file (needs matplotlib)")
+    args = parser.parse_args()
+
+    events = read_events(args.dump, ">" if args.big_endian else "<")
+    if args.instance:
+        events = [e for e in events if e[2] in args.instance]
+    if not events:
+        print("no events")
+        return 0
+
+    print("%d events\n" % len(events))
+    print_histograms(events, args.tick_ns)
+
+    series = occupancy_series(events)
+    print_timeline(series, events[0][0], max(t + d for t, d, _, _, _, _, _ in events))
+
+    if args.csv:
+        write_csv(args.csv, events)
+    if args.plot and not write_plot(args.plot, series, args.tick_ns):
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())